@@ -34,6 +34,7 @@
 #define LENGTH 2048          // 44100/LOWFREQ + 1 --blotar length
 #define JETLENGTH LENGTH * 2 // larger, for big rooms
 #define VIBLENGTH 1024
+#define LOWEST 32.3 // Pd: lowest frequency the bore is sized for, by default
 
 /* --------------------------------- MSP -------------------------- */
 #ifdef MSP
@@ -84,6 +85,9 @@ typedef struct _blotar {
   // DC blocker
   DCBlock killdc;
 
+  // breath noise
+  Noise noise;
+
   // impulse response files
   HeaderSnd soundfile[12];
 
@@ -337,6 +341,7 @@ void *blotar_new(double initial_coeff) {
   DLineL_clear(&x->jetDelay);
   OnePole_init(&x->flute_filter);
   OneZero_init(&x->lowpass);
+  Noise_init(&x->noise, 0);
   DLineL_clear(&x->combDelay);
 
   // impulse responses
@@ -437,7 +442,7 @@ t_int *blotar_perform(t_int *w) {
 
   while (n--) {
 
-    randPressure = ng * Noise_tick();
+    randPressure = ng * Noise_tick(&x->noise);
     randPressure += va * vib_tick(x);
     randPressure *= bp;
 
@@ -506,6 +511,9 @@ typedef struct _blotar {
   // DC blocker
   DCBlock killdc;
 
+  // breath noise
+  Noise noise;
+
   // impulse response files
   HeaderSnd soundfile[12];
 
@@ -532,6 +540,7 @@ typedef struct _blotar {
   float directBody;
 
   float srate, one_over_srate;
+  float lowest;
 } t_blotar;
 
 /****FUNCTIONS****/
@@ -560,11 +569,26 @@ static void setBodySize(t_blotar *x, float size) {
 
 static void blotar_bang(t_blotar *x) { x->pluck = 1; }
 
+// size the bore for the lowest frequency at this sample rate (it runs at
+// 2/3 of the pitch), the jet twice that for big rooms and the comb like
+// the bore; new lines are tuned again on the next block
+static void blotar_size(t_blotar *x) {
+  long length = DLine_lengthFor(x->srate, x->lowest, 1.5, 0);
+  if (length != x->boreDelay.length) {
+    DLineL_resize(&x->boreDelay, length);
+    DLineL_resize(&x->jetDelay, 2 * length);
+    DLineL_resize(&x->combDelay, length);
+    DLineL_setDelay(&x->combDelay, 0.5 * x->pluckPos * x->lastLength);
+    x->fr_save = -1.;
+    x->jd_save = -1.;
+  }
+}
+
 #define WATCHIT 0.00001
 static void setFreq(t_blotar *x, float frequency) {
   float temp;
-  if (frequency < 20.)
-    frequency = 20.;
+  if (frequency < x->lowest)
+    frequency = x->lowest;
   x->lastFreq = frequency;
   x->lastLength = x->srate / x->lastFreq; /* length - delays */
   /*
@@ -636,6 +660,8 @@ static t_int *blotar_perform(t_int *w) {
   long n = w[3];
 
   float temp, tempsave, lastOutput, pressureDiff, randPressure, filterRatioInv;
+  float excite[STK_BLOCKSIZE], comb[STK_BLOCKSIZE], breath[STK_BLOCKSIZE];
+  long i, chunk;
 
   if (fr != x->fr_save) {
     setFreq(x, fr);
@@ -657,36 +683,45 @@ static t_int *blotar_perform(t_int *w) {
     x->pluck = 0;
   }
 
-  while (n--) {
-
-    randPressure = ng * Noise_tick();
-    randPressure += va * vib_tick(x);
-    randPressure *= bp;
-
-    temp = 0.;
-    // if (!x->waveDone)      {
-    x->waveDone = HeaderSnd_informTick(
-        &x->soundfile[x->mic]); /* as long as it goes . . .   */
-    temp = x->soundfile[x->mic].lastOutput *
-           pluckAmp; /* scaled pluck excitation    */
-    temp = temp - DLineL_tick(&x->combDelay, temp); /* with comb filtering */
-    //}
-
-    // balance OnePole (flute) with LowPass (Karplus Strong); total wacko hack,
-    // but sounds cool
-    tempsave = temp;
-    temp = OnePole_tick(&x->flute_filter, (x->boreDelay.lastOutput + temp));
-    temp = filterRatio * temp +
-           filterRatioInv *
-               OneZero_tick(&x->lowpass, (x->boreDelay.lastOutput + tempsave));
-
-    temp = DCBlock_tick(&x->killdc, temp);
-    pressureDiff = bp + randPressure - (jr * temp);
-    pressureDiff = DLineL_tick(&x->jetDelay, pressureDiff);
-    pressureDiff =
-        JetTabl_lookup(pressureDiff + (er * temp)); // becomes "tube" distortion
-
-    *out++ = DLineL_tick(&x->boreDelay, pressureDiff);
+  while (n > 0) {
+    chunk = n < STK_BLOCKSIZE ? n : STK_BLOCKSIZE;
+
+    /* breath noise and pluck excitation don't depend on the loop, so they
+       are computed for the whole chunk first */
+    Noise_tickBlock(&x->noise, breath, chunk);
+    x->waveDone = HeaderSnd_tickBlock(&x->soundfile[x->mic], excite,
+                                      chunk); /* as long as it goes . . .   */
+    for (i = 0; i < chunk; i++) {
+      randPressure = ng * breath[i];
+      randPressure += va * vib_tick(x);
+      randPressure *= bp;
+      breath[i] = randPressure;
+
+      excite[i] *= pluckAmp; /* scaled pluck excitation    */
+    }
+    DLineL_tickBlock(&x->combDelay, excite, comb, chunk); /* comb filtering */
+
+    for (i = 0; i < chunk; i++) {
+      temp = excite[i] - comb[i];
+
+      // balance OnePole (flute) with LowPass (Karplus Strong); total wacko
+      // hack, but sounds cool
+      tempsave = temp;
+      temp = OnePole_tick(&x->flute_filter, (x->boreDelay.lastOutput + temp));
+      temp = filterRatio * temp +
+             filterRatioInv * OneZero_tick(&x->lowpass,
+                                           (x->boreDelay.lastOutput + tempsave));
+
+      temp = DCBlock_tick(&x->killdc, temp);
+      pressureDiff = bp + breath[i] - (jr * temp);
+      pressureDiff = DLineL_tick(&x->jetDelay, pressureDiff);
+      pressureDiff = JetTabl_lookup(pressureDiff +
+                                    (er * temp)); // becomes "tube" distortion
+
+      out[i] = DLineL_tick(&x->boreDelay, pressureDiff);
+    }
+    out += chunk;
+    n -= chunk;
   }
   return w + 4;
 }
@@ -696,8 +731,9 @@ static void blotar_dsp(t_blotar *x, t_signal **sp) {
   x->one_over_srate = 1. / x->srate;
 
   OnePole_setPole(&x->flute_filter, 0.7 - (0.1 * 22050. / x->srate));
+  blotar_size(x);
 
-  dsp_add(blotar_perform, 3, x, sp[1]->s_vec, sp[0]->s_n);
+  Denormals_dspAdd(blotar_perform, 3, x, sp[1]->s_vec, sp[0]->s_n);
 }
 
 static void setmic(t_blotar *x, t_floatarg argc) {
@@ -723,6 +759,11 @@ static void blotar_va(t_blotar *x, t_floatarg f) { x->x_va = f; }
 
 static void blotar_freq(t_blotar *x, t_floatarg f) { x->x_fr = f; }
 
+static void blotar_lowest(t_blotar *x, t_floatarg f) {
+  x->lowest = f < 1. ? 1. : f;
+  blotar_size(x);
+}
+
 static void blotar_er(t_blotar *x, t_floatarg f) { x->x_er = f; }
 
 static void blotar_jr(t_blotar *x, t_floatarg f) { x->x_jr = f; }
@@ -731,6 +772,10 @@ static void blotar_filterRatio(t_blotar *x, t_floatarg f) {
   x->filterRatio = f;
 }
 
+static void blotar_seed(t_blotar *x, t_floatarg f) {
+  Noise_seed(&x->noise, (unsigned int)f);
+}
+
 static void blotar_clear(t_blotar *x) {
   DLineL_clear(&x->boreDelay);
   DLineL_clear(&x->jetDelay);
@@ -791,10 +836,8 @@ static void *blotar_new(void) {
   x->srate = sys_getsr();
   x->one_over_srate = 1. / x->srate;
 
-  DLineL_alloc(&x->boreDelay, LENGTH);
-  DLineL_alloc(&x->jetDelay,
-               JETLENGTH); // longer here, for long feedback loops, big rooms
-  DLineL_alloc(&x->combDelay, LENGTH);
+  x->lowest = LOWEST;
+  blotar_size(x);
 
   for (i = 0; i < VIBLENGTH; i++)
     x->vibTable[i] = sin(i * TWO_PI / VIBLENGTH);
@@ -806,6 +849,7 @@ static void *blotar_new(void) {
   DLineL_clear(&x->jetDelay);
   OnePole_init(&x->flute_filter);
   OneZero_init(&x->lowpass);
+  Noise_init(&x->noise, 0);
   DLineL_clear(&x->combDelay);
 
   // impulse responses
@@ -858,5 +902,9 @@ void blotar_tilde_setup(void) {
                   gensym("filterRatio"), A_FLOAT, A_NULL);
   class_addmethod(blotar_class, (t_method)setmic, gensym("setmic"), A_FLOAT,
                   A_NULL);
+  class_addmethod(blotar_class, (t_method)blotar_seed, gensym("seed"), A_FLOAT,
+                  A_NULL);
+  class_addmethod(blotar_class, (t_method)blotar_lowest, gensym("lowest"),
+                  A_FLOAT, A_NULL);
 }
 #endif /* PD */
@@ -31,6 +31,7 @@
 
 #define LENGTH 882 // 44100/LOWFREQ + 1 --bowed length
 #define BRIDGELENGTH (LENGTH >> 1)
+#define LOWEST 50. // Pd: lowest frequency the string is sized for, by default
 #define VIBLENGTH 1024
 
 /* -------------------------------- MSP -------------------------------- */
@@ -342,13 +343,27 @@ typedef struct _bowed {
   // stuff
   float maxVelocity, baseDelay, betaRatio;
   float srate, one_over_srate;
+  float lowest;
 } t_bowed;
 
 /****FUNCTIONS****/
 
+// size the string for the lowest frequency at this sample rate, the
+// bridge side for half of it; new lines are tuned again on the next block
+static void bowed_size(t_bowed *x) {
+  long length = DLine_lengthFor(x->srate, x->lowest, 1., 0);
+  long bridgelength = DLine_lengthFor(x->srate, x->lowest, .5, 0);
+  if (length != x->neckDelay.length || bridgelength != x->bridgeDelay.length) {
+    DLineL_resize(&x->neckDelay, length);
+    DLineL_resize(&x->bridgeDelay, bridgelength);
+    x->fr_save = -1.;
+    x->betaRatio = -1.;
+  }
+}
+
 static void setFreq(t_bowed *x, float freq) {
-  if (freq < 20.)
-    freq = 20.;
+  if (freq < x->lowest)
+    freq = x->lowest;
   x->baseDelay = x->srate / freq - 4.0; /* delay - approx. filter delay */
   DLineL_setDelay(&x->bridgeDelay,
                   x->baseDelay * x->betaRatio); /* bow to bridge length */
@@ -393,6 +408,8 @@ static t_int *bowed_perform(t_int *w) {
 
   float *out = (float *)(w[2]);
   long n = w[3];
+  float *bridge = out;
+  long nsamps = n;
 
   float temp, nutRefl, newVel, velDiff, stringVel, bridgeRefl;
 
@@ -431,8 +448,12 @@ static t_int *bowed_perform(t_int *w) {
                                          (x->baseDelay * va * vib_tick(x)));
     }
 
-    *out++ = BiQuad_tick(&x->bodyFilt, x->bridgeDelay.lastOutput);
+    *out++ = x->bridgeDelay.lastOutput;
   }
+
+  /* body filter runs over the whole block of bridge output */
+  BiQuad_tickBlock(&x->bodyFilt, bridge, bridge, nsamps);
+
   return w + 4;
 }
 
@@ -440,7 +461,8 @@ static void bowed_dsp(t_bowed *x, t_signal **sp) {
   x->srate = sp[0]->s_sr;
   x->one_over_srate = 1. / x->srate;
   OnePole_setPole(&x->reflFilt, 0.6 - (0.1 * 22050. / x->srate));
-  dsp_add(bowed_perform, 3, x, sp[1]->s_vec, sp[0]->s_n);
+  bowed_size(x);
+  Denormals_dspAdd(bowed_perform, 3, x, sp[1]->s_vec, sp[0]->s_n);
 }
 
 static void bowed_float(t_bowed *x, t_floatarg f) { x->x_bp = f; }
@@ -455,6 +477,11 @@ static void bowed_va(t_bowed *x, t_floatarg f) { x->x_va = f; }
 
 static void bowed_freq(t_bowed *x, t_floatarg f) { x->x_fr = f; }
 
+static void bowed_lowest(t_bowed *x, t_floatarg f) {
+  x->lowest = f < 1. ? 1. : f;
+  bowed_size(x);
+}
+
 static void bowed_free(t_bowed *x) {
   DLineL_free(&x->bridgeDelay);
   DLineL_free(&x->neckDelay);
@@ -490,8 +517,8 @@ static void *bowed_new(void) {
   x->srate = sys_getsr();
   x->one_over_srate = 1. / x->srate;
 
-  DLineL_alloc(&x->neckDelay, LENGTH);
-  DLineL_alloc(&x->bridgeDelay, BRIDGELENGTH);
+  x->lowest = LOWEST;
+  bowed_size(x);
 
   for (i = 0; i < VIBLENGTH; i++)
     x->vibTable[i] = sin(i * TWO_PI / VIBLENGTH);
@@ -544,5 +571,7 @@ void bowed_tilde_setup(void) {
                   A_NULL);
   class_addmethod(bowed_class, (t_method)bowed_freq, gensym("freq"), A_FLOAT,
                   A_NULL);
+  class_addmethod(bowed_class, (t_method)bowed_lowest, gensym("lowest"),
+                  A_FLOAT, A_NULL);
 }
 #endif /* PD */
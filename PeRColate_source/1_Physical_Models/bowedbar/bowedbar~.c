@@ -51,6 +51,9 @@ typedef struct _bowedbar {
   // bow table
   BowTabl bowTabl;
 
+  // pluck noise
+  Noise noise;
+
   // stuff
   float modes[4];
   float Zs[4][2];
@@ -166,12 +169,12 @@ void pluck(t_bowedbar *x, float amplitude) {
 
   pluckLen = (int)(x->length / x->modes[x->NR_MODES - 1]);
   for (j = 1; j < pluckLen / 2; j++) {
-    temp = amplitude * 2.0 * Noise_tick();
+    temp = amplitude * 2.0 * Noise_tick(&x->noise);
     for (i = 0; i < x->NR_MODES; i++)
       DLineN_tick(&x->delay[i], temp * j / pluckLen * x->gains[i]);
   }
   for (j = pluckLen / 2; j > 0; j--) {
-    temp = amplitude * 2.0 * Noise_tick();
+    temp = amplitude * 2.0 * Noise_tick(&x->noise);
     for (i = 0; i < x->NR_MODES; i++)
       DLineN_tick(&x->delay[i], temp * j / pluckLen * x->gains[i]);
     ;
@@ -251,6 +254,7 @@ void *bowedbar_new(double initial_coeff) {
 
   // initialize things
   BowTabl_init(&x->bowTabl);
+  Noise_init(&x->noise, 0);
   x->bowTabl.slope = 3.0;
   x->slope = 3.;
   x->R = 0.97;
@@ -347,6 +351,8 @@ t_int *bowedbar_perform(t_int *w) {
 #ifdef PD
 static t_class *bowedbar_class;
 
+#define LOWEST 20. // lowest frequency the bar is sized for, by default
+
 typedef struct _bowedbar {
   // header
   t_object x_obj;
@@ -362,8 +368,8 @@ typedef struct _bowedbar {
   // to avoid updating freq unnecessarily...
   float fr_save;
 
-  // delay lines
-  DLineN delay[4];
+  // delay lines, whole lags only
+  DLineP delay[4];
 
   // biquad
   BiQuad bandpass_[4];
@@ -371,6 +377,9 @@ typedef struct _bowedbar {
   // bow table
   BowTabl bowTabl;
 
+  // pluck noise
+  Noise noise;
+
   // stuff
   float modes[4];
   float Zs[4][2];
@@ -387,6 +396,7 @@ typedef struct _bowedbar {
   int NR_MODES;
 
   float srate, one_over_srate;
+  float lowest;
 } t_bowedbar;
 
 /****FUNCTIONS****/
@@ -404,14 +414,14 @@ static void tuneBandPasses(t_bowedbar *x) {
     x->coeffs[i][0] =
         2.0 * x->R * cos(6.28318530718 * x->x_freq * x->modes[i] / x->srate);
 
-    DLineN_clear(&x->delay[i]); //(rand()) - 16384;
+    DLineP_clear(&x->delay[i]); //(rand()) - 16384;
   }
 }
 
 static void setFreq(t_bowedbar *x, float freq) {
   int i;
-  if (freq < 20.)
-    freq = 20.;
+  if (freq < x->lowest)
+    freq = x->lowest;
   x->x_freq = freq;
   if (x->x_freq > 1568.0)
     x->x_freq = 1568.0;
@@ -420,14 +430,14 @@ static void setFreq(t_bowedbar *x, float freq) {
   x->NR_MODES = 4;
   for (i = 0; i < x->NR_MODES; i++) {
     if ((int)(x->length / x->modes[i]) > 4)
-      DLineN_setDelay(&x->delay[i], (int)(x->length / x->modes[i]));
+      DLineP_setDelay(&x->delay[i], (int)(x->length / x->modes[i]));
     else {
       x->NR_MODES = i;
       break;
     }
 
     /*   FIX THIS BETTER!!!!! */
-    DLineN_clear(&x->delay[i]);
+    DLineP_clear(&x->delay[i]);
 
     BiQuad_clear(&x->bandpass_[i]);
 
@@ -443,7 +453,7 @@ static void setFreq(t_bowedbar *x, float freq) {
 static void clear(t_bowedbar *x) {
   long i;
   for (i = 0; i < x->NR_MODES; i++) {
-    DLineN_clear(&x->delay[i]);
+    DLineP_clear(&x->delay[i]);
     BiQuad_clear(&x->bandpass_[i]);
     x->Zs[i][0] = 0.0;
     x->Zs[i][1] = 0.0;
@@ -468,14 +478,14 @@ static void pluck(t_bowedbar *x, float amplitude) {
 
   pluckLen = (int)(x->length / x->modes[x->NR_MODES - 1]);
   for (j = 1; j < pluckLen / 2; j++) {
-    temp = amplitude * 2.0 * Noise_tick();
+    temp = amplitude * 2.0 * Noise_tick(&x->noise);
     for (i = 0; i < x->NR_MODES; i++)
-      DLineN_tick(&x->delay[i], temp * j / pluckLen * x->gains[i]);
+      DLineP_tick(&x->delay[i], temp * j / pluckLen * x->gains[i]);
   }
   for (j = pluckLen / 2; j > 0; j--) {
-    temp = amplitude * 2.0 * Noise_tick();
+    temp = amplitude * 2.0 * Noise_tick(&x->noise);
     for (i = 0; i < x->NR_MODES; i++)
-      DLineN_tick(&x->delay[i], temp * j / pluckLen * x->gains[i]);
+      DLineP_tick(&x->delay[i], temp * j / pluckLen * x->gains[i]);
     ;
   }
 }
@@ -526,7 +536,7 @@ static t_int *bowedbar_perform(t_int *w) {
     for (k = 0; k < x->NR_MODES; k++) {
       BiQuad_tick(&x->bandpass_[k],
                   input * x->gains[k] + GAIN * x->delay[k].lastOutput);
-      DLineN_tick(&x->delay[k], x->bandpass_[k].lastOutput);
+      DLineP_tick(&x->delay[k], x->bandpass_[k].lastOutput);
       data += x->bandpass_[k].lastOutput;
     }
 
@@ -535,10 +545,25 @@ static t_int *bowedbar_perform(t_int *w) {
   return w + 4;
 }
 
+// size the modes' delays for the lowest frequency at this sample rate, the
+// first mode is the longest; new lines are tuned again on the next block
+static void bowedbar_size(t_bowedbar *x) {
+  long length = DLine_lengthFor(x->srate, x->lowest, 1., 1);
+  int i;
+  if (length == x->delay[0].length)
+    return;
+  for (i = 0; i < 4; i++) {
+    DLineP_resize(&x->delay[i], length);
+    DLineP_setDelay(&x->delay[i], (int)(x->length / x->modes[i]));
+  }
+  x->fr_save = -1.;
+}
+
 static void bowedbar_dsp(t_bowedbar *x, t_signal **sp) {
   x->srate = sp[0]->s_sr;
   x->one_over_srate = 1. / x->srate;
-  dsp_add(bowedbar_perform, 3, x, sp[1]->s_vec, sp[0]->s_n);
+  bowedbar_size(x);
+  Denormals_dspAdd(bowedbar_perform, 3, x, sp[1]->s_vec, sp[0]->s_n);
 }
 
 static void bowedbar_float(t_bowedbar *x, t_floatarg f) { x->x_bp = f; }
@@ -555,10 +580,19 @@ static void bowedbar_integration_const_(t_bowedbar *x, t_floatarg f) {
 
 static void bowedbar_freq(t_bowedbar *x, t_floatarg f) { x->x_freq = f; }
 
+static void bowedbar_lowest(t_bowedbar *x, t_floatarg f) {
+  x->lowest = f < 1. ? 1. : f;
+  bowedbar_size(x);
+}
+
+static void bowedbar_seed(t_bowedbar *x, t_floatarg f) {
+  Noise_seed(&x->noise, (unsigned int)f);
+}
+
 static void bowedbar_free(t_bowedbar *x) {
   int i;
   for (i = 0; i < 4; i++) {
-    DLineN_free(&x->delay[i]);
+    DLineP_free(&x->delay[i]);
   }
 }
 
@@ -593,9 +627,10 @@ static void *bowedbar_new(void) {
 
   for (i = 0; i < 4; i++) {
     x->gains[i] = pow(0.9, (double)i);
-    DLineN_alloc(&x->delay[i], 2408);
-    DLineN_setDelay(&x->delay[i], (int)(x->length / x->modes[i]));
-    DLineN_clear(&x->delay[i]);
+    DLineP_alloc(&x->delay[i],
+                 DLine_lengthFor(sys_getsr(), LOWEST, 1., 1));
+    DLineP_setDelay(&x->delay[i], (int)(x->length / x->modes[i]));
+    DLineP_clear(&x->delay[i]);
     BiQuad_init(&x->bandpass_[i]);
     BiQuad_clear(&x->bandpass_[i]);
     x->Zs[i][0] = 0.0;
@@ -606,9 +641,11 @@ static void *bowedbar_new(void) {
 
   x->srate = sys_getsr();
   x->one_over_srate = 1. / x->srate;
+  x->lowest = LOWEST;
 
   // initialize things
   BowTabl_init(&x->bowTabl);
+  Noise_init(&x->noise, 0);
   x->bowTabl.slope = 3.0;
   x->slope = 3.;
   x->R = 0.97;
@@ -641,6 +678,10 @@ void bowedbar_tilde_setup(void) {
                   gensym("integration_const_"), A_FLOAT, A_NULL);
   class_addmethod(bowedbar_class, (t_method)bowedbar_freq, gensym("freq"),
                   A_FLOAT, A_NULL);
+  class_addmethod(bowedbar_class, (t_method)bowedbar_seed, gensym("seed"),
+                  A_FLOAT, A_NULL);
+  class_addmethod(bowedbar_class, (t_method)bowedbar_lowest, gensym("lowest"),
+                  A_FLOAT, A_NULL);
 }
 
 #endif /* PD */
@@ -21,7 +21,8 @@
 #include "stk_c.h"
 #include <math.h>
 
-#define LENGTH 22050 // 44100/LOWFREQ + 1 --brass length
+#define LOWEST 20.  // lowest frequency the bore is sized for, by default
+#define MAXSLIDE 2. // and the longest slide (slideTargetMult) it has room for
 #define VIBLENGTH 1024
 
 static t_class *brass_class;
@@ -59,13 +60,24 @@ typedef struct _brass {
   // stuff
   float lipTarget, slideTarget;
   float srate, one_over_srate;
+  float lowest;
 } t_brass;
 
 /****FUNCTIONS****/
 
+// size the bore for the lowest frequency at this sample rate; a new
+// line is tuned again on the next block
+static void brass_size(t_brass *x) {
+  long length = DLine_lengthFor(x->srate, x->lowest, 2. * MAXSLIDE, 4);
+  if (length != x->delayLine.length) {
+    DLineA_resize(&x->delayLine, length);
+    x->fr_save = -1.;
+  }
+}
+
 static void setFreq(t_brass *x, float frequency) {
-  if (frequency < 20.)
-    frequency = 20.;
+  if (frequency < x->lowest)
+    frequency = x->lowest;
   x->slideTarget = (x->srate / frequency * 2.0) + 3.0;
   /* fudge correction for filter delays */
   DLineA_setDelay(&x->delayLine, x->slideTarget); /*  we'll play a harmonic  */
@@ -113,8 +125,8 @@ static t_int *brass_perform(t_int *w) {
   float temp, breathPressure;
 
   if (fr != x->fr_save) {
-    if (fr < 20.)
-      fr = 20.;
+    if (fr < x->lowest)
+      fr = x->lowest;
     x->slideTarget = (x->srate / fr * 2.0) + 3.0;
     x->lipTarget = fr;
     LipFilt_setFreq(&x->lipFilter, x->lipTarget * lipTension, x->srate);
@@ -149,7 +161,8 @@ static t_int *brass_perform(t_int *w) {
 static void brass_dsp(t_brass *x, t_signal **sp) {
   x->srate = sp[0]->s_sr;
   x->one_over_srate = 1. / x->srate;
-  dsp_add(brass_perform, 3, x, sp[1]->s_vec, sp[0]->s_n);
+  brass_size(x);
+  Denormals_dspAdd(brass_perform, 3, x, sp[1]->s_vec, sp[0]->s_n);
 }
 
 static void brass_float(t_brass *x, t_floatarg f) { x->lipTension = f; }
@@ -166,6 +179,11 @@ static void brass_maxPressure(t_brass *x, t_floatarg f) { x->maxPressure = f; }
 
 static void brass_freq(t_brass *x, t_floatarg f) { x->x_fr = f; }
 
+static void brass_lowest(t_brass *x, t_floatarg f) {
+  x->lowest = f < 1. ? 1. : f;
+  brass_size(x);
+}
+
 static void brass_free(t_brass *x) { DLineA_free(&x->delayLine); }
 
 static void *brass_new(void) {
@@ -197,7 +215,8 @@ static void *brass_new(void) {
   x->srate = sys_getsr();
   x->one_over_srate = 1. / x->srate;
 
-  DLineA_alloc(&x->delayLine, LENGTH);
+  x->lowest = LOWEST;
+  brass_size(x);
 
   for (i = 0; i < VIBLENGTH; i++)
     x->vibTable[i] = sin(i * TWO_PI / VIBLENGTH);
@@ -237,4 +256,6 @@ void brass_tilde_setup(void) {
                   A_FLOAT, A_NULL);
   class_addmethod(brass_class, (t_method)brass_freq, gensym("freq"), A_FLOAT,
                   A_NULL);
+  class_addmethod(brass_class, (t_method)brass_lowest, gensym("lowest"),
+                  A_FLOAT, A_NULL);
 }
@@ -21,7 +21,7 @@
 #include "stk_c.h"
 #include <math.h>
 
-#define LENGTH 2205 // 44100/LOWFREQ + 1 --clar length
+#define LOWEST 20. // lowest frequency the bore is sized for, by default
 #define VIBLENGTH 1024
 static t_class *clar_class;
 
@@ -49,6 +49,9 @@ typedef struct _clar {
     // one zero filter
     OneZero filter;
 
+    // breath noise
+    Noise noise;
+
     // vibrato table
     t_float vibTable[VIBLENGTH];
     t_float vibRate;
@@ -56,13 +59,24 @@ typedef struct _clar {
 
     // stuff
     t_float srate, one_over_srate;
+    t_float lowest;
 } t_clar;
 
 /****FUNCTIONS****/
 
+// size the bore for the lowest frequency at this sample rate; a new
+// line is tuned again on the next block
+static void clar_size(t_clar *x) {
+    long length = DLine_lengthFor(x->srate, x->lowest, .5, 1);
+    if (length != x->delayLine.length) {
+        DLineL_resize(&x->delayLine, length);
+        x->fr_save = -1.;
+    }
+}
+
 static void setFreq(t_clar *x, t_floatarg frequency) {
-    if (frequency < 20.)
-        frequency = 20.;
+    if (frequency < x->lowest)
+        frequency = x->lowest;
     /* length - approx filter delay */
     DLineL_setDelay(&x->delayLine, (x->srate / frequency) * .5 - 1.5);
 }
@@ -105,6 +119,8 @@ static t_int *clar_perform(t_int *w) {
     t_int n = w[3];
 
     t_float temp, breathPressure, pressureDiff;
+    t_float breath[STK_BLOCKSIZE];
+    t_int i, chunk;
 
     if (fr != x->fr_save) {
         setFreq(x, fr);
@@ -115,20 +131,32 @@ static t_int *clar_perform(t_int *w) {
 
     x->vibRate = VIBLENGTH * x->one_over_srate * vf;
 
-    while (n--) {
-        breathPressure = maxPressure + maxPressure * noiseGain * Noise_tick();
-        breathPressure += breathPressure * vibrGain * vib_tick(x);
-
-        pressureDiff = OneZero_tick(
-            &x->filter, x->delayLine.lastOutput); /* differential pressure  */
-        pressureDiff = (pressureDiff * -0.95) -
-                       breathPressure; /* of reflected and mouth */
-        *out++ = DLineL_tick(
-            &x->delayLine,
-            breathPressure + /* perform scattering     */
-                pressureDiff *
-                    ReedTabl_lookup(&x->reedTable,
-                                    pressureDiff)); /* in economical way      */
+    while (n > 0) {
+        chunk = n < STK_BLOCKSIZE ? n : STK_BLOCKSIZE;
+
+        /* breath pressure doesn't depend on the bore, do a chunk at once */
+        Noise_tickBlock(&x->noise, breath, chunk);
+        for (i = 0; i < chunk; i++) {
+            breathPressure = maxPressure + maxPressure * noiseGain * breath[i];
+            breathPressure += breathPressure * vibrGain * vib_tick(x);
+            breath[i] = breathPressure;
+        }
+
+        for (i = 0; i < chunk; i++) {
+            breathPressure = breath[i];
+            pressureDiff = OneZero_tick(
+                &x->filter, x->delayLine.lastOutput); /* differential pressure  */
+            pressureDiff = (pressureDiff * -0.95) -
+                           breathPressure; /* of reflected and mouth */
+            out[i] = DLineL_tick(
+                &x->delayLine,
+                breathPressure + /* perform scattering     */
+                    pressureDiff *
+                        ReedTabl_lookup(&x->reedTable,
+                                        pressureDiff)); /* in economical way      */
+        }
+        out += chunk;
+        n -= chunk;
     }
     return w + 4;
 }
@@ -136,7 +164,8 @@ static t_int *clar_perform(t_int *w) {
 void clar_dsp(t_clar *x, t_signal **sp) {
     x->srate = sp[0]->s_sr;
     x->one_over_srate = 1. / x->srate;
-    dsp_add(clar_perform, 3, x, sp[1]->s_vec, sp[0]->s_n);
+    clar_size(x);
+    Denormals_dspAdd(clar_perform, 3, x, sp[1]->s_vec, sp[0]->s_n);
 }
 
 static void clar_float(t_clar *x, t_floatarg f) { x->reedStiffness = f; }
@@ -151,6 +180,15 @@ static void clar_maxPressure(t_clar *x, t_floatarg f) { x->maxPressure = f; }
 
 static void clar_freq(t_clar *x, t_floatarg f) { x->x_fr = f; }
 
+static void clar_lowest(t_clar *x, t_floatarg f) {
+    x->lowest = f < 1. ? 1. : f;
+    clar_size(x);
+}
+
+static void clar_seed(t_clar *x, t_floatarg f) {
+    Noise_seed(&x->noise, (unsigned int)f);
+}
+
 static void clar_free(t_clar *x) { DLineL_free(&x->delayLine); }
 
 static void *clar_new(void) {
@@ -184,7 +222,8 @@ static void *clar_new(void) {
     x->srate = sys_getsr();
     x->one_over_srate = 1. / x->srate;
 
-    DLineL_alloc(&x->delayLine, LENGTH);
+    x->lowest = LOWEST;
+    clar_size(x);
 
     for (i = 0; i < VIBLENGTH; i++)
         x->vibTable[i] = sin(i * TWO_PI / VIBLENGTH);
@@ -198,6 +237,7 @@ static void *clar_new(void) {
     // initialize things
     DLineL_setDelay(&x->delayLine, 100.);
     OneZero_init(&x->filter);
+    Noise_init(&x->noise, 0);
 
     setFreq(x, x->x_fr);
     setVibFreq(x, 5.925);
@@ -229,4 +269,8 @@ void clarinet_tilde_setup(void) {
                     A_FLOAT, A_NULL);
     class_addmethod(clar_class, (t_method)clar_freq, gensym("freq"), A_FLOAT,
                     A_NULL);
+    class_addmethod(clar_class, (t_method)clar_lowest, gensym("lowest"),
+                    A_FLOAT, A_NULL);
+    class_addmethod(clar_class, (t_method)clar_seed, gensym("seed"), A_FLOAT,
+                    A_NULL);
 }
@@ -22,8 +22,7 @@
 #include "stk_c.h"
 #include <math.h>
 
-#define LENGTH 882 // 44100/LOWFREQ + 1 --flute length
-#define JETLENGTH (LENGTH >> 1)
+#define LOWEST 75. // lowest frequency the bore is sized for, by default
 #define VIBLENGTH 1024
 
 static t_class *flute_class;
@@ -53,6 +52,9 @@ typedef struct _flute {
     // DC blocker
     DCBlock killdc;
 
+    // breath noise
+    Noise noise;
+
     // vibrato table
     float vibTable[VIBLENGTH];
     float vibRate;
@@ -64,12 +66,26 @@ typedef struct _flute {
     float jetRatio;
     float lastFreq;
     float srate, one_over_srate;
+    float lowest;
 } t_flute;
 
 /****FUNCTIONS****/
 
 #define WATCHIT 0.00001
 
+// size the bore for the lowest frequency at this sample rate (it plays
+// at 2/3 of it), and the jet for half of that; new lines are tuned again
+// on the next block
+static void flute_size(t_flute *x) {
+    long length = DLine_lengthFor(x->srate, x->lowest, 1. / 0.66666, 0);
+    long jetlength = DLine_lengthFor(x->srate, x->lowest, .5 / 0.66666, 0);
+    if (length != x->boreDelay.length || jetlength != x->jetDelay.length) {
+        DLineL_resize(&x->boreDelay, length);
+        DLineL_resize(&x->jetDelay, jetlength);
+        x->fr_save = -1.;
+    }
+}
+
 static void setFreq(t_flute *x, float freq) {
     float temp;
     x->lastFreq = freq * 0.66666;
@@ -127,6 +143,8 @@ static t_int *flute_perform(t_int *w) {
     float jr = x->jetRefl;
     float er = x->endRefl;
     float temp, pressureDiff, randPressure;
+    float breath[STK_BLOCKSIZE];
+    long i, chunk;
 
     if (fr != x->fr_save) {
         setFreq(x, fr);
@@ -140,19 +158,27 @@ static t_int *flute_perform(t_int *w) {
         x->jd_save = jd;
     }
 
-    while (n--) {
+    while (n > 0) {
+        chunk = n < STK_BLOCKSIZE ? n : STK_BLOCKSIZE;
 
-        randPressure = ng * Noise_tick();
-        randPressure += va * vib_tick(x);
-        randPressure *= bp;
+        Noise_tickBlock(&x->noise, breath, chunk);
 
-        temp = OnePole_tick(&x->filter, x->boreDelay.lastOutput);
-        temp = DCBlock_tick(&x->killdc, temp);
-        pressureDiff = bp + randPressure - (jr * temp);
-        pressureDiff = DLineL_tick(&x->jetDelay, pressureDiff);
-        pressureDiff = JetTabl_lookup(pressureDiff) + (er * temp);
+        for (i = 0; i < chunk; i++) {
 
-        *out++ = DLineL_tick(&x->boreDelay, pressureDiff);
+            randPressure = ng * breath[i];
+            randPressure += va * vib_tick(x);
+            randPressure *= bp;
+
+            temp = OnePole_tick(&x->filter, x->boreDelay.lastOutput);
+            temp = DCBlock_tick(&x->killdc, temp);
+            pressureDiff = bp + randPressure - (jr * temp);
+            pressureDiff = DLineL_tick(&x->jetDelay, pressureDiff);
+            pressureDiff = JetTabl_lookup(pressureDiff) + (er * temp);
+
+            out[i] = DLineL_tick(&x->boreDelay, pressureDiff);
+        }
+        out += chunk;
+        n -= chunk;
     }
     return w + 4;
 }
@@ -161,7 +187,8 @@ static void flute_dsp(t_flute *x, t_signal **sp) {
     x->srate = sp[0]->s_sr;
     x->one_over_srate = 1. / x->srate;
     OnePole_setPole(&x->filter, 0.7 - (0.1 * 22050. / x->srate));
-    dsp_add(flute_perform, 3, x, sp[1]->s_vec, sp[0]->s_n);
+    flute_size(x);
+    Denormals_dspAdd(flute_perform, 3, x, sp[1]->s_vec, sp[0]->s_n);
 }
 
 static void flute_float(t_flute *x, t_floatarg f) { x->x_bp = f; }
@@ -176,6 +203,15 @@ static void flute_va(t_flute *x, t_floatarg f) { x->x_va = f; }
 
 static void flute_freq(t_flute *x, t_floatarg f) { x->x_fr = f; }
 
+static void flute_lowest(t_flute *x, t_floatarg f) {
+    x->lowest = f < 1. ? 1. : f;
+    flute_size(x);
+}
+
+static void flute_seed(t_flute *x, t_floatarg f) {
+    Noise_seed(&x->noise, (unsigned int)f);
+}
+
 static void flute_free(t_flute *x) {
     DLineL_free(&x->boreDelay);
     DLineL_free(&x->jetDelay);
@@ -205,12 +241,12 @@ static void *flute_new(void) {
     x->x_fr = 440.;
     x->lastFreq = 440.;
 
-    DLineL_alloc(&x->boreDelay, LENGTH);
-    DLineL_alloc(&x->jetDelay, JETLENGTH);
-
     x->srate = sys_getsr();
     x->one_over_srate = 1. / x->srate;
 
+    x->lowest = LOWEST;
+    flute_size(x);
+
     for (i = 0; i < VIBLENGTH; i++)
         x->vibTable[i] = sin(i * TWO_PI / VIBLENGTH);
     x->vibRate = 1.;
@@ -220,6 +256,7 @@ static void *flute_new(void) {
     DLineL_clear(&x->boreDelay);
     DLineL_clear(&x->jetDelay);
     OnePole_init(&x->filter);
+    Noise_init(&x->noise, 0);
 
     // initialize things
     x->endRefl = 0.5;
@@ -260,4 +297,8 @@ void flute_tilde_setup(void) {
                     A_NULL);
     class_addmethod(flute_class, (t_method)flute_freq, gensym("freq"), A_FLOAT,
                     A_NULL);
+    class_addmethod(flute_class, (t_method)flute_lowest, gensym("lowest"),
+                    A_FLOAT, A_NULL);
+    class_addmethod(flute_class, (t_method)flute_seed, gensym("seed"), A_FLOAT,
+                    A_NULL);
 }
@@ -24,10 +24,35 @@
 #include "mandimpulses.h"
 #include "stk_c.h"
 
-#define LENGTH 2048 // 44100/LOWFREQ + 1 --mando length
+#define LOWEST 21.5 // lowest frequency the strings are sized for, by default
 
 static t_class *mando_class;
 
+// one string pair with its pluck; the object has one of these, or a pool
+// of them when created with a voice count ([mandolin~ 16])
+typedef struct _mandovoice {
+    // delay lines0
+    DLineAf delayLine;
+    DLineAf delayLine2;
+    DLineL combDelay;
+
+    // impulse response files
+    HeaderSnd soundfile[12];
+
+    // filters
+    OneZero filter;
+    OneZero filter2;
+
+    float pluckAmp;
+    float loopGain;
+    float lastFreq;
+    float lastLength;
+    long dampTime;
+    int waveDone;
+
+    Silence silence;
+} t_mandovoice;
+
 typedef struct _mando {
     // header
     t_object x_obj;
@@ -42,7 +67,7 @@ typedef struct _mando {
 
     int mic; // directional position (NBody)
 
-    float fr_save, detuning_save;
+    float fr_save, detuning_save, stringDamping_save, bodySize_save;
 
     // signals connected? or controls...
     short pluckAmpconnected;
@@ -52,85 +77,168 @@ typedef struct _mando {
     short bodySizeconnected;
     short x_frconnected;
 
-    // delay lines0
-    DLineA delayLine;
-    DLineA delayLine2;
-    DLineL combDelay;
-
-    // impulse response files
-    HeaderSnd soundfile[12];
-
-    // filters
-    OneZero filter;
-    OneZero filter2;
+    // voices, just one unless polyphonic
+    t_mandovoice *voice;
+    int nvoices;
+    int poly;
+    VoicePool pool;
 
     // stuff
     long length;
-    float loopGain;
     float baseLoopGain;
-    float lastFreq;
-    float lastLength;
     short pluck;
-    long dampTime;
-    int waveDone;
     float directBody;
 
     float srate, one_over_srate;
+    float lowest;
 } t_mando;
 
 /****FUNCTIONS****/
 
-void pluck(t_mando *x, float amplitude,
+void pluck(t_mando *x, t_mandovoice *v, float amplitude,
            float position) { /* this function gets interesting here, */
     /* because pluck may be longer than     */
     /* string length, so we just reset the  */
     /* soundfile and add in the pluck in    */
     /* the tick method.                     */
     x->pluckPos = position; /* pluck position is zeroes at pos*length  */
-    HeaderSnd_reset(&x->soundfile[x->mic]);
-    x->pluckAmp = amplitude;
+    HeaderSnd_reset(&v->soundfile[x->mic]);
+    v->pluckAmp = amplitude;
     /* Set Pick Position which puts zeroes at pos*length  */
-    DLineL_setDelay(&x->combDelay, 0.5 * x->pluckPos * x->lastLength);
-    x->dampTime = (long)x->lastLength; /* See tick method below */
-    x->waveDone = 0;
+    DLineL_setDelay(&v->combDelay, 0.5 * x->pluckPos * v->lastLength);
+    v->dampTime = (long)v->lastLength; /* See tick method below */
+    v->waveDone = 0;
+    Silence_wake(&v->silence);
+}
+
+void noteOff(t_mandovoice *v, float amplitude) {
+    v->loopGain = (1.0 - amplitude) * 0.5; /* damp both strings */
 }
 
 void setBodySize(t_mando *x, float size) {
-    int i;
-    for (i = 0; i < 12; i++) {
-        HeaderSnd_setRate(&x->soundfile[i], size);
+    int i, k;
+    for (k = 0; k < x->nvoices; k++) {
+        for (i = 0; i < 12; i++) {
+            HeaderSnd_setRate(&x->voice[k].soundfile[i], size);
+        }
     }
 }
 
-void mando_bang(t_mando *x) { x->pluck = 1; }
+static void mando_note(t_mando *x, t_floatarg freq, t_floatarg amp);
 
-void setFreq(t_mando *x, float frequency) {
-    if (frequency < 20.)
-        frequency = 20.;
-    x->lastFreq = frequency;
-    x->lastLength = x->srate / x->lastFreq; /* length - delays */
+void mando_bang(t_mando *x) {
+    if (x->poly)
+        mando_note(x, x->x_fr, x->pluckAmp);
+    else
+        x->pluck = 1;
+}
+
+void setFreq(t_mando *x, t_mandovoice *v, float frequency) {
+    if (frequency < x->lowest)
+        frequency = x->lowest;
+    v->lastFreq = frequency;
+    v->lastLength = x->srate / v->lastFreq; /* length - delays */
     if (x->detuning != 0.) {
-        DLineA_setDelay(&x->delayLine, (x->lastLength / x->detuning) - .5);
-        DLineA_setDelay(&x->delayLine2, (x->lastLength * x->detuning) - .5);
+        DLineAf_setDelay(&v->delayLine, (v->lastLength / x->detuning) - .5);
+        DLineAf_setDelay(&v->delayLine2, (v->lastLength * x->detuning) - .5);
     }
-    x->loopGain = x->baseLoopGain + (frequency * 0.000005);
-    if (x->loopGain > 1.0)
-        x->loopGain = 0.99999;
+    v->loopGain = x->baseLoopGain + (frequency * 0.000005);
+    if (v->loopGain > 1.0)
+        v->loopGain = 0.99999;
 }
 
 void setDetune(t_mando *x, float detune) {
+    t_mandovoice *v;
+    int k;
     if (detune != 0.) {
         x->detuning = detune;
-        DLineA_setDelay(&x->delayLine, (x->lastLength / x->detuning) - .5);
-        DLineA_setDelay(&x->delayLine2, (x->lastLength * x->detuning) - .5);
+        for (k = 0; k < x->nvoices; k++) {
+            v = &x->voice[k];
+            DLineAf_setDelay(&v->delayLine, (v->lastLength / x->detuning) - .5);
+            DLineAf_setDelay(&v->delayLine2, (v->lastLength * x->detuning) - .5);
+        }
     }
 }
 
 void setBaseLoopGain(t_mando *x, float aGain) {
+    t_mandovoice *v;
+    int k;
     x->baseLoopGain = aGain;
-    x->loopGain = x->baseLoopGain + (x->lastFreq * 0.000005);
-    if (x->loopGain > 1.0)
-        x->loopGain = 0.99999;
+    for (k = 0; k < x->nvoices; k++) {
+        v = &x->voice[k];
+        v->loopGain = x->baseLoopGain + (v->lastFreq * 0.000005);
+        if (v->loopGain > 1.0)
+            v->loopGain = 0.99999;
+    }
+}
+
+/* runs one voice over the block, just zeros once it has died away */
+static void mando_voice_perform(t_mando *x, t_mandovoice *v, t_float *out,
+                                long n) {
+    float temp, lastOutput;
+    float excite[STK_BLOCKSIZE], comb[STK_BLOCKSIZE];
+    t_float *out0 = out;
+    long n0 = n;
+    long i, chunk;
+
+    if (Silence_sleeping(&v->silence, v->waveDone ? 0. : v->pluckAmp)) {
+        for (i = 0; i < n; i++)
+            out[i] = 0.;
+        return;
+    }
+
+    while (n > 0) {
+        chunk = n < STK_BLOCKSIZE ? n : STK_BLOCKSIZE;
+
+        /* pluck excitation and pick position comb, a block at a time */
+        v->waveDone = HeaderSnd_tickBlock(&v->soundfile[x->mic], excite, chunk);
+        for (i = 0; i < chunk; i++)
+            excite[i] *= v->pluckAmp;
+        DLineL_tickBlock(&v->combDelay, excite, comb, chunk);
+
+        /* the strings are feedback loops and have to run per sample */
+        for (i = 0; i < chunk; i++) {
+            /* //this is busted, for some mysterious reason...
+            if (!v->waveDone)      {
+                v->waveDone = HeaderSnd_informTick(&v->soundfile[x->mic]);
+                temp = v->soundfile[x->mic].lastOutput * pluckAmp;
+                temp = temp - DLineL_tick(&v->combDelay, temp);
+            }
+            */
+
+            temp = excite[i] - comb[i];
+
+            if (v->dampTime >= 0) { /* Damping hack to help avoid */
+                v->dampTime -= 1;   /* overflow on replucking     */
+                lastOutput = DLineAf_tick(
+                    &v->delayLine,                  /* Calculate 1st delay */
+                    OneZero_tick(&v->filter, temp + /* filterered reflection      */
+                                                 (v->delayLine.lastOutput *
+                                                  .7))); /* plus pluck excitation */
+                lastOutput += DLineAf_tick(
+                    &v->delayLine2, /* and 2nd delay              */
+                    OneZero_tick(&v->filter2, temp + /* just like the 1st */
+                                                  (v->delayLine2.lastOutput * .7)));
+            } else { /*  No damping hack after 1 period */
+                lastOutput = DLineAf_tick(
+                    &v->delayLine, /* Calculate 1st delay */
+                    OneZero_tick(&v->filter,
+                                 temp + /* filterered reflection      */
+                                     (v->delayLine.lastOutput *
+                                      v->loopGain))); /* plus pluck excitation */
+                lastOutput += DLineAf_tick(
+                    &v->delayLine2, /* and 2nd delay              */
+                    OneZero_tick(&v->filter2,
+                                 temp + /* just like the 1st          */
+                                     (v->delayLine2.lastOutput * v->loopGain)));
+            }
+
+            out[i] = lastOutput;
+        }
+        out += chunk;
+        n -= chunk;
+    }
+    Silence_check(&v->silence, out0, (int)n0, v->waveDone ? 0. : v->pluckAmp);
 }
 
 static t_int *mando_perform(t_int *w) {
@@ -144,70 +252,79 @@ static t_int *mando_perform(t_int *w) {
     float fr = x->x_fr;
     t_float *out = (float *)(w[2]);
     long n = w[3];
-
-    float temp, lastOutput;
-
-    if (fr != x->fr_save) {
-        setFreq(x, fr);
-        x->fr_save = fr;
+    t_float buf[STK_BLOCKSIZE];
+    long i, j, m;
+    int k;
+
+    // every voice has twelve body files to rerate, so only on a change
+    if (bodySize != x->bodySize_save) {
+        setBodySize(x, bodySize);
+        x->bodySize_save = bodySize;
     }
 
-    setBodySize(x, bodySize);
-    setBaseLoopGain(x, stringDamping);
+    // only on a change, so the strings a note off damped stay damped
+    if (stringDamping != x->stringDamping_save) {
+        setBaseLoopGain(x, stringDamping);
+        x->stringDamping_save = stringDamping;
+    }
 
     if (detuning != x->detuning_save) {
         setDetune(x, detuning);
         x->detuning_save = detuning;
     }
 
-    if (x->pluck) {
-        pluck(x, pluckAmp, pluckPos);
-        x->pluck = 0;
-    }
-
-    while (n--) {
-        /* //this is busted, for some mysterious reason...
-        if (!x->waveDone)      {
-            x->waveDone = HeaderSnd_informTick(&x->soundfile[x->mic]);
-            temp = x->soundfile[x->mic].lastOutput * pluckAmp;
-            temp = temp - DLineL_tick(&x->combDelay, temp);
+    if (!x->poly) {
+        if (fr != x->fr_save) {
+            setFreq(x, &x->voice[0], fr);
+            x->fr_save = fr;
         }
-        */
-
-        x->waveDone = HeaderSnd_informTick(&x->soundfile[x->mic]);
-        temp = x->soundfile[x->mic].lastOutput * pluckAmp;
-        temp = temp - DLineL_tick(&x->combDelay, temp);
-
-        if (x->dampTime >= 0) { /* Damping hack to help avoid */
-            x->dampTime -= 1;   /* overflow on replucking     */
-            lastOutput = DLineA_tick(
-                &x->delayLine,                  /* Calculate 1st delay */
-                OneZero_tick(&x->filter, temp + /* filterered reflection      */
-                                             (x->delayLine.lastOutput *
-                                              .7))); /* plus pluck excitation */
-            lastOutput += DLineA_tick(
-                &x->delayLine2, /* and 2nd delay              */
-                OneZero_tick(&x->filter2, temp + /* just like the 1st */
-                                              (x->delayLine2.lastOutput * .7)));
-        } else { /*  No damping hack after 1 period */
-            lastOutput = DLineA_tick(
-                &x->delayLine, /* Calculate 1st delay */
-                OneZero_tick(&x->filter,
-                             temp + /* filterered reflection      */
-                                 (x->delayLine.lastOutput *
-                                  x->loopGain))); /* plus pluck excitation */
-            lastOutput += DLineA_tick(
-                &x->delayLine2, /* and 2nd delay              */
-                OneZero_tick(&x->filter2,
-                             temp + /* just like the 1st          */
-                                 (x->delayLine2.lastOutput * x->loopGain)));
+
+        if (x->pluck) {
+            pluck(x, &x->voice[0], pluckAmp, pluckPos);
+            x->pluck = 0;
         }
 
-        *out++ = lastOutput;
+        x->voice[0].pluckAmp = pluckAmp;
+        mando_voice_perform(x, &x->voice[0], out, n);
+        return w + 4;
+    }
+
+    /* polyphonic: every voice still ringing, summed */
+    for (k = 0; k < n; k++)
+        out[k] = 0.;
+    for (k = 0; k < x->nvoices; k++) {
+        if (!VoicePool_active(&x->pool, k) || x->voice[k].silence.asleep)
+            continue;
+        for (i = 0; i < n; i += m) {
+            m = n - i < STK_BLOCKSIZE ? n - i : STK_BLOCKSIZE;
+            mando_voice_perform(x, &x->voice[k], buf, m);
+            for (j = 0; j < m; j++)
+                out[i + j] += buf[j];
+        }
     }
     return w + 4;
 }
 
+// size every voice's strings for the lowest frequency at this sample rate,
+// with a little room for the detuning; voices are tuned again afterwards
+static void mando_size(t_mando *x) {
+    t_mandovoice *v;
+    long length = DLine_lengthFor(x->srate, x->lowest, 1.01, 0);
+    int k;
+    if (length == x->length)
+        return;
+    x->length = length;
+    for (k = 0; k < x->nvoices; k++) {
+        v = &x->voice[k];
+        DLineAf_resize(&v->delayLine, length);
+        DLineAf_resize(&v->delayLine2, length);
+        DLineL_resize(&v->combDelay, length);
+        setFreq(x, v, v->lastFreq);
+        DLineL_setDelay(&v->combDelay, 0.5 * x->pluckPos * v->lastLength);
+    }
+    x->fr_save = -1.;
+}
+
 static void mando_dsp(t_mando *x, t_signal **sp) {
     /* 	x->pluckAmpconnected 		= count[0];
      x->pluckPosconnected 		= count[1];
@@ -218,7 +335,8 @@ static void mando_dsp(t_mando *x, t_signal **sp) {
 
     x->srate = sp[0]->s_sr;
     x->one_over_srate = 1. / x->srate;
-    dsp_add(mando_perform, 3, x, sp[1]->s_vec, sp[0]->s_n);
+    mando_size(x);
+    Denormals_dspAdd(mando_perform, 3, x, sp[1]->s_vec, sp[0]->s_n);
 }
 
 static void setmic(t_mando *x, t_floatarg argc) {
@@ -240,17 +358,56 @@ static void mando_bodySize(t_mando *x, t_floatarg f) { x->bodySize = f; }
 
 static void mando_freq(t_mando *x, t_floatarg f) { x->x_fr = f; }
 
+static void mando_lowest(t_mando *x, t_floatarg f) {
+    x->lowest = f < 1. ? 1. : f;
+    mando_size(x);
+}
+
+static void mando_sleep(t_mando *x, t_floatarg f) {
+    int k;
+    for (k = 0; k < x->nvoices; k++)
+        Silence_setThreshold(&x->voice[k].silence, f);
+}
+
+/* polyphonic only: pluck a voice at freq, amp 0 damps it */
+static void mando_note(t_mando *x, t_floatarg freq, t_floatarg amp) {
+    int k;
+    if (!x->poly) {
+        pd_error(x, "mandolin~: note needs a voice count argument");
+        return;
+    }
+    if (amp <= 0.) {
+        k = VoicePool_noteOff(&x->pool, freq);
+        if (k >= 0)
+            noteOff(&x->voice[k], 0.);
+        return;
+    }
+    k = VoicePool_noteOn(&x->pool, freq);
+    if (k < 0)
+        return;
+    setFreq(x, &x->voice[k], freq);
+    pluck(x, &x->voice[k], amp, x->pluckPos);
+}
+
 static void mando_free(t_mando *x) {
-    int i;
-    DLineA_free(&x->delayLine);
-    DLineA_free(&x->delayLine2);
-    DLineL_free(&x->combDelay);
-    for (i = 0; i < 12; i++)
-        HeaderSnd_free(&x->soundfile[i]);
+    int i, k;
+    for (k = 0; k < x->nvoices; k++) {
+        DLineAf_free(&x->voice[k].delayLine);
+        DLineAf_free(&x->voice[k].delayLine2);
+        DLineL_free(&x->voice[k].combDelay);
+        for (i = 0; i < 12; i++)
+            HeaderSnd_free(&x->voice[k].soundfile[i]);
+    }
+    if (x->voice)
+        freebytes(x->voice, x->nvoices * sizeof(t_mandovoice));
+    if (x->poly)
+        VoicePool_free(&x->pool);
 }
 
-static void *mando_new(void) {
+static void *mando_new(t_floatarg voices) {
     unsigned int i;
+    int k;
+    t_mandovoice *v;
     char temp[128];
 
     t_mando *x = (t_mando *)pd_new(mando_class);
@@ -267,44 +424,66 @@ static void *mando_new(void) {
     inlet_new(&x->x_obj, &x->x_obj.ob_pd, &s_float, gensym("bodySize"));
     inlet_new(&x->x_obj, &x->x_obj.ob_pd, &s_float, gensym("freq"));
 
-    x->length = LENGTH;
+    // [mandolin~ N] plays N voices from note messages, no argument is
+    // the single voice played from the inlets
+    x->poly = voices >= 1;
+    x->nvoices = x->poly ? (int)voices : 1;
+    x->voice = getbytes(x->nvoices * sizeof(t_mandovoice));
+    if (!x->voice) {
+        pd_error(x, "mandolin~: out of memory for %d voices", x->nvoices);
+        return (0);
+    }
+    if (x->poly && !VoicePool_alloc(&x->pool, x->nvoices)) {
+        freebytes(x->voice, x->nvoices * sizeof(t_mandovoice));
+        return (0);
+    }
+
+    x->lowest = LOWEST;
+    x->length = DLine_lengthFor(sys_getsr(), x->lowest, 1.01, 0);
     x->baseLoopGain = 0.995;
-    x->loopGain = 0.999;
     x->directBody = 1.0;
     x->mic = 0;
-    x->dampTime = 0;
-    x->waveDone = 1;
     x->pluckAmp = 0.3;
     x->pluckPos = 0.4;
     x->detuning = 0.995;
-    x->lastFreq = 80.;
-    x->lastLength = x->length * 0.5;
     x->x_fr = 440.;
     x->pluck = 0;
 
     x->srate = sys_getsr();
     x->one_over_srate = 1. / x->srate;
 
-    DLineA_alloc(&x->delayLine, LENGTH);
-    DLineA_alloc(&x->delayLine2, LENGTH);
-    DLineL_alloc(&x->combDelay, LENGTH);
-
-    // clear stuff
-    DLineA_clear(&x->delayLine);
-    DLineA_clear(&x->delayLine2);
-    DLineL_clear(&x->combDelay);
-    OneZero_init(&x->filter);
-    OneZero_init(&x->filter2);
+    for (k = 0; k < x->nvoices; k++) {
+        v = &x->voice[k];
+        v->loopGain = 0.999;
+        v->dampTime = 0;
+        v->waveDone = 1;
+        v->lastFreq = 80.;
+        v->lastLength = x->length * 0.5;
+
+        DLineAf_alloc(&v->delayLine, x->length);
+        DLineAf_alloc(&v->delayLine2, x->length);
+        DLineL_alloc(&v->combDelay, x->length);
+
+        // clear stuff
+        DLineAf_clear(&v->delayLine);
+        DLineAf_clear(&v->delayLine2);
+        DLineL_clear(&v->combDelay);
+        OneZero_init(&v->filter);
+        OneZero_init(&v->filter2);
+        Silence_init(&v->silence);
+
+        // impulse responses
+        for (i = 0; i < 12; i++) {
+            HeaderSnd_alloc(&v->soundfile[i], &mand[i][0], 721, "oneshot");
+        }
 
-    // impulse responses
-    for (i = 0; i < 12; i++) {
-        HeaderSnd_alloc(&x->soundfile[i], &mand[i][0], 721, "oneshot");
+        setFreq(x, v, x->x_fr);
     }
 
-    setFreq(x, x->x_fr);
-
     x->fr_save = x->x_fr;
     x->detuning_save = x->detuning;
+    x->stringDamping_save = -1.;
+    x->bodySize_save = -1.;
 
     post("if you believe the mandolin is linear, i've got another one for "
          "ya...");
@@ -314,7 +493,8 @@ static void *mando_new(void) {
 
 void mandolin_tilde_setup(void) {
     mando_class = class_new(gensym("mandolin~"), (t_newmethod)mando_new,
-                            (t_method)mando_free, sizeof(t_mando), 0, 0);
+                            (t_method)mando_free, sizeof(t_mando), 0,
+                            A_DEFFLOAT, 0);
     class_addmethod(mando_class, nullfn, gensym("signal"), A_NULL);
     class_addmethod(mando_class, (t_method)mando_dsp, gensym("dsp"), A_NULL);
     class_addfloat(mando_class, (t_method)mando_float);
@@ -331,4 +511,10 @@ void mandolin_tilde_setup(void) {
                     A_NULL);
     class_addmethod(mando_class, (t_method)setmic, gensym("setmic"), A_FLOAT,
                     0);
+    class_addmethod(mando_class, (t_method)mando_note, gensym("note"), A_FLOAT,
+                    A_FLOAT, A_NULL);
+    class_addmethod(mando_class, (t_method)mando_sleep, gensym("sleep"), A_FLOAT,
+                    A_NULL);
+    class_addmethod(mando_class, (t_method)mando_lowest, gensym("lowest"),
+                    A_FLOAT, A_NULL);
 }
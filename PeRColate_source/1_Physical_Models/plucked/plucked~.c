@@ -16,9 +16,24 @@
 #include "stk_c.h"
 #include <math.h>
 
-#define LENGTH 1024 // 44100/LOWFREQ + 1 --plucked length
+#define LOWEST 43.1 // lowest frequency the strings are sized for, by default
 static t_class *plucked_class;
 
+// one string; [plucked~ N] keeps a pool of N of them
+typedef struct _pluckedvoice {
+    // delay lines
+    DLineAf delayLine;
+
+    // filters
+    OneZero loopFilt;
+    OnePole pickFilt;
+
+    float loopGain;
+    float lastFreq;
+
+    Silence silence;
+} t_pluckedvoice;
+
 typedef struct _plucked {
     // header
     t_object x_obj;
@@ -33,47 +48,85 @@ typedef struct _plucked {
     short x_pluckAmpconnected;
     short x_frconnected;
 
-    // delay lines
-    DLineA delayLine;
+    // voices, just one unless polyphonic
+    t_pluckedvoice *voice;
+    int nvoices;
+    int poly;
+    VoicePool pool;
 
-    // filters
-    OneZero loopFilt;
-    OnePole pickFilt;
+    // pluck noise
+    Noise noise;
 
     // stuff
     long length;
-    float loopGain;
     short pluck;
 
     float srate, one_over_srate;
+    float lowest;
 } t_plucked;
 
 /****FUNCTIONS****/
 
-static void plucked_bang(t_plucked *x) { x->pluck = 1; }
+static void plucked_note(t_plucked *x, t_floatarg freq, t_floatarg amp);
+
+static void plucked_bang(t_plucked *x) {
+    if (x->poly)
+        plucked_note(x, x->x_fr, x->x_pluckAmp == 0 ? 1 : x->x_pluckAmp);
+    else
+        x->pluck = 1;
+}
 
-static void setFreq(t_plucked *x, float frequency) {
+static void setFreq(t_plucked *x, t_pluckedvoice *v, float frequency) {
     float delay;
-    if (frequency < 20.)
-        frequency = 20.;
+    if (frequency < x->lowest)
+        frequency = x->lowest;
+    v->lastFreq = frequency;
     delay = (x->srate / frequency) - 0.5; /* length - delays */
-    DLineA_setDelay(&x->delayLine, delay);
-    x->loopGain = 0.995 + (frequency * 0.000005);
-    if (x->loopGain > 1.0)
-        x->loopGain = 0.99999;
+    DLineAf_setDelay(&v->delayLine, delay);
+    v->loopGain = 0.995 + (frequency * 0.000005);
+    if (v->loopGain > 1.0)
+        v->loopGain = 0.99999;
 }
 
-static void pluck(t_plucked *x, float amplitude) {
+static void pluck(t_plucked *x, t_pluckedvoice *v, float amplitude) {
     long i;
-    OnePole_setPole(&x->pickFilt, 0.999 - (amplitude * 0.15));
-    OnePole_setGain(&x->pickFilt, amplitude * 0.5);
+    OnePole_setPole(&v->pickFilt, 0.999 - (amplitude * 0.15));
+    OnePole_setGain(&v->pickFilt, amplitude * 0.5);
     for (i = 0; i < x->length; i++)
-        DLineA_tick(&x->delayLine,
-                    x->delayLine.lastOutput +
-                        OnePole_tick(&x->pickFilt, Noise_tick()));
+        DLineAf_tick(&v->delayLine,
+                    v->delayLine.lastOutput +
+                        OnePole_tick(&v->pickFilt, Noise_tick(&x->noise)));
     /* fill delay with noise    */
     /* additively with current  */
     /* contents                 */
+    Silence_wake(&v->silence);
+}
+
+static void noteOff(t_pluckedvoice *v, float amplitude) {
+    v->loopGain = (1.0 - amplitude) * 0.5; /* damp the string */
+}
+
+/* runs one string over the block, just zeros once it has died away */
+static void plucked_voice_perform(t_pluckedvoice *v, t_float *out, int n) {
+    t_float *out0 = out;
+    int n0 = n;
+    float temp;
+
+    if (Silence_sleeping(&v->silence, 0.)) {
+        while (n--)
+            *out++ = 0.;
+        return;
+    }
+
+    while (n--) {
+        /* check this out */
+        /* here's the whole inner loop of the instrument!!  */
+        temp = DLineAf_tick(
+            &v->delayLine,
+            OneZero_tick(&v->loopFilt, v->delayLine.lastOutput * v->loopGain));
+        *out++ = temp * 3.;
+    }
+    Silence_check(&v->silence, out0, n0, 0.);
 }
 
 static t_int *plucked_perform(t_int *w) {
@@ -84,46 +137,120 @@ static t_int *plucked_perform(t_int *w) {
     t_float *out = (t_float *)(w[2]);
     int n = (int)(w[3]);
 
-    float temp;
+    t_float buf[STK_BLOCKSIZE];
+    int i, j, k, m;
 
-    if (fr == 0)
-        fr = 440;
-    if (pluckAmp == 0)
-        pluckAmp = 1;
+    if (!x->poly) {
+        if (fr == 0)
+            fr = 440;
+        if (pluckAmp == 0)
+            pluckAmp = 1;
 
-    if (fr != x->fr_save) {
-        setFreq(x, fr);
-        x->fr_save = fr;
-    }
+        if (fr != x->fr_save) {
+            setFreq(x, &x->voice[0], fr);
+            x->fr_save = fr;
+        }
+
+        if (x->pluck) {
+            pluck(x, &x->voice[0], pluckAmp);
+            x->pluck = 0;
+        }
 
-    if (x->pluck) {
-        pluck(x, pluckAmp);
-        x->pluck = 0;
+        plucked_voice_perform(&x->voice[0], out, n);
+        return w + 4;
     }
 
-    while (n--) {
-        /* check this out */
-        /* here's the whole inner loop of the instrument!!  */
-        temp = DLineA_tick(
-            &x->delayLine,
-            OneZero_tick(&x->loopFilt, x->delayLine.lastOutput * x->loopGain));
-        *out++ = temp * 3.;
+    /* polyphonic: every string still ringing, summed */
+    for (k = 0; k < n; k++)
+        out[k] = 0.;
+    for (k = 0; k < x->nvoices; k++) {
+        if (!VoicePool_active(&x->pool, k) || x->voice[k].silence.asleep)
+            continue;
+        for (i = 0; i < n; i += m) {
+            m = n - i < STK_BLOCKSIZE ? n - i : STK_BLOCKSIZE;
+            plucked_voice_perform(&x->voice[k], buf, m);
+            for (j = 0; j < m; j++)
+                out[i + j] += buf[j];
+        }
     }
     return w + 4;
 }
 
+// size every string for the lowest frequency at this sample rate; the
+// voices are tuned again afterwards
+static void plucked_size(t_plucked *x) {
+    long length = DLine_lengthFor(x->srate, x->lowest, 1., 0);
+    int k;
+    if (length == x->length)
+        return;
+    x->length = length;
+    for (k = 0; k < x->nvoices; k++) {
+        DLineAf_resize(&x->voice[k].delayLine, length);
+        setFreq(x, &x->voice[k], x->voice[k].lastFreq);
+    }
+    x->fr_save = -1.;
+}
+
 void plucked_dsp(t_plucked *x, t_signal **sp) {
-    dsp_add(plucked_perform, 3, x, sp[1]->s_vec, sp[0]->s_n);
+    x->srate = sp[0]->s_sr;
+    x->one_over_srate = 1. / x->srate;
+    plucked_size(x);
+    Denormals_dspAdd(plucked_perform, 3, x, sp[1]->s_vec, sp[0]->s_n);
 }
 
 static void plucked_float(t_plucked *x, t_floatarg f) { x->x_pluckAmp = f; }
 
 static void plucked_freq(t_plucked *x, t_floatarg g) { x->x_fr = g; }
 
-static void plucked_free(t_plucked *x) { DLineA_free(&x->delayLine); }
+static void plucked_lowest(t_plucked *x, t_floatarg f) {
+    x->lowest = f < 1. ? 1. : f;
+    plucked_size(x);
+}
+
+static void plucked_seed(t_plucked *x, t_floatarg f) {
+    Noise_seed(&x->noise, (unsigned int)f);
+}
+
+static void plucked_sleep(t_plucked *x, t_floatarg f) {
+    int k;
+    for (k = 0; k < x->nvoices; k++)
+        Silence_setThreshold(&x->voice[k].silence, f);
+}
 
-void *plucked_new(void) {
+/* polyphonic only: pluck a string at freq, amp 0 damps it */
+static void plucked_note(t_plucked *x, t_floatarg freq, t_floatarg amp) {
+    int k;
+    if (!x->poly) {
+        pd_error(x, "plucked~: note needs a voice count argument");
+        return;
+    }
+    if (amp <= 0.) {
+        k = VoicePool_noteOff(&x->pool, freq);
+        if (k >= 0)
+            noteOff(&x->voice[k], 0.);
+        return;
+    }
+    k = VoicePool_noteOn(&x->pool, freq);
+    if (k < 0)
+        return;
+    setFreq(x, &x->voice[k], freq);
+    pluck(x, &x->voice[k], amp);
+}
+
+static void plucked_free(t_plucked *x) {
+    int k;
+    for (k = 0; k < x->nvoices; k++)
+        DLineAf_free(&x->voice[k].delayLine);
+    if (x->voice)
+        freebytes(x->voice, x->nvoices * sizeof(t_pluckedvoice));
+    if (x->poly)
+        VoicePool_free(&x->pool);
+}
+
+void *plucked_new(t_floatarg voices) {
     unsigned int i;
+    int k;
+    t_pluckedvoice *v;
 
     t_plucked *x = (t_plucked *)pd_new(plucked_class);
 
@@ -140,24 +267,45 @@ void *plucked_new(void) {
 
     inlet_new(&x->x_obj, &x->x_obj.ob_pd, &s_float, gensym("freq"));
 
-    x->length = LENGTH;
+    // [plucked~ N] plays N strings from note messages, no argument is
+    // the single string played from the inlets
+    x->poly = voices >= 1;
+    x->nvoices = x->poly ? (int)voices : 1;
+    x->voice = getbytes(x->nvoices * sizeof(t_pluckedvoice));
+    if (!x->voice) {
+        pd_error(x, "plucked~: out of memory for %d voices", x->nvoices);
+        return (0);
+    }
+    if (x->poly && !VoicePool_alloc(&x->pool, x->nvoices)) {
+        freebytes(x->voice, x->nvoices * sizeof(t_pluckedvoice));
+        return (0);
+    }
 
     x->srate = sys_getsr();
     x->one_over_srate = 1. / x->srate;
 
-    DLineA_alloc(&x->delayLine, LENGTH);
+    x->lowest = LOWEST;
+    x->length = DLine_lengthFor(x->srate, x->lowest, 1., 0);
+
+    Noise_init(&x->noise, 0);
 
-    // clear stuff
-    DLineA_clear(&x->delayLine);
-    OnePole_init(&x->pickFilt);
-    OneZero_init(&x->loopFilt);
+    for (k = 0; k < x->nvoices; k++) {
+        v = &x->voice[k];
+        DLineAf_alloc(&v->delayLine, x->length);
 
-    // initialize things
-    // length = (long) (SRATE / lowestFreq + 1);
-    x->loopGain = 0.999;
-    DLineA_setDelay(&x->delayLine, 100.);
+        // clear stuff
+        DLineAf_clear(&v->delayLine);
+        OnePole_init(&v->pickFilt);
+        OneZero_init(&v->loopFilt);
+        Silence_init(&v->silence);
 
-    setFreq(x, x->x_fr);
+        // initialize things
+        // length = (long) (SRATE / lowestFreq + 1);
+        v->loopGain = 0.999;
+        DLineAf_setDelay(&v->delayLine, 100.);
+
+        setFreq(x, v, x->x_fr);
+    }
 
     x->fr_save = x->x_fr;
 
@@ -171,7 +319,8 @@ void *plucked_new(void) {
 
 void plucked_tilde_setup(void) {
     plucked_class = class_new(gensym("plucked~"), (t_newmethod)plucked_new,
-                              (t_method)plucked_free, sizeof(t_plucked), 0, 0);
+                              (t_method)plucked_free, sizeof(t_plucked), 0,
+                              A_DEFFLOAT, 0);
     class_addmethod(plucked_class, nullfn, gensym("signal"), A_NULL);
     class_addmethod(plucked_class, (t_method)plucked_dsp, gensym("dsp"),
                     A_NULL);
@@ -179,4 +328,12 @@ void plucked_tilde_setup(void) {
     class_addbang(plucked_class, (t_method)plucked_bang);
     class_addmethod(plucked_class, (t_method)plucked_freq, gensym("freq"),
                     A_FLOAT, A_NULL);
+    class_addmethod(plucked_class, (t_method)plucked_seed, gensym("seed"),
+                    A_FLOAT, A_NULL);
+    class_addmethod(plucked_class, (t_method)plucked_note, gensym("note"),
+                    A_FLOAT, A_FLOAT, A_NULL);
+    class_addmethod(plucked_class, (t_method)plucked_sleep, gensym("sleep"),
+                    A_FLOAT, A_NULL);
+    class_addmethod(plucked_class, (t_method)plucked_lowest, gensym("lowest"),
+                    A_FLOAT, A_NULL);
 }
@@ -106,17 +106,15 @@ static t_int *agogo_perform(t_int *w) {
     HeaderSnd_setFreq(&x->modal.vibr, vf, x->srate);
     x->modal.vibrGain = va;
 
-    while (n--) {
+    Modal4_tickBlock(&x->modal, out, n);
 
-        *out++ = Modal4_tick(&x->modal);
-    }
     return w + 4;
 }
 
 static void agogo_dsp(t_agogo *x, t_signal **sp) {
     x->srate = sp[0]->s_sr;
     x->one_over_srate = 1. / x->srate;
-    dsp_add(agogo_perform, 3, x, sp[1]->s_vec, sp[0]->s_n);
+    Denormals_dspAdd(agogo_perform, 3, x, sp[1]->s_vec, sp[0]->s_n);
 }
 
 /* ----- handle data from inlets ------ */
@@ -19,6 +19,13 @@
 
 static t_class *marimba_class;
 
+// one bar; [marimba~ N] keeps a pool of N of them
+typedef struct _marimbavoice {
+    Modal4 modal;
+    int multiStrike;
+    Silence silence;
+} t_marimbavoice;
+
 typedef struct _marimba {
     // header
     t_object x_obj;
@@ -33,7 +40,14 @@ typedef struct _marimba {
 
     float fr_save, sh_save, spos_save, sa_save;
 
-    Modal4 modal;
+    // voices, just one unless polyphonic
+    t_marimbavoice *voice;
+    int nvoices;
+    int poly;
+    VoicePool pool;
+
+    // picks the multiple strikes
+    Noise noise;
 
     // signals connected? or controls...
     short x_shconnected;
@@ -44,42 +58,81 @@ typedef struct _marimba {
     short x_frconnected;
 
     // stuff
-    int multiStrike;
     float srate, one_over_srate;
 } t_marimba;
 
 /****FUNCTIONS****/
 static void Marimba_setStickHardness(t_marimba *x, float hardness) {
+    int k;
     x->x_sh = hardness;
-    HeaderSnd_setRate(&x->modal.wave, (0.25 * pow(4.0, x->x_sh)));
-    x->modal.masterGain = 0.1 + (1.8 * x->x_sh);
+    for (k = 0; k < x->nvoices; k++) {
+        HeaderSnd_setRate(&x->voice[k].modal.wave, (0.25 * pow(4.0, x->x_sh)));
+        x->voice[k].modal.masterGain = 0.1 + (1.8 * x->x_sh);
+    }
 }
 
 static void Marimba_setStrikePosition(t_marimba *x, float position) {
     float temp, temp2;
+    int k;
     temp2 = position * M_PI;
     x->x_spos = position; /*  Hack only first three modes */
-    temp = sin(temp2);
-    Modal4_setFiltGain(&x->modal, 0,
-                       .12 * temp); /*  1st mode function of pos.   */
-    temp = sin(0.05 + (3.9 * temp2));
-    Modal4_setFiltGain(&x->modal, 1,
-                       -.03 * temp); /*  2nd mode function of pos.   */
-    temp = sin(-0.05 + (11. * temp2));
-    Modal4_setFiltGain(&x->modal, 2,
-                       .11 * temp); /*  3rd mode function of pos.   */
+    for (k = 0; k < x->nvoices; k++) {
+        temp = sin(temp2);
+        Modal4_setFiltGain(&x->voice[k].modal, 0,
+                           .12 * temp); /*  1st mode function of pos.   */
+        temp = sin(0.05 + (3.9 * temp2));
+        Modal4_setFiltGain(&x->voice[k].modal, 1,
+                           -.03 * temp); /*  2nd mode function of pos.   */
+        temp = sin(-0.05 + (11. * temp2));
+        Modal4_setFiltGain(&x->voice[k].modal, 2,
+                           .11 * temp); /*  3rd mode function of pos.   */
+    }
 }
 
-static void Marimba_strike(t_marimba *x, float amplitude) {
+static void Marimba_strike(t_marimba *x, t_marimbavoice *v, float amplitude) {
     int temp;
-    temp = rand() >> 10;
+    temp = Noise_random(&x->noise, 32); /* was rand() >> 10 with 15 bit rand() */
     if (temp < 2) {
-        x->multiStrike = 1;
+        v->multiStrike = 1;
     } else if (temp < 1) {
-        x->multiStrike = 2;
+        v->multiStrike = 2;
+    } else
+        v->multiStrike = 0;
+    Modal4_strike(&v->modal, amplitude);
+    Silence_wake(&v->silence);
+}
+
+/* the stick is still sounding, or about to strike again */
+#define marimba_excitation(v) \
+    ((v)->modal.wave.finished && !(v)->multiStrike ? 0. : 1.)
+
+/* runs one bar over the block, just zeros once it has died away */
+static void marimba_voice_perform(t_marimbavoice *v, t_float *out, long n) {
+    t_float *out0 = out;
+    long n0 = n;
+
+    if (Silence_sleeping(&v->silence, marimba_excitation(v))) {
+        while (n--)
+            *out++ = 0.;
+        return;
+    }
+
+    // restrikes have to be checked every sample, otherwise run the whole block
+    if (v->multiStrike > 0) {
+        while (n--) {
+
+            if (v->multiStrike > 0) {
+                if (v->modal.wave.finished) {
+                    HeaderSnd_reset(&v->modal.wave);
+                    v->multiStrike -= 1;
+                }
+            }
+
+            *out++ = Modal4_tick(&v->modal);
+        }
     } else
-        x->multiStrike = 0;
-    Modal4_strike(&x->modal, amplitude);
+        Modal4_tickBlock(&v->modal, out, n);
+    Silence_check(&v->silence, out0, (int)n0, marimba_excitation(v));
 }
 
 static t_int *marimba_perform(t_int *w) {
@@ -94,9 +147,12 @@ static t_int *marimba_perform(t_int *w) {
 
     t_float *out = (t_float *)(w[2]);
     long n = w[3];
+    t_float buf[STK_BLOCKSIZE];
+    long i, j, m;
+    int k;
 
-    if (fr != x->fr_save) {
-        Modal4_setFreq(&x->modal, fr);
+    if (!x->poly && fr != x->fr_save) {
+        Modal4_setFreq(&x->voice[0].modal, fr);
         x->fr_save = fr;
     }
 
@@ -110,24 +166,33 @@ static t_int *marimba_perform(t_int *w) {
         x->spos_save = spos;
     }
 
-    if (sa != x->sa_save) {
-        Marimba_strike(x, sa);
+    if (!x->poly && sa != x->sa_save) {
+        Marimba_strike(x, &x->voice[0], sa);
         x->sa_save = sa;
     }
 
-    HeaderSnd_setFreq(&x->modal.vibr, vf, x->srate);
-    x->modal.vibrGain = va;
+    for (k = 0; k < x->nvoices; k++) {
+        HeaderSnd_setFreq(&x->voice[k].modal.vibr, vf, x->srate);
+        x->voice[k].modal.vibrGain = va;
+    }
 
-    while (n--) {
+    if (!x->poly) {
+        marimba_voice_perform(&x->voice[0], out, n);
+        return w + 4;
+    }
 
-        if (x->multiStrike > 0) {
-            if (x->modal.wave.finished) {
-                HeaderSnd_reset(&x->modal.wave);
-                x->multiStrike -= 1;
-            }
+    /* polyphonic: every bar still ringing, summed */
+    for (k = 0; k < n; k++)
+        out[k] = 0.;
+    for (k = 0; k < x->nvoices; k++) {
+        if (!VoicePool_active(&x->pool, k) || x->voice[k].silence.asleep)
+            continue;
+        for (i = 0; i < n; i += m) {
+            m = n - i < STK_BLOCKSIZE ? n - i : STK_BLOCKSIZE;
+            marimba_voice_perform(&x->voice[k], buf, m);
+            for (j = 0; j < m; j++)
+                out[i + j] += buf[j];
         }
-
-        *out++ = Modal4_tick(&x->modal);
     }
     return w + 4;
 }
@@ -135,15 +200,46 @@ static t_int *marimba_perform(t_int *w) {
 static void marimba_dsp(t_marimba *x, t_signal **sp) {
     x->srate = sp[0]->s_sr;
     x->one_over_srate = 1. / x->srate;
-    dsp_add(marimba_perform, 3, x, sp[1]->s_vec, sp[0]->s_n);
+    Denormals_dspAdd(marimba_perform, 3, x, sp[1]->s_vec, sp[0]->s_n);
 }
 
+static void marimba_note(t_marimba *x, t_floatarg freq, t_floatarg amp);
+
 /* ----- handle data from inlets ------ */
+/* with voices, these go through the pool at the inlets' freq and amp */
 void marimba_noteon(t_marimba *x) {
-    Modal4_noteOn(&x->modal, x->x_fr, x->x_sa);
+    if (x->poly)
+        marimba_note(x, x->x_fr, x->x_sa);
+    else
+        Modal4_noteOn(&x->voice[0].modal, x->x_fr, x->x_sa);
+}
+
+void marimba_noteoff(t_marimba *x) {
+    if (x->poly)
+        marimba_note(x, x->x_fr, 0.);
+    else
+        Modal4_noteOff(&x->voice[0].modal, x->x_sa);
 }
 
-void marimba_noteoff(t_marimba *x) { Modal4_noteOff(&x->modal, x->x_sa); }
+/* polyphonic only: strike a bar at freq, amp 0 damps it */
+static void marimba_note(t_marimba *x, t_floatarg freq, t_floatarg amp) {
+    int k;
+    if (!x->poly) {
+        pd_error(x, "marimba~: note needs a voice count argument");
+        return;
+    }
+    if (amp <= 0.) {
+        k = VoicePool_noteOff(&x->pool, freq);
+        if (k >= 0)
+            Modal4_noteOff(&x->voice[k].modal, x->x_sa);
+        return;
+    }
+    k = VoicePool_noteOn(&x->pool, freq);
+    if (k < 0)
+        return;
+    Marimba_strike(x, &x->voice[k], amp);
+    Modal4_setFreq(&x->voice[k].modal, freq);
+}
 
 static void marimba_float(t_marimba *x, t_floatarg f) { x->x_sh = f; }
 
@@ -157,13 +253,32 @@ static void marimba_va(t_marimba *x, t_floatarg f) { x->x_va = f; }
 
 static void marimba_freq(t_marimba *x, t_floatarg f) { x->x_fr = f; }
 
+static void marimba_seed(t_marimba *x, t_floatarg f) {
+    Noise_seed(&x->noise, (unsigned int)f);
+}
+
+static void marimba_sleep(t_marimba *x, t_floatarg f) {
+    int k;
+    for (k = 0; k < x->nvoices; k++)
+        Silence_setThreshold(&x->voice[k].silence, f);
+}
+
 static void marimba_free(t_marimba *x) {
-    HeaderSnd_free(&x->modal.wave);
-    HeaderSnd_free(&x->modal.vibr);
+    int k;
+    for (k = 0; k < x->nvoices; k++) {
+        HeaderSnd_free(&x->voice[k].modal.wave);
+        HeaderSnd_free(&x->voice[k].modal.vibr);
+    }
+    if (x->voice)
+        freebytes(x->voice, x->nvoices * sizeof(t_marimbavoice));
+    if (x->poly)
+        VoicePool_free(&x->pool);
 }
 
-static void *marimba_new(void) {
+static void *marimba_new(t_floatarg voices) {
     unsigned int i;
+    int k;
+    Modal4 *modal;
     char file[128];
 
     t_marimba *x = (t_marimba *)pd_new(marimba_class);
@@ -183,21 +298,40 @@ static void *marimba_new(void) {
     x->srate = sys_getsr();
     x->one_over_srate = 1. / x->srate;
 
-    Modal4_init(&x->modal, x->srate);
-    // strcpy(file, RAWWAVE_PATH);
-    HeaderSnd_alloc(&x->modal.wave, marmstk1, 256, "oneshot");
-    HeaderSnd_setRate(&x->modal.wave, .5); /*  normal stick  */
-
-    Modal4_setRatioAndReson(&x->modal, 0, 1.00, 0.9996);
-    Modal4_setRatioAndReson(&x->modal, 1, 3.99, 0.9994);
-    Modal4_setRatioAndReson(&x->modal, 2, 10.65, 0.9994);
-    Modal4_setRatioAndReson(&x->modal, 3, 2443.0, 0.999);
-    Modal4_setFiltGain(&x->modal, 0, .04);
-    Modal4_setFiltGain(&x->modal, 1, .01);
-    Modal4_setFiltGain(&x->modal, 2, .01);
-    Modal4_setFiltGain(&x->modal, 3, .008);
-    x->modal.directGain = 0.1;
-    x->multiStrike = 0;
+    // [marimba~ N] plays N bars from note messages, no argument is
+    // the single bar played from the inlets
+    x->poly = voices >= 1;
+    x->nvoices = x->poly ? (int)voices : 1;
+    x->voice = getbytes(x->nvoices * sizeof(t_marimbavoice));
+    if (!x->voice) {
+        pd_error(x, "marimba~: out of memory for %d voices", x->nvoices);
+        return (0);
+    }
+    if (x->poly && !VoicePool_alloc(&x->pool, x->nvoices)) {
+        freebytes(x->voice, x->nvoices * sizeof(t_marimbavoice));
+        return (0);
+    }
+
+    for (k = 0; k < x->nvoices; k++) {
+        modal = &x->voice[k].modal;
+        Modal4_init(modal, x->srate);
+        // strcpy(file, RAWWAVE_PATH);
+        HeaderSnd_alloc(&modal->wave, marmstk1, 256, "oneshot");
+        HeaderSnd_setRate(&modal->wave, .5); /*  normal stick  */
+
+        Modal4_setRatioAndReson(modal, 0, 1.00, 0.9996);
+        Modal4_setRatioAndReson(modal, 1, 3.99, 0.9994);
+        Modal4_setRatioAndReson(modal, 2, 10.65, 0.9994);
+        Modal4_setRatioAndReson(modal, 3, 2443.0, 0.999);
+        Modal4_setFiltGain(modal, 0, .04);
+        Modal4_setFiltGain(modal, 1, .01);
+        Modal4_setFiltGain(modal, 2, .01);
+        Modal4_setFiltGain(modal, 3, .008);
+        modal->directGain = 0.1;
+        x->voice[k].multiStrike = 0;
+        Silence_init(&x->voice[k].silence);
+    }
+    Noise_init(&x->noise, 0);
 
     x->fr_save = x->x_fr;
 
@@ -208,7 +342,8 @@ static void *marimba_new(void) {
 
 void marimba_tilde_setup(void) {
     marimba_class = class_new(gensym("marimba~"), (t_newmethod)marimba_new,
-                              (t_method)marimba_free, sizeof(t_marimba), 0, 0);
+                              (t_method)marimba_free, sizeof(t_marimba), 0,
+                              A_DEFFLOAT, 0);
     class_addmethod(marimba_class, nullfn, gensym("signal"), A_NULL);
     class_addmethod(marimba_class, (t_method)marimba_dsp, gensym("dsp"),
                     A_NULL);
@@ -223,8 +358,14 @@ void marimba_tilde_setup(void) {
                     A_NULL);
     class_addmethod(marimba_class, (t_method)marimba_freq, gensym("freq"),
                     A_FLOAT, A_NULL);
+    class_addmethod(marimba_class, (t_method)marimba_seed, gensym("seed"),
+                    A_FLOAT, A_NULL);
     class_addmethod(marimba_class, (t_method)marimba_noteon, gensym("noteon"),
                     A_NULL);
     class_addmethod(marimba_class, (t_method)marimba_noteoff, gensym("noteoff"),
                     A_NULL);
+    class_addmethod(marimba_class, (t_method)marimba_note, gensym("note"),
+                    A_FLOAT, A_FLOAT, A_NULL);
+    class_addmethod(marimba_class, (t_method)marimba_sleep, gensym("sleep"),
+                    A_FLOAT, A_NULL);
 }
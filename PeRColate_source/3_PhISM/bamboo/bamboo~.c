@@ -4,13 +4,9 @@
 #include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include "stk_c.h"
 
 #define TWO_PI 6.283185307
-#define ONE_OVER_RANDLIMIT 0.00006103516 // constant = 1. / 16384.0
-#define ATTACK 0
-#define DECAY 1
-#define SUSTAIN 2
-#define RELEASE 3
 #define MAX_RANDOM 32768
 #define MAX_SHAKE 1.0
 
@@ -48,56 +44,48 @@ typedef struct _bamboo {
     float res_spread, res_random, res_spreadConnected, res_randomConnected;
     float res_spreadSave, res_randomSave;
     float srate, one_over_srate;
+
+    Noise noise;
+    Silence silence;
 } t_bamboo;
 
 /* -------------------------------- Pure Data --------------------------------
  */
 
-int my_random(int max) {
-    // https://stackoverflow.com/a/18386648
-    return rand() / (RAND_MAX / (max + 1) + 1);
-}
-
-// noise maker
-static t_float noise_tick(void) {
-    t_float output;
-    output = (t_float)rand() - 16384.;
-    output *= ONE_OVER_RANDLIMIT;
-    return output;
-}
-
 void bamboo_setup(t_bamboo *x) {
     x->num_objects = BAMB_NUM_TUBES;
     x->num_objectsSave = BAMB_NUM_TUBES;
     x->soundDecay = BAMB_SOUND_DECAY;
     x->systemDecay = BAMB_SYSTEM_DECAY;
     x->gain = 4.0 / (float)x->num_objects;
-    x->coeffs[0] = -0.995 * 2.0 * cos(BAMB_BASE_FREQ * TWO_PI / x->srate);
+    x->coeffs[0] = -0.995 * 2.0 * Coeff_cos(BAMB_BASE_FREQ * TWO_PI / x->srate);
     x->coeffs[1] = 0.995 * 0.995;
     x->coeffs1[0] =
-        -0.995 * 2.0 * cos(BAMB_BASE_FREQ * 0.8 * TWO_PI / x->srate);
+        -0.995 * 2.0 * Coeff_cos(BAMB_BASE_FREQ * 0.8 * TWO_PI / x->srate);
     x->coeffs1[1] = 0.995 * 0.995;
     x->coeffs2[0] =
-        -0.995 * 2.0 * cos(BAMB_BASE_FREQ * 1.2 * TWO_PI / x->srate);
+        -0.995 * 2.0 * Coeff_cos(BAMB_BASE_FREQ * 1.2 * TWO_PI / x->srate);
     x->coeffs2[1] = 0.995 * 0.995;
 }
 
 static t_float bamboo_tick(t_bamboo *x) {
     float data;
     x->shakeEnergy *= x->systemDecay; // Exponential System Decay
-    if (my_random(4096) < x->num_objects) {
+    if (Noise_random(&x->noise, 4096) < x->num_objects) {
         x->sndLevel += x->gain * x->shakeEnergy;
-        x->freq_rand = x->res_freq * (1.0 + (x->res_random * noise_tick()));
-        x->coeffs[0] = -0.995 * 2.0 * cos(x->freq_rand * TWO_PI / x->srate);
         x->freq_rand =
-            x->res_freq * (1. - x->res_spread + (x->res_random * noise_tick()));
-        x->coeffs1[0] = -0.995 * 2.0 * cos(x->freq_rand * TWO_PI / x->srate);
-        x->freq_rand = x->res_freq * (1. + 2. * x->res_spread +
-                                      (2. * x->res_random * noise_tick()));
-        x->coeffs2[0] = -0.995 * 2.0 * cos(x->freq_rand * TWO_PI / x->srate);
+            x->res_freq * (1.0 + (x->res_random * Noise_tick(&x->noise)));
+        x->coeffs[0] = -0.995 * 2.0 * Coeff_cos(x->freq_rand * TWO_PI / x->srate);
+        x->freq_rand = x->res_freq * (1. - x->res_spread +
+                                      (x->res_random * Noise_tick(&x->noise)));
+        x->coeffs1[0] = -0.995 * 2.0 * Coeff_cos(x->freq_rand * TWO_PI / x->srate);
+        x->freq_rand =
+            x->res_freq * (1. + 2. * x->res_spread +
+                           (2. * x->res_random * Noise_tick(&x->noise)));
+        x->coeffs2[0] = -0.995 * 2.0 * Coeff_cos(x->freq_rand * TWO_PI / x->srate);
     }
     x->input = x->sndLevel;
-    x->input *= noise_tick(); // Actual Sound is Random
+    x->input *= Noise_tick(&x->noise); // Actual Sound is Random
     x->input1 = x->input;
     x->input2 = x->input;
 
@@ -172,10 +160,17 @@ static t_int *bamboo_perform(t_int *w) {
         x->res_randomSave = x->res_random = res_random;
     }
 
+    if (Silence_sleeping(&x->silence, x->shakeEnergy)) {
+        while (n--)
+            *out++ = 0.;
+        return w + 4;
+    }
+
     while (n--) {
         lastOutput = bamboo_tick(x);
         *out++ = lastOutput;
     }
+    Silence_check(&x->silence, (t_float *)(w[2]), (int)w[3], x->shakeEnergy);
     return w + 4;
 }
 
@@ -183,7 +178,7 @@ static void bamboo_dsp(t_bamboo *x, t_signal **sp) {
     x->srate = sp[0]->s_sr;
     x->one_over_srate = 1. / x->srate;
 
-    dsp_add(bamboo_perform, 3, x, sp[1]->s_vec, sp[0]->s_n);
+    Denormals_dspAdd(bamboo_perform, 3, x, sp[1]->s_vec, sp[0]->s_n);
 }
 
 static void bamboo_float(t_bamboo *x, t_floatarg f) { x->num_objects = f; }
@@ -265,11 +260,20 @@ static void *bamboo_new(void) {
 
     bamboo_setup(x);
 
-    srand(0.54);
+    Noise_init(&x->noise, 0);
+    Silence_init(&x->silence);
 
     return (x);
 }
 
+static void bamboo_seed(t_bamboo *x, t_floatarg f) {
+    Noise_seed(&x->noise, (unsigned int)f);
+}
+
+static void bamboo_sleep(t_bamboo *x, t_floatarg f) {
+    Silence_setThreshold(&x->silence, f);
+}
+
 void bamboo_tilde_setup(void) {
     bamboo_class = class_new(gensym("bamboo~"), (t_newmethod)bamboo_new, 0,
                              sizeof(t_bamboo), 0, 0);
@@ -277,6 +281,10 @@ void bamboo_tilde_setup(void) {
     class_addmethod(bamboo_class, (t_method)bamboo_dsp, gensym("dsp"), A_NULL);
     class_addfloat(bamboo_class, (t_method)bamboo_float);
     class_addbang(bamboo_class, (t_method)bamboo_bang);
+    class_addmethod(bamboo_class, (t_method)bamboo_seed, gensym("seed"), A_FLOAT,
+                    A_NULL);
+    class_addmethod(bamboo_class, (t_method)bamboo_sleep, gensym("sleep"), A_FLOAT,
+                    A_NULL);
     class_addmethod(bamboo_class, (t_method)bamboo_res_freq, gensym("res_freq"),
                     A_FLOAT, A_NULL);
     class_addmethod(bamboo_class, (t_method)bamboo_shake_damp,
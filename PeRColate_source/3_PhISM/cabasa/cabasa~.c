@@ -2,13 +2,9 @@
 #include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include "stk_c.h"
 
 #define TWO_PI 6.283185307
-#define ONE_OVER_RANDLIMIT 0.00006103516 // constant = 1. / 16384.0
-#define ATTACK 0
-#define DECAY 1
-#define SUSTAIN 2
-#define RELEASE 3
 #define MAX_RANDOM 32768
 #define MAX_SHAKE 1.0
 
@@ -57,31 +53,18 @@ typedef struct _cabasa {
     short shake_maxConnected;
 
     float srate, one_over_srate;
+
+    Noise noise;
+    Silence silence;
 } t_cabasa;
 
 /****FUNCTIONS****/
 
-static int my_random(int max) { //  Return Random Int Between 0 and max
-    unsigned long temp;
-    temp = (unsigned long)rand();
-    temp *= (unsigned long)max;
-    temp >>= 15;
-    return (int)temp;
-}
-
-// noise maker
-static float noise_tick(void) {
-    float output;
-    output = (float)rand() - 16384.;
-    output *= ONE_OVER_RANDLIMIT;
-    return output;
-}
-
 static void cabasa_setup(t_cabasa *x) {
 
     x->num_objects = x->num_objectsSave = CABA_NUM_BEADS;
     x->gain = log(x->num_objects) / log(4.0) * 120.0 / (float)x->num_objects;
-    x->coeffs[0] = -0.7 * 2.0 * cos(3000.0 * TWO_PI / x->srate);
+    x->coeffs[0] = -0.7 * 2.0 * Coeff_cos(3000.0 * TWO_PI / x->srate);
     x->coeffs[1] = 0.7 * 0.7;
     x->soundDecay = CABA_SOUND_DECAY;
     x->systemDecay = CABA_SYSTEM_DECAY;
@@ -92,15 +75,15 @@ static void cabasa_setup(t_cabasa *x) {
 
 static float cabasa_tick(t_cabasa *x) {
     float data;
-    x->shakeEnergy *= x->systemDecay;            // Exponential system decay
-    if (my_random(1024) < x->num_objects)        // If collision
-        x->sndLevel += x->gain * x->shakeEnergy; //   add energy
-    x->input = x->sndLevel * noise_tick();       // Actual Sound is Random
-    x->sndLevel *= x->soundDecay;                // Exponential Sound decay
-    x->input -= x->output[0] * x->coeffs[0];     // Do gourd
-    x->input -= x->output[1] * x->coeffs[1];     //   resonance
-    x->output[1] = x->output[0];                 //     filter
-    x->output[0] = x->input;                     //       calculations
+    x->shakeEnergy *= x->systemDecay;                   // Exponential system decay
+    if (Noise_random(&x->noise, 1024) < x->num_objects) // If collision
+        x->sndLevel += x->gain * x->shakeEnergy;        //   add energy
+    x->input = x->sndLevel * Noise_tick(&x->noise);     // Actual Sound is Random
+    x->sndLevel *= x->soundDecay;                       // Exponential Sound decay
+    x->input -= x->output[0] * x->coeffs[0];            // Do gourd
+    x->input -= x->output[1] * x->coeffs[1];            //   resonance
+    x->output[1] = x->output[0];                        //     filter
+    x->output[0] = x->input;                            //       calculations
     data = x->output[0] - x->output[1];
 
     return data;
@@ -131,7 +114,7 @@ static t_int *cabasa_perform(t_int *w) {
 
     if (res_freq != x->res_freqSave) {
         x->res_freqSave = x->res_freq = res_freq;
-        x->coeffs[0] = -0.7 * 2.0 * cos(res_freq * TWO_PI / x->srate);
+        x->coeffs[0] = -0.7 * 2.0 * Coeff_cos(res_freq * TWO_PI / x->srate);
     }
 
     if (shake_damp != x->shake_dampSave) {
@@ -146,17 +129,24 @@ static t_int *cabasa_perform(t_int *w) {
             x->shakeEnergy = MAX_SHAKE;
     }
 
+    if (Silence_sleeping(&x->silence, x->shakeEnergy)) {
+        while (n--)
+            *out++ = 0.;
+        return w + 4;
+    }
+
     while (n--) {
         lastOutput = cabasa_tick(x);
         *out++ = lastOutput;
     }
+    Silence_check(&x->silence, (t_float *)(w[2]), (int)w[3], x->shakeEnergy);
     return w + 4;
 }
 
 static void cabasa_dsp(t_cabasa *x, t_signal **sp) {
     x->srate = sp[0]->s_sr;
     x->one_over_srate = 1. / x->srate;
-    dsp_add(cabasa_perform, 3, x, sp[1]->s_vec, sp[0]->s_n);
+    Denormals_dspAdd(cabasa_perform, 3, x, sp[1]->s_vec, sp[0]->s_n);
 }
 
 static void cabasa_float(t_cabasa *x, t_floatarg f) { x->num_objects = f; }
@@ -208,11 +198,20 @@ void *cabasa_new(double initial_coeff) {
 
     cabasa_setup(x);
 
-    srand(54);
+    Noise_init(&x->noise, 0);
+    Silence_init(&x->silence);
 
     return (x);
 }
 
+static void cabasa_seed(t_cabasa *x, t_floatarg f) {
+    Noise_seed(&x->noise, (unsigned int)f);
+}
+
+static void cabasa_sleep(t_cabasa *x, t_floatarg f) {
+    Silence_setThreshold(&x->silence, f);
+}
+
 void cabasa_tilde_setup(void) {
     cabasa_class = class_new(gensym("cabasa~"), (t_newmethod)cabasa_new, 0,
                              sizeof(t_cabasa), 0, 0);
@@ -220,6 +219,10 @@ void cabasa_tilde_setup(void) {
     class_addmethod(cabasa_class, (t_method)cabasa_dsp, gensym("dsp"), A_NULL);
     class_addfloat(cabasa_class, (t_method)cabasa_float);
     class_addbang(cabasa_class, (t_method)cabasa_bang);
+    class_addmethod(cabasa_class, (t_method)cabasa_seed, gensym("seed"), A_FLOAT,
+                    A_NULL);
+    class_addmethod(cabasa_class, (t_method)cabasa_sleep, gensym("sleep"), A_FLOAT,
+                    A_NULL);
     class_addmethod(cabasa_class, (t_method)cabasa_res_freq, gensym("res_freq"),
                     A_FLOAT, A_NULL);
     class_addmethod(cabasa_class, (t_method)cabasa_shake_damp,
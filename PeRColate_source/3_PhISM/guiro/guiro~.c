@@ -2,13 +2,9 @@
 #include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include "stk_c.h"
 
 #define TWO_PI 6.283185307
-#define ONE_OVER_RANDLIMIT 0.00006103516 // constant = 1. / 16384.0
-#define ATTACK 0
-#define DECAY 1
-#define SUSTAIN 2
-#define RELEASE 3
 #define MAX_RANDOM 32768
 #define MAX_SHAKE 1.0
 
@@ -54,34 +50,22 @@ typedef struct _guiro {
     float finalZ[3];
 
     float srate, one_over_srate;
+
+    Noise noise;
+    Silence silence;
 } t_guiro;
 
 /****FUNCTIONS****/
-int my_random(int max) { //  Return Random Int Between 0 and max
-    unsigned long temp;
-    temp = (unsigned long)rand();
-    temp *= (unsigned long)max;
-    temp >>= 15;
-    return (int)temp;
-}
-
-// noise maker
-float noise_tick(void) {
-    float output;
-    output = (float)rand() - 16384.;
-    output *= ONE_OVER_RANDLIMIT;
-    return output;
-}
 
 void guiro_setup(t_guiro *x) {
 
     x->num_objects = x->num_objectsSave = GUIR_NUM_RATCHETS;
     x->soundDecay = GUIR_SOUND_DECAY;
     x->coeffs[0] =
-        -GUIR_GOURD_RESON * 2.0 * cos(GUIR_GOURD_FREQ * TWO_PI / x->srate);
+        -GUIR_GOURD_RESON * 2.0 * Coeff_cos(GUIR_GOURD_FREQ * TWO_PI / x->srate);
     x->coeffs[1] = GUIR_GOURD_RESON * GUIR_GOURD_RESON;
     x->coeffs2[0] =
-        -GUIR_GOURD_RESON2 * 2.0 * cos(GUIR_GOURD_FREQ2 * TWO_PI / x->srate);
+        -GUIR_GOURD_RESON2 * 2.0 * Coeff_cos(GUIR_GOURD_FREQ2 * TWO_PI / x->srate);
     x->coeffs2[1] = GUIR_GOURD_RESON2 * GUIR_GOURD_RESON2;
     x->ratchet = x->ratchetDelta = 0.;
     x->guiroScrape = 0.;
@@ -89,11 +73,11 @@ void guiro_setup(t_guiro *x) {
 
 float guiro_tick(t_guiro *x) {
     float data;
-    if (my_random(1024) < x->num_objects) {
+    if (Noise_random(&x->noise, 1024) < x->num_objects) {
         x->sndLevel += 512. * x->ratchet * x->totalEnergy;
     }
     x->input = x->sndLevel;
-    x->input *= noise_tick() * x->ratchet;
+    x->input *= Noise_tick(&x->noise) * x->ratchet;
     x->sndLevel *= x->soundDecay;
 
     x->input2 = x->input;
@@ -141,7 +125,7 @@ static t_int *guiro_perform(t_int *w) {
     if (res_freq != x->res_freqSave) {
         x->res_freqSave = x->res_freq = res_freq;
         x->coeffs[0] =
-            -GUIR_GOURD_RESON * 2.0 * cos(res_freq * TWO_PI / x->srate);
+            -GUIR_GOURD_RESON * 2.0 * Coeff_cos(res_freq * TWO_PI / x->srate);
     }
 
     if (shake_damp != x->shake_dampSave) {
@@ -161,7 +145,13 @@ static t_int *guiro_perform(t_int *w) {
     if (res_freq2 != x->res_freq2Save) {
         x->res_freq2Save = x->res_freq2 = res_freq2;
         x->coeffs2[0] =
-            -GUIR_GOURD_RESON2 * 2.0 * cos(res_freq2 * TWO_PI / x->srate);
+            -GUIR_GOURD_RESON2 * 2.0 * Coeff_cos(res_freq2 * TWO_PI / x->srate);
+    }
+
+    if (Silence_sleeping(&x->silence, x->guiroScrape < 1.0 ? 1. : 0.)) {
+        while (n--)
+            *out++ = 0.;
+        return w + 4;
     }
 
     while (n--) {
@@ -176,11 +166,13 @@ static t_int *guiro_perform(t_int *w) {
             lastOutput = 0.0;
         *out++ = lastOutput;
     }
+    Silence_check(&x->silence, (t_float *)(w[2]), (int)w[3],
+                  x->guiroScrape < 1.0 ? 1. : 0.);
     return w + 4;
 }
 
 static void guiro_dsp(t_guiro *x, t_signal **sp) {
-    dsp_add(guiro_perform, 3, x, sp[1]->s_vec, sp[0]->s_n);
+    Denormals_dspAdd(guiro_perform, 3, x, sp[1]->s_vec, sp[0]->s_n);
 }
 
 static void guiro_float(t_guiro *x, t_floatarg f) { x->num_objects = f; }
@@ -242,11 +234,20 @@ static void *guiro_new(void) {
 
     guiro_setup(x);
 
-    srand(54);
+    Noise_init(&x->noise, 0);
+    Silence_init(&x->silence);
 
     return (x);
 }
 
+static void guiro_seed(t_guiro *x, t_floatarg f) {
+    Noise_seed(&x->noise, (unsigned int)f);
+}
+
+static void guiro_sleep(t_guiro *x, t_floatarg f) {
+    Silence_setThreshold(&x->silence, f);
+}
+
 void guiro_tilde_setup(void) {
     guiro_class = class_new(gensym("guiro~"), (t_newmethod)guiro_new, 0,
                             sizeof(t_guiro), 0, 0);
@@ -254,6 +255,10 @@ void guiro_tilde_setup(void) {
     class_addmethod(guiro_class, (t_method)guiro_dsp, gensym("dsp"), A_NULL);
     class_addfloat(guiro_class, (t_method)guiro_float);
     class_addbang(guiro_class, (t_method)guiro_bang);
+    class_addmethod(guiro_class, (t_method)guiro_seed, gensym("seed"), A_FLOAT,
+                    A_NULL);
+    class_addmethod(guiro_class, (t_method)guiro_sleep, gensym("sleep"), A_FLOAT,
+                    A_NULL);
     class_addmethod(guiro_class, (t_method)guiro_res_freq, gensym("res_freq"),
                     A_FLOAT, A_NULL);
     class_addmethod(guiro_class, (t_method)guiro_shake_damp,
@@ -4,12 +4,8 @@
 #include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include "stk_c.h"
 #define TWO_PI 6.283185307
-#define ONE_OVER_RANDLIMIT 0.00006103516 // constant = 1. / 16384.0
-#define ATTACK 0
-#define DECAY 1
-#define SUSTAIN 2
-#define RELEASE 3
 #define MAX_RANDOM 32768
 #define MAX_SHAKE 1.0
 
@@ -122,14 +118,13 @@ typedef struct _metashake {
 
     t_float srate, one_over_srate;
     t_int power;
+
+    Noise noise;
+    Silence silence;
 } t_metashake;
 
 /****PROTOTYPES****/
 
-// noise maker
-static t_float noise_tick(void);
-static t_int my_random(t_int max);
-
 static void metashake_clear_dlines(t_metashake *x);
 
 /****FUNCTIONS****/
@@ -137,7 +132,7 @@ static void maraca_setup(t_metashake *x) {
     x->num_objects = MARA_NUM_BEANS;
     x->num_objectsSave = x->num_objects;
     x->gain = log(x->num_objects) / log(4.0) * 40. / (t_float)x->num_objects;
-    x->coeffs[0] = -0.96 * 2.0 * cos(3200.0 * TWO_PI / x->srate);
+    x->coeffs[0] = -0.96 * 2.0 * Coeff_cos(3200.0 * TWO_PI / x->srate);
     x->coeffs[1] = 0.96 * 0.96;
     x->soundDecay = MARA_SOUND_DECAY;
     x->systemDecay = MARA_SYSTEM_DECAY;
@@ -145,15 +140,15 @@ static void maraca_setup(t_metashake *x) {
 
 static t_float maraca_tick(t_metashake *x) {
     t_float data;
-    x->shakeEnergy *= x->systemDecay;            // Exponential system decay
-    if (my_random(1024) < x->num_objects)        // If collision
-        x->sndLevel += x->gain * x->shakeEnergy; //   add energy
-    x->input = x->sndLevel * noise_tick();       // Actual Sound is Random
-    x->sndLevel *= x->soundDecay;                // Exponential Sound decay
-    x->input -= x->output[0] * x->coeffs[0];     // Do gourd
-    x->input -= x->output[1] * x->coeffs[1];     //   resonance
-    x->output[1] = x->output[0];                 //     filter
-    x->output[0] = x->input;                     //       calculations
+    x->shakeEnergy *= x->systemDecay;                   // Exponential system decay
+    if (Noise_random(&x->noise, 1024) < x->num_objects) // If collision
+        x->sndLevel += x->gain * x->shakeEnergy;        //   add energy
+    x->input = x->sndLevel * Noise_tick(&x->noise);     // Actual Sound is Random
+    x->sndLevel *= x->soundDecay;                       // Exponential Sound decay
+    x->input -= x->output[0] * x->coeffs[0];            // Do gourd
+    x->input -= x->output[1] * x->coeffs[1];            //   resonance
+    x->output[1] = x->output[0];                        //     filter
+    x->output[0] = x->input;                            //       calculations
     data = x->output[0] - x->output[1];
 
     return 40. * data;
@@ -163,7 +158,7 @@ static void cabasa_setup(t_metashake *x) {
     x->num_objects = CABA_NUM_BEADS;
     x->num_objectsSave = x->num_objects;
     x->gain = log(x->num_objects) / log(4.0) * 120.0 / (t_float)x->num_objects;
-    x->coeffs[0] = -0.7 * 2.0 * cos(3000.0 * TWO_PI / x->srate);
+    x->coeffs[0] = -0.7 * 2.0 * Coeff_cos(3000.0 * TWO_PI / x->srate);
     x->coeffs[1] = 0.7 * 0.7;
     x->soundDecay = CABA_SOUND_DECAY;
     x->systemDecay = CABA_SYSTEM_DECAY;
@@ -171,15 +166,15 @@ static void cabasa_setup(t_metashake *x) {
 
 static t_float cabasa_tick(t_metashake *x) {
     t_float data;
-    x->shakeEnergy *= x->systemDecay;            // Exponential system decay
-    if (my_random(1024) < x->num_objects)        // If collision
-        x->sndLevel += x->gain * x->shakeEnergy; //   add energy
-    x->input = x->sndLevel * noise_tick();       // Actual Sound is Random
-    x->sndLevel *= x->soundDecay;                // Exponential Sound decay
-    x->input -= x->output[0] * x->coeffs[0];     // Do gourd
-    x->input -= x->output[1] * x->coeffs[1];     //   resonance
-    x->output[1] = x->output[0];                 //     filter
-    x->output[0] = x->input;                     //       calculations
+    x->shakeEnergy *= x->systemDecay;                   // Exponential system decay
+    if (Noise_random(&x->noise, 1024) < x->num_objects) // If collision
+        x->sndLevel += x->gain * x->shakeEnergy;        //   add energy
+    x->input = x->sndLevel * Noise_tick(&x->noise);     // Actual Sound is Random
+    x->sndLevel *= x->soundDecay;                       // Exponential Sound decay
+    x->input -= x->output[0] * x->coeffs[0];            // Do gourd
+    x->input -= x->output[1] * x->coeffs[1];            //   resonance
+    x->output[1] = x->output[0];                        //     filter
+    x->output[0] = x->input;                            //       calculations
     data = x->output[0] - x->output[1];
 
     return 10. * data;
@@ -189,7 +184,7 @@ static void sekere_setup(t_metashake *x) {
     x->num_objects = SEKE_NUM_BEANS;
     x->num_objectsSave = x->num_objects;
     x->gain = log(x->num_objects) / log(4.0) * 40.0 / (t_float)x->num_objects;
-    x->coeffs[0] = -0.6 * 2.0 * cos(5500.0 * TWO_PI / x->srate);
+    x->coeffs[0] = -0.6 * 2.0 * Coeff_cos(5500.0 * TWO_PI / x->srate);
     x->coeffs[1] = 0.6 * 0.6;
     x->soundDecay = SEKE_SOUND_DECAY;
     x->systemDecay = SEKE_SYSTEM_DECAY;
@@ -197,15 +192,15 @@ static void sekere_setup(t_metashake *x) {
 
 static t_float sekere_tick(t_metashake *x) {
     t_float data;
-    x->shakeEnergy *= x->systemDecay;            // Exponential system decay
-    if (my_random(1024) < x->num_objects)        // If collision
-        x->sndLevel += x->gain * x->shakeEnergy; //   add energy
-    x->input = x->sndLevel * noise_tick();       // Actual Sound is Random
-    x->sndLevel *= x->soundDecay;                // Exponential Sound decay
-    x->input -= x->output[0] * x->coeffs[0];     // Do gourd
-    x->input -= x->output[1] * x->coeffs[1];     //   resonance
-    x->output[1] = x->output[0];                 //     filter
-    x->output[0] = x->input;                     //       calculations
+    x->shakeEnergy *= x->systemDecay;                   // Exponential system decay
+    if (Noise_random(&x->noise, 1024) < x->num_objects) // If collision
+        x->sndLevel += x->gain * x->shakeEnergy;        //   add energy
+    x->input = x->sndLevel * Noise_tick(&x->noise);     // Actual Sound is Random
+    x->sndLevel *= x->soundDecay;                       // Exponential Sound decay
+    x->input -= x->output[0] * x->coeffs[0];            // Do gourd
+    x->input -= x->output[1] * x->coeffs[1];            //   resonance
+    x->output[1] = x->output[0];                        //     filter
+    x->output[0] = x->input;                            //       calculations
     x->finalZ[2] = x->finalZ[1];
     x->finalZ[1] = x->finalZ[0];
     x->finalZ[0] = x->output[1];
@@ -220,30 +215,32 @@ static void tamb_setup(t_metashake *x) {
     x->soundDecay = TAMB_SOUND_DECAY;
     x->systemDecay = TAMB_SYSTEM_DECAY;
     x->gain = 24.0 / x->num_objects;
-    x->coeffs[0] = -0.96 * 2.0 * cos(TAMB_SHELL_FREQ * TWO_PI / x->srate);
+    x->coeffs[0] = -0.96 * 2.0 * Coeff_cos(TAMB_SHELL_FREQ * TWO_PI / x->srate);
     x->coeffs[1] = 0.96 * 0.96;
     x->coeffs1[0] =
-        -TAMB_CYMB_RESON * 2.0 * cos(TAMB_CYMB_FREQ * TWO_PI / x->srate);
+        -TAMB_CYMB_RESON * 2.0 * Coeff_cos(TAMB_CYMB_FREQ * TWO_PI / x->srate);
     x->coeffs1[1] = TAMB_CYMB_RESON * TAMB_CYMB_RESON;
     x->coeffs2[0] =
-        -TAMB_CYMB_RESON * 2.0 * cos(TAMB_CYMB_FREQ2 * TWO_PI / x->srate);
+        -TAMB_CYMB_RESON * 2.0 * Coeff_cos(TAMB_CYMB_FREQ2 * TWO_PI / x->srate);
     x->coeffs2[1] = TAMB_CYMB_RESON * TAMB_CYMB_RESON;
 }
 
 static t_float tamb_tick(t_metashake *x) {
     t_float data;
     x->shakeEnergy *= x->systemDecay; // Exponential System Decay
-    if (my_random(1024) < x->num_objects) {
+    if (Noise_random(&x->noise, 1024) < x->num_objects) {
         x->sndLevel += x->gain * x->shakeEnergy;
-        x->cymb_rand = noise_tick() * x->res_freq1 * x->res_random; // * 0.05;
+        x->cymb_rand =
+            Noise_tick(&x->noise) * x->res_freq1 * x->res_random; // * 0.05;
         x->coeffs1[0] = -TAMB_CYMB_RESON * 2.0 *
-                        cos((x->res_freq1 + x->cymb_rand) * TWO_PI / x->srate);
-        x->cymb_rand = noise_tick() * x->res_freq2 * x->res_random; //* 0.05;
+                        Coeff_cos((x->res_freq1 + x->cymb_rand) * TWO_PI / x->srate);
+        x->cymb_rand =
+            Noise_tick(&x->noise) * x->res_freq2 * x->res_random; //* 0.05;
         x->coeffs2[0] = -TAMB_CYMB_RESON * 2.0 *
-                        cos((x->res_freq2 + x->cymb_rand) * TWO_PI / x->srate);
+                        Coeff_cos((x->res_freq2 + x->cymb_rand) * TWO_PI / x->srate);
     }
     x->input = x->sndLevel;
-    x->input *= noise_tick(); // Actual Sound is Random
+    x->input *= Noise_tick(&x->noise); // Actual Sound is Random
     x->input1 = x->input * 0.8;
     x->input2 = x->input;
     x->input *= TAMB_SHELL_GAIN;
@@ -279,10 +276,10 @@ static void guiro_setup(t_metashake *x) {
     x->num_objectsSave = x->num_objects;
     x->soundDecay = GUIR_SOUND_DECAY;
     x->coeffs[0] =
-        -GUIR_GOURD_RESON * 2.0 * cos(GUIR_GOURD_FREQ * TWO_PI / x->srate);
+        -GUIR_GOURD_RESON * 2.0 * Coeff_cos(GUIR_GOURD_FREQ * TWO_PI / x->srate);
     x->coeffs[1] = GUIR_GOURD_RESON * GUIR_GOURD_RESON;
     x->coeffs1[0] =
-        -GUIR_GOURD_RESON2 * 2.0 * cos(GUIR_GOURD_FREQ2 * TWO_PI / x->srate);
+        -GUIR_GOURD_RESON2 * 2.0 * Coeff_cos(GUIR_GOURD_FREQ2 * TWO_PI / x->srate);
     x->coeffs1[1] = GUIR_GOURD_RESON2 * GUIR_GOURD_RESON2;
     x->ratchet = 0.;
     x->guiroScrape = 0.;
@@ -290,11 +287,11 @@ static void guiro_setup(t_metashake *x) {
 
 static t_float guiro_tick(t_metashake *x) {
     t_float data;
-    if (my_random(1024) < x->num_objects) {
+    if (Noise_random(&x->noise, 1024) < x->num_objects) {
         x->sndLevel += 512. * x->ratchet * x->totalEnergy;
     }
     x->input = x->sndLevel;
-    x->input *= noise_tick() * x->ratchet;
+    x->input *= Noise_tick(&x->noise) * x->ratchet;
     x->sndLevel *= x->soundDecay;
 
     x->input2 = x->input;
@@ -321,32 +318,34 @@ static void bamboo_setup(t_metashake *x) {
     x->soundDecay = BAMB_SOUND_DECAY;
     x->systemDecay = BAMB_SYSTEM_DECAY;
     x->gain = 4.0 / (t_float)x->num_objects;
-    x->coeffs[0] = -0.995 * 2.0 * cos(BAMB_BASE_FREQ * TWO_PI / x->srate);
+    x->coeffs[0] = -0.995 * 2.0 * Coeff_cos(BAMB_BASE_FREQ * TWO_PI / x->srate);
     x->coeffs[1] = 0.995 * 0.995;
     x->coeffs1[0] =
-        -0.995 * 2.0 * cos(BAMB_BASE_FREQ * 0.8 * TWO_PI / x->srate);
+        -0.995 * 2.0 * Coeff_cos(BAMB_BASE_FREQ * 0.8 * TWO_PI / x->srate);
     x->coeffs1[1] = 0.995 * 0.995;
     x->coeffs2[0] =
-        -0.995 * 2.0 * cos(BAMB_BASE_FREQ * 1.2 * TWO_PI / x->srate);
+        -0.995 * 2.0 * Coeff_cos(BAMB_BASE_FREQ * 1.2 * TWO_PI / x->srate);
     x->coeffs2[1] = 0.995 * 0.995;
 }
 
 static t_float bamboo_tick(t_metashake *x) {
     t_float data;
     x->shakeEnergy *= x->systemDecay; // Exponential System Decay
-    if (my_random(4096) < x->num_objects) {
+    if (Noise_random(&x->noise, 4096) < x->num_objects) {
         x->sndLevel += x->gain * x->shakeEnergy;
-        x->freq_rand = x->res_freq * (1.0 + (x->res_random * noise_tick()));
-        x->coeffs[0] = -0.995 * 2.0 * cos(x->freq_rand * TWO_PI / x->srate);
         x->freq_rand =
-            x->res_freq * (1. - x->res_spread + (x->res_random * noise_tick()));
-        x->coeffs1[0] = -0.995 * 2.0 * cos(x->freq_rand * TWO_PI / x->srate);
-        x->freq_rand = x->res_freq * (1. + 2. * x->res_spread +
-                                      (2. * x->res_random * noise_tick()));
-        x->coeffs2[0] = -0.995 * 2.0 * cos(x->freq_rand * TWO_PI / x->srate);
+            x->res_freq * (1.0 + (x->res_random * Noise_tick(&x->noise)));
+        x->coeffs[0] = -0.995 * 2.0 * Coeff_cos(x->freq_rand * TWO_PI / x->srate);
+        x->freq_rand = x->res_freq * (1. - x->res_spread +
+                                      (x->res_random * Noise_tick(&x->noise)));
+        x->coeffs1[0] = -0.995 * 2.0 * Coeff_cos(x->freq_rand * TWO_PI / x->srate);
+        x->freq_rand =
+            x->res_freq * (1. + 2. * x->res_spread +
+                           (2. * x->res_random * Noise_tick(&x->noise)));
+        x->coeffs2[0] = -0.995 * 2.0 * Coeff_cos(x->freq_rand * TWO_PI / x->srate);
     }
     x->input = x->sndLevel;
-    x->input *= noise_tick(); // Actual Sound is Random
+    x->input *= Noise_tick(&x->noise); // Actual Sound is Random
     x->input1 = x->input;
     x->input2 = x->input;
 
@@ -394,31 +393,31 @@ static void sleigh_setup(t_metashake *x) {
 static t_float sleigh_tick(t_metashake *x) {
     t_float data;
     x->shakeEnergy *= x->systemDecay; // Exponential System Decay
-    if (my_random(1024) < x->num_objects) {
+    if (Noise_random(&x->noise, 1024) < x->num_objects) {
         x->sndLevel += x->gain * x->shakeEnergy;
-        x->cymb_rand = noise_tick() * x->res_freq * 0.05;
+        x->cymb_rand = Noise_tick(&x->noise) * x->res_freq * 0.05;
         x->coeffs[0] =
             -SLEI_CYMB_RESON * 2.0 *
-            cos((x->res_freq + x->cymb_rand) * TWO_PI * x->one_over_srate);
-        x->cymb_rand = noise_tick() * x->res_freq1 * 0.03;
+            Coeff_cos((x->res_freq + x->cymb_rand) * TWO_PI * x->one_over_srate);
+        x->cymb_rand = Noise_tick(&x->noise) * x->res_freq1 * 0.03;
         x->coeffs1[0] =
             -SLEI_CYMB_RESON * 2.0 *
-            cos((x->res_freq1 + x->cymb_rand) * TWO_PI * x->one_over_srate);
-        x->cymb_rand = noise_tick() * x->res_freq2 * 0.03;
+            Coeff_cos((x->res_freq1 + x->cymb_rand) * TWO_PI * x->one_over_srate);
+        x->cymb_rand = Noise_tick(&x->noise) * x->res_freq2 * 0.03;
         x->coeffs2[0] =
             -SLEI_CYMB_RESON * 2.0 *
-            cos((x->res_freq2 + x->cymb_rand) * TWO_PI * x->one_over_srate);
-        x->cymb_rand = noise_tick() * x->res_freq3 * 0.03;
+            Coeff_cos((x->res_freq2 + x->cymb_rand) * TWO_PI * x->one_over_srate);
+        x->cymb_rand = Noise_tick(&x->noise) * x->res_freq3 * 0.03;
         x->coeffs3[0] =
             -SLEI_CYMB_RESON * 2.0 *
-            cos((x->res_freq3 + x->cymb_rand) * TWO_PI * x->one_over_srate);
-        x->cymb_rand = noise_tick() * x->res_freq4 * 0.03;
+            Coeff_cos((x->res_freq3 + x->cymb_rand) * TWO_PI * x->one_over_srate);
+        x->cymb_rand = Noise_tick(&x->noise) * x->res_freq4 * 0.03;
         x->coeffs4[0] =
             -SLEI_CYMB_RESON * 2.0 *
-            cos((x->res_freq4 + x->cymb_rand) * TWO_PI * x->one_over_srate);
+            Coeff_cos((x->res_freq4 + x->cymb_rand) * TWO_PI * x->one_over_srate);
     }
     x->input = x->sndLevel;
-    x->input *= noise_tick(); // Actual Sound is Random
+    x->input *= Noise_tick(&x->noise); // Actual Sound is Random
     x->input1 = x->input;
     x->input2 = x->input;
     x->input3 = x->input * 0.5;
@@ -464,20 +463,20 @@ static t_float sleigh_tick(t_metashake *x) {
     return 5. * data;
 }
 
-static t_int my_random(t_int max) { //  Return Random Int Between 0 and max
-    unsigned long temp;
-    temp = (unsigned long)rand();
-    temp *= (unsigned long)max;
-    temp >>= 15;
-    return (t_int)temp;
+/* what still drives the current shaker, for the silence check */
+static t_float metashake_excitation(t_metashake *x) {
+    if (x->shakertype == GUIRO)
+        return x->guiroScrape < 1.0 ? 1. : 0.;
+    return x->shakeEnergy;
 }
 
-// noise maker
-static t_float noise_tick(void) {
-    t_float output;
-    output = (t_float)rand() - 16384.;
-    output *= ONE_OVER_RANDLIMIT;
-    return output;
+/* zero-fills and returns 1 while the shaker sleeps */
+static int metashake_sleeping(t_metashake *x, t_float *out, t_int n) {
+    if (!Silence_sleeping(&x->silence, metashake_excitation(x)))
+        return 0;
+    while (n--)
+        *out++ = 0.;
+    return 1;
 }
 
 static t_int *metashake_perform(t_int *w) {
@@ -520,7 +519,7 @@ static t_int *metashake_perform(t_int *w) {
         if (res_freq != x->res_freqSave) {
             // res_freq *= FREQ_SCALE;
             x->res_freqSave = x->res_freq = res_freq;
-            x->coeffs[0] = -0.96 * 2.0 * cos(res_freq * TWO_PI / x->srate);
+            x->coeffs[0] = -0.96 * 2.0 * Coeff_cos(res_freq * TWO_PI / x->srate);
         }
 
         if (shake_damp != x->shake_dampSave) {
@@ -535,6 +534,8 @@ static t_int *metashake_perform(t_int *w) {
                 x->shakeEnergy = MAX_SHAKE;
         }
 
+        if (metashake_sleeping(x, out, n))
+            return w + 4;
         while (n--) {
             lastOutput = maraca_tick(x);
             *out++ = lastOutput;
@@ -554,7 +555,7 @@ static t_int *metashake_perform(t_int *w) {
         if (res_freq != x->res_freqSave) {
             // res_freq *= FREQ_SCALE;
             x->res_freqSave = x->res_freq = res_freq;
-            x->coeffs[0] = -0.7 * 2.0 * cos(res_freq * TWO_PI / x->srate);
+            x->coeffs[0] = -0.7 * 2.0 * Coeff_cos(res_freq * TWO_PI / x->srate);
         }
 
         if (shake_damp != x->shake_dampSave) {
@@ -569,6 +570,8 @@ static t_int *metashake_perform(t_int *w) {
                 x->shakeEnergy = MAX_SHAKE;
         }
 
+        if (metashake_sleeping(x, out, n))
+            return w + 4;
         while (n--) {
             lastOutput = cabasa_tick(x);
             *out++ = 10. * lastOutput;
@@ -589,7 +592,7 @@ static t_int *metashake_perform(t_int *w) {
         if (res_freq != x->res_freqSave) {
             // res_freq *= FREQ_SCALE;
             x->res_freqSave = x->res_freq = res_freq;
-            x->coeffs[0] = -0.6 * 2.0 * cos(res_freq * TWO_PI / x->srate);
+            x->coeffs[0] = -0.6 * 2.0 * Coeff_cos(res_freq * TWO_PI / x->srate);
         }
 
         if (shake_damp != x->shake_dampSave) {
@@ -604,6 +607,8 @@ static t_int *metashake_perform(t_int *w) {
                 x->shakeEnergy = MAX_SHAKE;
         }
 
+        if (metashake_sleeping(x, out, n))
+            return w + 4;
         while (n--) {
             lastOutput = sekere_tick(x);
             *out++ = 10. * lastOutput;
@@ -623,7 +628,7 @@ static t_int *metashake_perform(t_int *w) {
             // res_freq *= FREQ_SCALE;
             x->res_freqSave = x->res_freq = res_freq;
             x->coeffs[0] =
-                -GUIR_GOURD_RESON * 2.0 * cos(res_freq * TWO_PI / x->srate);
+                -GUIR_GOURD_RESON * 2.0 * Coeff_cos(res_freq * TWO_PI / x->srate);
         }
 
         if (scrapeVel != x->scrapeVelSave) {
@@ -640,9 +645,11 @@ static t_int *metashake_perform(t_int *w) {
             // res_freq1 *= FREQ_SCALE;
             x->res_freq1Save = x->res_freq1 = res_freq1;
             x->coeffs1[0] =
-                -GUIR_GOURD_RESON2 * 2.0 * cos(res_freq1 * TWO_PI / x->srate);
+                -GUIR_GOURD_RESON2 * 2.0 * Coeff_cos(res_freq1 * TWO_PI / x->srate);
         }
 
+        if (metashake_sleeping(x, out, n))
+            return w + 4;
         while (n--) {
             if (x->guiroScrape < 1.0) {
                 x->guiroScrape += x->scrapeVel;
@@ -670,7 +677,7 @@ static t_int *metashake_perform(t_int *w) {
         if (res_freq != x->res_freqSave) {
             // res_freq *= FREQ_SCALE;
             x->res_freqSave = x->res_freq = res_freq;
-            x->coeffs[0] = -0.96 * 2.0 * cos(res_freq * TWO_PI / x->srate);
+            x->coeffs[0] = -0.96 * 2.0 * Coeff_cos(res_freq * TWO_PI / x->srate);
         }
 
         if (shake_damp != x->shake_dampSave) {
@@ -706,6 +713,8 @@ static t_int *metashake_perform(t_int *w) {
                 x->res_random = 0.;
         }
 
+        if (metashake_sleeping(x, out, n))
+            return w + 4;
         while (n--) {
             lastOutput = tamb_tick(x);
             *out++ = lastOutput;
@@ -753,6 +762,8 @@ static t_int *metashake_perform(t_int *w) {
         if (res_freq4 != x->res_freq4Save) {
             x->res_freq4Save = x->res_freq4 = res_freq4; //*FREQ_SCALE;
         }
+        if (metashake_sleeping(x, out, n))
+            return w + 4;
         while (n--) {
             lastOutput = sleigh_tick(x);
             *out++ = lastOutput;
@@ -798,6 +809,8 @@ static t_int *metashake_perform(t_int *w) {
                 x->res_random = 0.;
         }
 
+        if (metashake_sleeping(x, out, n))
+            return w + 4;
         while (n--) {
             lastOutput = bamboo_tick(x);
             *out++ = lastOutput;
@@ -811,6 +824,8 @@ static t_int *metashake_perform(t_int *w) {
         }
     }
 
+    Silence_check(&x->silence, (t_float *)(w[2]), (int)w[3],
+                  metashake_excitation(x));
     return w + 4;
 }
 
@@ -818,7 +833,7 @@ static void metashake_dsp(t_metashake *x, t_signal **sp) {
     x->srate = sp[0]->s_sr;
     x->one_over_srate = 1. / x->srate;
     /* outlet     vectorsize */
-    dsp_add(metashake_perform, 3, x, sp[1]->s_vec, sp[0]->s_n);
+    Denormals_dspAdd(metashake_perform, 3, x, sp[1]->s_vec, sp[0]->s_n);
 }
 
 static void metashake_setsleigh(t_metashake *x) {
@@ -1062,11 +1077,20 @@ static void *metashake_new(void) {
 
     sleigh_setup(x);
 
-    srand(23);
+    Noise_init(&x->noise, 0);
+    Silence_init(&x->silence);
 
     return (x);
 }
 
+static void metashake_seed(t_metashake *x, t_floatarg f) {
+    Noise_seed(&x->noise, (unsigned int)f);
+}
+
+static void metashake_sleep(t_metashake *x, t_floatarg f) {
+    Silence_setThreshold(&x->silence, f);
+}
+
 void metashake_tilde_setup(void) {
     metashake_class =
         class_new(gensym("metashake~"), (t_newmethod)metashake_new, 0,
@@ -1077,6 +1101,10 @@ void metashake_tilde_setup(void) {
     /* messages for leftmost inlet */
     class_addfloat(metashake_class, (t_method)metashake_float);
     class_addbang(metashake_class, (t_method)metashake_bang);
+    class_addmethod(metashake_class, (t_method)metashake_seed, gensym("seed"), A_FLOAT,
+                    A_NULL);
+    class_addmethod(metashake_class, (t_method)metashake_sleep, gensym("sleep"), A_FLOAT,
+                    A_NULL);
     class_addmethod(metashake_class, (t_method)metashake_setsleigh,
                     gensym("sleigh"), A_NULL);
     class_addmethod(metashake_class, (t_method)metashake_setbamboo,
@@ -2,13 +2,9 @@
 #include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include "stk_c.h"
 
 #define TWO_PI 6.283185307
-#define ONE_OVER_RANDLIMIT 0.00006103516 // constant = 1. / 16384.0
-#define ATTACK 0
-#define DECAY 1
-#define SUSTAIN 2
-#define RELEASE 3
 #define MAX_RANDOM 32768
 #define MAX_SHAKE 1.0
 
@@ -53,14 +49,17 @@ typedef struct _sekere {
     short shake_maxConnected;
 
     float srate, one_over_srate;
+
+    Noise noise;
+    Silence silence;
 } t_sekere;
 
 /****PROTOTYPES****/
 
 // setup funcs
-static void *sekere_new(double val);
+static void *sekere_new(t_floatarg val);
 static void sekere_dsp(t_sekere *x, t_signal **sp, short *count);
-static void sekere_float(t_sekere *x, double f);
+static void sekere_float(t_sekere *x, t_floatarg f);
 // static void sekere_int(t_sekere *x, int f);
 static void sekere_bang(t_sekere *x);
 static t_int *sekere_perform(t_int *w);
@@ -69,16 +68,12 @@ static t_int *sekere_perform(t_int *w);
 static void sekere_setup(t_sekere *x);
 static float sekere_tick(t_sekere *x);
 
-// noise maker
-static float noise_tick(void);
-static int my_random(int max);
-
 /****FUNCTIONS****/
 
 static void sekere_setup(t_sekere *x) {
     x->num_objects = x->num_objectsSave = SEKE_NUM_BEANS;
     x->gain = log(x->num_objects) / log(4.0) * 40.0 / (float)x->num_objects;
-    x->coeffs[0] = -0.6 * 2.0 * cos(5500.0 * TWO_PI / x->srate);
+    x->coeffs[0] = -0.6 * 2.0 * Coeff_cos(5500.0 * TWO_PI / x->srate);
     x->coeffs[1] = 0.6 * 0.6;
     x->soundDecay = SEKE_SOUND_DECAY;
     x->systemDecay = SEKE_SYSTEM_DECAY;
@@ -86,15 +81,15 @@ static void sekere_setup(t_sekere *x) {
 
 static float sekere_tick(t_sekere *x) {
     float data;
-    x->shakeEnergy *= x->systemDecay;            // Exponential system decay
-    if (my_random(1024) < x->num_objects)        // If collision
-        x->sndLevel += x->gain * x->shakeEnergy; //   add energy
-    x->input = x->sndLevel * noise_tick();       // Actual Sound is Random
-    x->sndLevel *= x->soundDecay;                // Exponential Sound decay
-    x->input -= x->output[0] * x->coeffs[0];     // Do gourd
-    x->input -= x->output[1] * x->coeffs[1];     //   resonance
-    x->output[1] = x->output[0];                 //     filter
-    x->output[0] = x->input;                     //       calculations
+    x->shakeEnergy *= x->systemDecay;                   // Exponential system decay
+    if (Noise_random(&x->noise, 1024) < x->num_objects) // If collision
+        x->sndLevel += x->gain * x->shakeEnergy;        //   add energy
+    x->input = x->sndLevel * Noise_tick(&x->noise);     // Actual Sound is Random
+    x->sndLevel *= x->soundDecay;                       // Exponential Sound decay
+    x->input -= x->output[0] * x->coeffs[0];            // Do gourd
+    x->input -= x->output[1] * x->coeffs[1];            //   resonance
+    x->output[1] = x->output[0];                        //     filter
+    x->output[0] = x->input;                            //       calculations
     x->finalZ[2] = x->finalZ[1];
     x->finalZ[1] = x->finalZ[0];
     x->finalZ[0] = x->output[1];
@@ -103,24 +98,17 @@ static float sekere_tick(t_sekere *x) {
     return data;
 }
 
-static int my_random(int max) { //  Return Random Int Between 0 and max
-    unsigned long temp;
-    temp = (unsigned long)rand();
-    temp *= (unsigned long)max;
-    temp >>= 15;
-    return (int)temp;
+static void sekere_res_coeff(t_sekere *x, t_floatarg f);
+static void sekere_shake_dump(t_sekere *x, t_floatarg f);
+static void sekere_shake_max(t_sekere *x, t_floatarg f);
+
+static void sekere_seed(t_sekere *x, t_floatarg f) {
+    Noise_seed(&x->noise, (unsigned int)f);
 }
 
-// noise maker
-static float noise_tick(void) {
-    float output;
-    output = (float)rand() - 16384.;
-    output *= ONE_OVER_RANDLIMIT;
-    return output;
+static void sekere_sleep(t_sekere *x, t_floatarg f) {
+    Silence_setThreshold(&x->silence, f);
 }
-static void sekere_res_coeff(t_sekere *x, double f);
-static void sekere_shake_dump(t_sekere *x, double f);
-static void sekere_shake_max(t_sekere *x, double f);
 
 void sekere_tilde_setup(void) {
     sekere_class = class_new(gensym("sekere~"), (t_newmethod)sekere_new, 0,
@@ -135,17 +123,21 @@ void sekere_tilde_setup(void) {
     class_addmethod(sekere_class, (t_method)sekere_shake_max,
                     gensym("shake_max"), A_FLOAT, 0);
     class_addbang(sekere_class, (t_method)sekere_bang);
+    class_addmethod(sekere_class, (t_method)sekere_seed, gensym("seed"), A_FLOAT,
+                    A_NULL);
+    class_addmethod(sekere_class, (t_method)sekere_sleep, gensym("sleep"), A_FLOAT,
+                    A_NULL);
 }
-static void sekere_float(t_sekere *x, double f) { x->num_objects = (long)f; }
+static void sekere_float(t_sekere *x, t_floatarg f) { x->num_objects = (long)f; }
 
-static void sekere_res_coeff(t_sekere *x, double f) {
+static void sekere_res_coeff(t_sekere *x, t_floatarg f) {
     x->res_freq = f;
-    x->coeffs[0] = -0.6 * 2.0 * cos(x->res_freq * TWO_PI / x->srate);
+    x->coeffs[0] = -0.6 * 2.0 * Coeff_cos(x->res_freq * TWO_PI / x->srate);
 }
 
-static void sekere_shake_dump(t_sekere *x, double f) { x->shake_damp = f; }
+static void sekere_shake_dump(t_sekere *x, t_floatarg f) { x->shake_damp = f; }
 
-static void sekere_shake_max(t_sekere *x, double f) { x->shake_max = f; }
+static void sekere_shake_max(t_sekere *x, t_floatarg f) { x->shake_max = f; }
 
 static void sekere_bang(t_sekere *x) {
     int i;
@@ -167,7 +159,7 @@ static void sekere_bang(t_sekere *x) {
     }
 }
 
-static void *sekere_new(double initial_coeff) {
+static void *sekere_new(t_floatarg initial_coeff) {
     (void)initial_coeff;
     unsigned int i;
 
@@ -206,7 +198,8 @@ static void *sekere_new(double initial_coeff) {
 
     sekere_setup(x);
 
-    srand(54);
+    Noise_init(&x->noise, 0);
+    Silence_init(&x->silence);
 
     return (x);
 }
@@ -215,7 +208,7 @@ void sekere_dsp(t_sekere *x, t_signal **sp, short *count) {
     (void)count;
     x->srate = sp[0]->s_sr;
     x->one_over_srate = 1. / x->srate;
-    dsp_add(sekere_perform, 3, x, sp[0]->s_vec, sp[0]->s_n);
+    Denormals_dspAdd(sekere_perform, 3, x, sp[0]->s_vec, sp[0]->s_n);
 }
 
 t_int *sekere_perform(t_int *w) {
@@ -241,7 +234,7 @@ t_int *sekere_perform(t_int *w) {
 
     if (res_freq != x->res_freqSave) {
         x->res_freqSave = x->res_freq = res_freq;
-        x->coeffs[0] = -0.6 * 2.0 * cos(res_freq * TWO_PI / x->srate);
+        x->coeffs[0] = -0.6 * 2.0 * Coeff_cos(res_freq * TWO_PI / x->srate);
     }
 
     if (shake_damp != x->shake_dampSave) {
@@ -256,9 +249,16 @@ t_int *sekere_perform(t_int *w) {
             x->shakeEnergy = MAX_SHAKE;
     }
 
+    if (Silence_sleeping(&x->silence, x->shakeEnergy)) {
+        while (n--)
+            *out++ = 0.;
+        return w + 4;
+    }
+
     while (n--) {
         lastOutput = sekere_tick(x);
         *out++ = lastOutput;
     }
+    Silence_check(&x->silence, (t_float *)(w[2]), (int)w[3], x->shakeEnergy);
     return w + 4;
 }
@@ -9,12 +9,8 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <math.h>
+#include "stk_c.h"
 #define TWOPI 6.283185307
-#define ONE_OVER_RANDLIMIT 0.00006103516 // constant = 1. / 16384.0
-#define ATTACK 0
-#define DECAY 1
-#define SUSTAIN 2
-#define RELEASE 3
 #define MAX_RANDOM 32768
 
 
@@ -79,22 +75,28 @@ typedef struct _shaker
     float e_state;
 
     float srate, one_over_srate;
+
+    Noise noise;
+    Silence silence;
 } t_shaker;
 
 /****PROTOTYPES****/
 
 //setup funcs
+#ifdef MSP
 static void *shaker_new(double val);
-static void shaker_dsp(t_shaker *x, t_signal **sp, short *count);
 static void shaker_float(t_shaker *x, double f);
+#endif
+#ifdef PD
+static void *shaker_new(t_floatarg val);
+static void shaker_float(t_shaker *x, t_floatarg f);
+#endif
+static void shaker_dsp(t_shaker *x, t_signal **sp, short *count);
 static void shaker_int(t_shaker *x, int f);
 static void shaker_bang(t_shaker *x);
 static t_int *shaker_perform(t_int *w);
 static void shaker_assist(t_shaker *x, void *b, long m, long a, char *s);
 
-//noise maker
-static float noise_tick(void);
-
 //biquad funcs
 static void bq_setFreqAndReson(t_shaker *x, float freq, float reson);
 static void bq_setEqualGainZeros(t_shaker *x);
@@ -116,7 +118,7 @@ static void shake(t_shaker *x, float amplitude);
 static void setFreq(t_shaker *x, float freq);
 static void noteOn(t_shaker *x, float freq, float amp);
 static void noteOff(t_shaker *x, float amplitude);
-static long one_in(long one_in_howmany);
+static long one_in(t_shaker *x, long one_in_howmany);
 
 /****FUNCTIONS****/
 
@@ -146,9 +148,9 @@ static void noteOff(t_shaker *x, float amplitude)
 	x->shake_num = 0;
 }
 
-static long one_in(long one_in_howmany)
+static long one_in(t_shaker *x, long one_in_howmany)
 {
-	if(rand() < one_in_howmany) return 1;
+	if(Noise_random(&x->noise, MAX_RANDOM) < one_in_howmany) return 1;
 	else return 0;
 }
 
@@ -232,7 +234,7 @@ static float e_tick(t_shaker *x)
 static void bq_setFreqAndReson(t_shaker *x, float freq, float reson)
 {
 	x->bq_poleCoeffs[1] = -(reson*reson);
-	x->bq_poleCoeffs[0] = 2. * reson * cos(TWOPI * freq / x->srate);
+	x->bq_poleCoeffs[0] = 2. * reson * Coeff_cos(TWOPI * freq / x->srate);
 }
 
 static void bq_setEqualGainZeros(t_shaker *x)
@@ -267,15 +269,6 @@ static float bq_tick(t_shaker *x, float sample)
 }
 
 
-//noise maker
-static float noise_tick(void) 
-{
-	float output;
-	output = (float)rand() - 16384.;
-	output *= ONE_OVER_RANDLIMIT;
-	return output;
-}
-
 #ifdef MSP
 //primary MSP funcs
 void main(void)
@@ -320,10 +313,18 @@ static void shaker_int(t_shaker *x, int f)
 #endif
 
 #ifdef PD
-static void shaker_res_freq(t_shaker *x, double f);
-static void shaker_shake_dump(t_shaker *x, double f);
-static void shaker_shake_speed(t_shaker *x, double f);
-static void shaker_shake_max(t_shaker *x, double f);
+static void shaker_res_freq(t_shaker *x, t_floatarg f);
+static void shaker_shake_dump(t_shaker *x, t_floatarg f);
+static void shaker_shake_speed(t_shaker *x, t_floatarg f);
+static void shaker_shake_max(t_shaker *x, t_floatarg f);
+
+static void shaker_seed(t_shaker *x, t_floatarg f) {
+  Noise_seed(&x->noise, (unsigned int)f);
+}
+
+static void shaker_sleep(t_shaker *x, t_floatarg f) {
+  Silence_setThreshold(&x->silence, f);
+}
 
 void shaker_tilde_setup(void)
 {
@@ -335,28 +336,32 @@ void shaker_tilde_setup(void)
   class_addmethod(shaker_class, (t_method)shaker_shake_speed, gensym("shake_speed"), A_FLOAT, 0);
   class_addmethod(shaker_class, (t_method)shaker_shake_max, gensym("shake_max"), A_FLOAT, 0);
   class_addbang(shaker_class, (t_method)shaker_bang);
+  class_addmethod(shaker_class, (t_method)shaker_seed, gensym("seed"), A_FLOAT,
+                  A_NULL);
+  class_addmethod(shaker_class, (t_method)shaker_sleep, gensym("sleep"), A_FLOAT,
+                  A_NULL);
 }
 
-static void shaker_float(t_shaker *x, double f)
+static void shaker_float(t_shaker *x, t_floatarg f)
 {
   x->num_beans = (long)f;
 }
-static void shaker_res_freq(t_shaker *x, double f)
+static void shaker_res_freq(t_shaker *x, t_floatarg f)
 {
   x->res_freq = f;
 }
-static void shaker_shake_dump(t_shaker *x, double f)
+static void shaker_shake_dump(t_shaker *x, t_floatarg f)
 {
   //x->shake_damp = .98 + f*0.02;
   x->shake_damp = f;
 }
-static void shaker_shake_speed(t_shaker *x, double f)
+static void shaker_shake_speed(t_shaker *x, t_floatarg f)
 {
   //x->shake_speed = f * 0.002;
   x->shake_speed = f;
 }
 
-static void shaker_shake_max(t_shaker *x, double f)
+static void shaker_shake_max(t_shaker *x, t_floatarg f)
 {
   //x->shake_max = f * 2.;
   x->shake_max = f;
@@ -414,13 +419,13 @@ static void *shaker_new(double initial_coeff)
     x->shake_timesSave = -1;
     x->shake_maxSave = -1.;
  	
-    srand(0.54);
+    Noise_init(&x->noise, 0);
     
     return (x);
 }
 #endif
 #ifdef PD
-static void *shaker_new(double initial_coeff)
+static void *shaker_new(t_floatarg initial_coeff)
 {
 	unsigned int i;
 
@@ -466,7 +471,8 @@ static void *shaker_new(double initial_coeff)
     x->shake_timesSave = -1;
     x->shake_maxSave = -1.;
  	
-    srand(0.54);
+    Noise_init(&x->noise, 0);
+    Silence_init(&x->silence);
     
     return (x);
 }
@@ -491,7 +497,7 @@ static void shaker_dsp(t_shaker *x, t_signal **sp, short *count)
 	x->srate = sp[0]->s_sr;
 	x->one_over_srate = 1./x->srate;
 	
-	dsp_add(shaker_perform, 3, x, sp[0]->s_vec, sp[0]->s_n);	
+	Denormals_dspAdd(shaker_perform, 3, x, sp[0]->s_vec, sp[0]->s_n);	
 #endif
 }
 
@@ -555,6 +561,15 @@ static t_int *shaker_perform(t_int *w)
 		e_keyOn(x);
 	}	
 
+#ifdef PD
+	if (Silence_sleeping(&x->silence,
+	                     x->e_state == ATTACK ? 1. : x->shakeEnergy + x->e_value)) {
+		while (n--)
+			*out++ = 0.;
+		return w + 4;
+	}
+#endif
+
 	while(n--) {
 		temp = e_tick(x) * shake_max;
 		if(shake_num > 0) {
@@ -568,11 +583,11 @@ static t_int *shaker_perform(t_int *w)
 		if(temp > x->shakeEnergy) x->shakeEnergy = temp;
 		x->shakeEnergy *= shake_damp;
 		
-		if(one_in(wait_time) == 1) {
+		if(one_in(x, wait_time) == 1) {
 			x->noiseGain += gain_norm * x->shakeEnergy * num_beans;
 		}
 		
-		lastOutput = x->noiseGain * noise_tick();
+		lastOutput = x->noiseGain * Noise_tick(&x->noise);
 		x->noiseGain *= coll_damp;
 		lastOutput = bq_tick(x, lastOutput);
 		
@@ -582,6 +597,8 @@ static t_int *shaker_perform(t_int *w)
 	return w + 9;
 #endif
 #ifdef PD
+	Silence_check(&x->silence, (t_float *)(w[2]), (int)w[3],
+	              x->e_state == ATTACK ? 1. : x->shakeEnergy + x->e_value);
 	return w + 4;
 #endif
 }	
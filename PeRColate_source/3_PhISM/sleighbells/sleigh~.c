@@ -14,12 +14,8 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <math.h>
+#include "stk_c.h"
 #define TWO_PI 6.283185307
-#define ONE_OVER_RANDLIMIT 0.00006103516 // constant = 1. / 16384.0
-#define ATTACK 0
-#define DECAY 1
-#define SUSTAIN 2
-#define RELEASE 3
 #define MAX_RANDOM 32768
 #define MAX_SHAKE 1.0
 
@@ -81,6 +77,8 @@ typedef struct _sleigh
     short shake_maxConnected;
    
     float srate, one_over_srate;
+
+    Noise noise;
 } t_sleigh;
 
 /****PROTOTYPES****/
@@ -97,10 +95,6 @@ void sleigh_assist(t_sleigh *x, void *b, long m, long a, char *s);
 void sleigh_setup(t_sleigh *x);
 float sleigh_tick(t_sleigh *x);
 
-//noise maker
-float noise_tick();
-int my_random(int max) ;
-
 /****FUNCTIONS****/
 
 #define SLEI_SOUND_DECAY 0.97
@@ -139,26 +133,26 @@ void sleigh_setup(t_sleigh *x) {
 float sleigh_tick(t_sleigh *x) {
   float data;
   x->shakeEnergy *= x->systemDecay;         // Exponential System Decay
-  if (my_random(1024) < x->num_objects) {     
+  if (Noise_random(&x->noise, 1024) < x->num_objects) {     
     x->sndLevel += x->gain *  x->shakeEnergy;   
-    x->cymb_rand = noise_tick() * x->res_freq * 0.05;
+    x->cymb_rand = Noise_tick(&x->noise) * x->res_freq * 0.05;
     x->coeffs[0] = -SLEI_CYMB_RESON * 2.0 * 
       cos((x->res_freq + x->cymb_rand) * TWO_PI * x->one_over_srate);
-    x->cymb_rand = noise_tick() * x->res_freq1 * 0.03;
+    x->cymb_rand = Noise_tick(&x->noise) * x->res_freq1 * 0.03;
     x->coeffs1[0] = -SLEI_CYMB_RESON * 2.0 * 
       cos((x->res_freq1 + x->cymb_rand) * TWO_PI * x->one_over_srate);
-    x->cymb_rand = noise_tick() * x->res_freq2 * 0.03;
+    x->cymb_rand = Noise_tick(&x->noise) * x->res_freq2 * 0.03;
     x->coeffs2[0] = -SLEI_CYMB_RESON * 2.0 * 
       cos((x->res_freq2 + x->cymb_rand) * TWO_PI * x->one_over_srate);
-    x->cymb_rand = noise_tick() * x->res_freq3 * 0.03;
+    x->cymb_rand = Noise_tick(&x->noise) * x->res_freq3 * 0.03;
     x->coeffs3[0] = -SLEI_CYMB_RESON * 2.0 * 
       cos((x->res_freq3 + x->cymb_rand) * TWO_PI * x->one_over_srate);
-    x->cymb_rand = noise_tick() * x->res_freq4 * 0.03;
+    x->cymb_rand = Noise_tick(&x->noise) * x->res_freq4 * 0.03;
     x->coeffs4[0] = -SLEI_CYMB_RESON * 2.0 * 
       cos((x->res_freq4 + x->cymb_rand) * TWO_PI * x->one_over_srate);
   }
   x->input = x->sndLevel;
-  x->input *= noise_tick();        // Actual Sound is Random
+  x->input *= Noise_tick(&x->noise); // Actual Sound is Random
   x->input1 = x->input;
   x->input2 = x->input;
   x->input3 = x->input * 0.5;
@@ -204,23 +198,6 @@ float sleigh_tick(t_sleigh *x) {
   return data;
 }
 
-int my_random(int max)  {   //  Return Random Int Between 0 and max
-	unsigned long temp;
-  	temp = (unsigned long) rand();
-	temp *= (unsigned long) max;
-	temp >>= 15;
-	return (int) temp; 
-}
-
-//noise maker
-float noise_tick() 
-{
-	float output;
-	output = (float)rand() - 16384.;
-	output *= ONE_OVER_RANDLIMIT;
-	return output;
-}
-
 //primary MSP funcs
 void main(void)
 {
@@ -335,7 +312,7 @@ void *sleigh_new(double initial_coeff)
     
     sleigh_setup(x);
     
-    srand(0.54);
+    Noise_init(&x->noise, 0);
     
     return (x);
 }
@@ -477,6 +454,9 @@ typedef struct _sleigh
     short shake_maxConnected;
    
     float srate, one_over_srate;
+
+    Noise noise;
+    Silence silence;
 } t_sleigh;
 
 /****FUNCTIONS****/
@@ -491,23 +471,6 @@ typedef struct _sleigh
 #define SLEI_CYMB_FREQ4 9800
 #define SLEI_CYMB_RESON 0.99
 
-static int my_random(int max)  {   //  Return Random Int Between 0 and max
-	unsigned long temp;
-  	temp = (unsigned long) rand();
-	temp *= (unsigned long) max;
-	temp >>= 15;
-	return (int) temp; 
-}
-
-//noise maker
-static float noise_tick(void) 
-{
-	float output;
-	output = (float)rand() - 16384.;
-	output *= ONE_OVER_RANDLIMIT;
-	return output;
-}
-
 static void sleigh_setup(t_sleigh *x) {
 
   x->num_objects = x->num_objectsSave = SLEI_NUM_BELLS;
@@ -519,41 +482,41 @@ static void sleigh_setup(t_sleigh *x) {
   x->res_freq3 = x->res_freq3Save =SLEI_CYMB_FREQ3;
   x->res_freq4 = x->res_freq4Save = SLEI_CYMB_FREQ4;
   x->gain = 8.0 / x->num_objects;
-  x->coeffs[0] = -SLEI_CYMB_RESON * 2.0 * cos(x->res_freq * TWO_PI / x->srate);
+  x->coeffs[0] = -SLEI_CYMB_RESON * 2.0 * Coeff_cos(x->res_freq * TWO_PI / x->srate);
   x->coeffs[1] = SLEI_CYMB_RESON*SLEI_CYMB_RESON;
-  x->coeffs1[0] = -SLEI_CYMB_RESON * 2.0 * cos(x->res_freq1 * TWO_PI / x->srate);
+  x->coeffs1[0] = -SLEI_CYMB_RESON * 2.0 * Coeff_cos(x->res_freq1 * TWO_PI / x->srate);
   x->coeffs1[1] = SLEI_CYMB_RESON*SLEI_CYMB_RESON;
-  x->coeffs2[0] = -SLEI_CYMB_RESON * 2.0 * cos(x->res_freq2 * TWO_PI / x->srate);
+  x->coeffs2[0] = -SLEI_CYMB_RESON * 2.0 * Coeff_cos(x->res_freq2 * TWO_PI / x->srate);
   x->coeffs2[1] = SLEI_CYMB_RESON*SLEI_CYMB_RESON;                      
-  x->coeffs3[0] = -SLEI_CYMB_RESON * 2.0 * cos(x->res_freq3 * TWO_PI / x->srate);
+  x->coeffs3[0] = -SLEI_CYMB_RESON * 2.0 * Coeff_cos(x->res_freq3 * TWO_PI / x->srate);
   x->coeffs3[1] = SLEI_CYMB_RESON*SLEI_CYMB_RESON;
-  x->coeffs4[0] = -SLEI_CYMB_RESON * 2.0 * cos(x->res_freq4 * TWO_PI / x->srate);
+  x->coeffs4[0] = -SLEI_CYMB_RESON * 2.0 * Coeff_cos(x->res_freq4 * TWO_PI / x->srate);
   x->coeffs4[1] = SLEI_CYMB_RESON*SLEI_CYMB_RESON;
 }
 
 static float sleigh_tick(t_sleigh *x) {
   float data;
   x->shakeEnergy *= x->systemDecay;         // Exponential System Decay
-  if (my_random(1024) < x->num_objects) {     
+  if (Noise_random(&x->noise, 1024) < x->num_objects) {     
     x->sndLevel += x->gain *  x->shakeEnergy;   
-    x->cymb_rand = noise_tick() * x->res_freq * 0.05;
+    x->cymb_rand = Noise_tick(&x->noise) * x->res_freq * 0.05;
     x->coeffs[0] = -SLEI_CYMB_RESON * 2.0 * 
-      cos((x->res_freq + x->cymb_rand) * TWO_PI * x->one_over_srate);
-    x->cymb_rand = noise_tick() * x->res_freq1 * 0.03;
+      Coeff_cos((x->res_freq + x->cymb_rand) * TWO_PI * x->one_over_srate);
+    x->cymb_rand = Noise_tick(&x->noise) * x->res_freq1 * 0.03;
     x->coeffs1[0] = -SLEI_CYMB_RESON * 2.0 * 
-      cos((x->res_freq1 + x->cymb_rand) * TWO_PI * x->one_over_srate);
-    x->cymb_rand = noise_tick() * x->res_freq2 * 0.03;
+      Coeff_cos((x->res_freq1 + x->cymb_rand) * TWO_PI * x->one_over_srate);
+    x->cymb_rand = Noise_tick(&x->noise) * x->res_freq2 * 0.03;
     x->coeffs2[0] = -SLEI_CYMB_RESON * 2.0 * 
-      cos((x->res_freq2 + x->cymb_rand) * TWO_PI * x->one_over_srate);
-    x->cymb_rand = noise_tick() * x->res_freq3 * 0.03;
+      Coeff_cos((x->res_freq2 + x->cymb_rand) * TWO_PI * x->one_over_srate);
+    x->cymb_rand = Noise_tick(&x->noise) * x->res_freq3 * 0.03;
     x->coeffs3[0] = -SLEI_CYMB_RESON * 2.0 * 
-      cos((x->res_freq3 + x->cymb_rand) * TWO_PI * x->one_over_srate);
-    x->cymb_rand = noise_tick() * x->res_freq4 * 0.03;
+      Coeff_cos((x->res_freq3 + x->cymb_rand) * TWO_PI * x->one_over_srate);
+    x->cymb_rand = Noise_tick(&x->noise) * x->res_freq4 * 0.03;
     x->coeffs4[0] = -SLEI_CYMB_RESON * 2.0 * 
-      cos((x->res_freq4 + x->cymb_rand) * TWO_PI * x->one_over_srate);
+      Coeff_cos((x->res_freq4 + x->cymb_rand) * TWO_PI * x->one_over_srate);
   }
   x->input = x->sndLevel;
-  x->input *= noise_tick();        // Actual Sound is Random
+  x->input *= Noise_tick(&x->noise); // Actual Sound is Random
   x->input1 = x->input;
   x->input2 = x->input;
   x->input3 = x->input * 0.5;
@@ -657,10 +620,17 @@ static t_int *sleigh_perform(t_int *w)
 		x->res_freq4Save = x->res_freq4 = res_freq4;
 	}	
 	
+	if (Silence_sleeping(&x->silence, x->shakeEnergy)) {
+		while (n--)
+			*out++ = 0.;
+		return w + 4;
+	}
+
 	while(n--) {
 		lastOutput = sleigh_tick(x);		
 		*out++ = lastOutput;
 	}
+	Silence_check(&x->silence, (t_float *)(w[2]), (int)w[3], x->shakeEnergy);
 	return w + 4;
 }	
 
@@ -669,7 +639,7 @@ static void sleigh_dsp(t_sleigh *x, t_signal **sp)
 	x->srate = sp[0]->s_sr;
 	x->one_over_srate = 1./x->srate;
 	
-	dsp_add(sleigh_perform, 3, x, sp[1]->s_vec, sp[0]->s_n);	
+	Denormals_dspAdd(sleigh_perform, 3, x, sp[1]->s_vec, sp[0]->s_n);	
 	
 }
 
@@ -792,12 +762,21 @@ static void *sleigh_new(void)
     
     sleigh_setup(x);
     
-    srand(0.54);
+    Noise_init(&x->noise, 0);
+    Silence_init(&x->silence);
     
     return (x);
 }
 
 
+static void sleigh_seed(t_sleigh *x, t_floatarg f) {
+    Noise_seed(&x->noise, (unsigned int)f);
+}
+
+static void sleigh_sleep(t_sleigh *x, t_floatarg f) {
+    Silence_setThreshold(&x->silence, f);
+}
+
 void sleigh_tilde_setup(void)
 {
     sleigh_class = class_new(gensym("sleigh~"), (t_newmethod)sleigh_new, 0,
@@ -806,6 +785,10 @@ void sleigh_tilde_setup(void)
     class_addmethod(sleigh_class, (t_method)sleigh_dsp, gensym("dsp"), A_NULL);
 	class_addfloat(sleigh_class, (t_method)sleigh_float);
 	class_addbang(sleigh_class, (t_method)sleigh_bang);
+	class_addmethod(sleigh_class, (t_method)sleigh_seed, gensym("seed"), A_FLOAT,
+	                A_NULL);
+	class_addmethod(sleigh_class, (t_method)sleigh_sleep, gensym("sleep"), A_FLOAT,
+	                A_NULL);
     class_addmethod(sleigh_class, (t_method)sleigh_res_freq, gensym("res_freq"), A_FLOAT, A_NULL);
     class_addmethod(sleigh_class, (t_method)sleigh_shake_damp, gensym("shake_damp"), A_FLOAT, A_NULL);
     class_addmethod(sleigh_class, (t_method)sleigh_shake_max, gensym("shake_max"), A_FLOAT, A_NULL);
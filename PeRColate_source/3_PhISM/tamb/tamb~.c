@@ -2,12 +2,8 @@
 #include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include "stk_c.h"
 #define TWO_PI 6.283185307
-#define ONE_OVER_RANDLIMIT 0.00006103516 // constant = 1. / 16384.0
-#define ATTACK 0
-#define DECAY 1
-#define SUSTAIN 2
-#define RELEASE 3
 #define MAX_RANDOM 32768
 #define MAX_SHAKE 1.0
 
@@ -64,14 +60,17 @@ typedef struct _tamb {
     short shake_maxConnected;
 
     float srate, one_over_srate;
+
+    Noise noise;
+    Silence silence;
 } t_tamb;
 
 /****PROTOTYPES****/
 
 // setup funcs
-static void *tamb_new(double val);
+static void *tamb_new(t_floatarg val);
 static void tamb_dsp(t_tamb *x, t_signal **sp, short *count);
-static void tamb_float(t_tamb *x, double f);
+static void tamb_float(t_tamb *x, t_floatarg f);
 static void tamb_int(t_tamb *x, int f);
 static void tamb_bang(t_tamb *x);
 static t_int *tamb_perform(t_int *w);
@@ -80,10 +79,6 @@ static void tamb_assist(t_tamb *x, void *b, long m, long a, char *s);
 static void tamb_setup(t_tamb *x);
 static float tamb_tick(t_tamb *x);
 
-// noise maker
-static float noise_tick(void);
-static int my_random(int max);
-
 /****FUNCTIONS****/
 
 static void tamb_setup(t_tamb *x) {
@@ -92,30 +87,30 @@ static void tamb_setup(t_tamb *x) {
     x->soundDecay = TAMB_SOUND_DECAY;
     x->systemDecay = TAMB_SYSTEM_DECAY;
     x->gain = 24.0 / x->num_objects;
-    x->coeffs[0] = -0.96 * 2.0 * cos(TAMB_SHELL_FREQ * TWO_PI / x->srate);
+    x->coeffs[0] = -0.96 * 2.0 * Coeff_cos(TAMB_SHELL_FREQ * TWO_PI / x->srate);
     x->coeffs[1] = 0.96 * 0.96;
     x->coeffs1[0] =
-        -TAMB_CYMB_RESON * 2.0 * cos(TAMB_CYMB_FREQ * TWO_PI / x->srate);
+        -TAMB_CYMB_RESON * 2.0 * Coeff_cos(TAMB_CYMB_FREQ * TWO_PI / x->srate);
     x->coeffs1[1] = TAMB_CYMB_RESON * TAMB_CYMB_RESON;
     x->coeffs2[0] =
-        -TAMB_CYMB_RESON * 2.0 * cos(TAMB_CYMB_FREQ2 * TWO_PI / x->srate);
+        -TAMB_CYMB_RESON * 2.0 * Coeff_cos(TAMB_CYMB_FREQ2 * TWO_PI / x->srate);
     x->coeffs2[1] = TAMB_CYMB_RESON * TAMB_CYMB_RESON;
 }
 
 static float tamb_tick(t_tamb *x) {
     float data;
     x->shakeEnergy *= x->systemDecay; // Exponential System Decay
-    if (my_random(1024) < x->num_objects) {
+    if (Noise_random(&x->noise, 1024) < x->num_objects) {
         x->sndLevel += x->gain * x->shakeEnergy;
-        x->cymb_rand = noise_tick() * x->res_freq1 * 0.05;
+        x->cymb_rand = Noise_tick(&x->noise) * x->res_freq1 * 0.05;
         x->coeffs1[0] = -TAMB_CYMB_RESON * 2.0 *
-                        cos((x->res_freq + x->cymb_rand) * TWO_PI / x->srate);
-        x->cymb_rand = noise_tick() * x->res_freq2 * 0.05;
+                        Coeff_cos((x->res_freq + x->cymb_rand) * TWO_PI / x->srate);
+        x->cymb_rand = Noise_tick(&x->noise) * x->res_freq2 * 0.05;
         x->coeffs2[0] = -TAMB_CYMB_RESON * 2.0 *
-                        cos((x->res_freq2 + x->cymb_rand) * TWO_PI / x->srate);
+                        Coeff_cos((x->res_freq2 + x->cymb_rand) * TWO_PI / x->srate);
     }
     x->input = x->sndLevel;
-    x->input *= noise_tick(); // Actual Sound is Random
+    x->input *= Noise_tick(&x->noise); // Actual Sound is Random
     x->input1 = x->input * 0.8;
     x->input2 = x->input;
     x->input *= TAMB_SHELL_GAIN;
@@ -146,27 +141,19 @@ static float tamb_tick(t_tamb *x) {
     return data;
 }
 
-static int my_random(int max) { //  Return Random Int Between 0 and max
-    unsigned long temp;
-    temp = (unsigned long)rand();
-    temp *= (unsigned long)max;
-    temp >>= 15;
-    return (int)temp;
-}
+static void tamb_res_freq(t_tamb *x, t_floatarg f);
+static void tamb_shake_dump(t_tamb *x, t_floatarg f);
+static void tamb_shake_max(t_tamb *x, t_floatarg f);
+static void tamb_res_freq1(t_tamb *x, t_floatarg f);
+static void tamb_res_freq2(t_tamb *x, t_floatarg f);
 
-// noise maker
-static float noise_tick() {
-    float output;
-    output = (float)rand() - 16384.;
-    output *= ONE_OVER_RANDLIMIT;
-    return output;
+static void tamb_seed(t_tamb *x, t_floatarg f) {
+    Noise_seed(&x->noise, (unsigned int)f);
 }
 
-static void tamb_res_freq(t_tamb *x, double f);
-static void tamb_shake_dump(t_tamb *x, double f);
-static void tamb_shake_max(t_tamb *x, double f);
-static void tamb_res_freq1(t_tamb *x, double f);
-static void tamb_res_freq2(t_tamb *x, double f);
+static void tamb_sleep(t_tamb *x, t_floatarg f) {
+    Silence_setThreshold(&x->silence, f);
+}
 
 void tamb_tilde_setup(void) {
     tamb_class = class_new(gensym("tamb~"), (t_newmethod)tamb_new, 0,
@@ -184,19 +171,23 @@ void tamb_tilde_setup(void) {
     class_addmethod(tamb_class, (t_method)tamb_shake_max, gensym("shake_max"),
                     A_FLOAT, 0);
     class_addbang(tamb_class, (t_method)tamb_bang);
+    class_addmethod(tamb_class, (t_method)tamb_seed, gensym("seed"), A_FLOAT,
+                    A_NULL);
+    class_addmethod(tamb_class, (t_method)tamb_sleep, gensym("sleep"), A_FLOAT,
+                    A_NULL);
 }
 
-static void tamb_float(t_tamb *x, double f) { x->num_objects = (long)f; }
+static void tamb_float(t_tamb *x, t_floatarg f) { x->num_objects = (long)f; }
 
-static void tamb_res_freq(t_tamb *x, double f) { x->res_freq = f; }
+static void tamb_res_freq(t_tamb *x, t_floatarg f) { x->res_freq = f; }
 
-static void tamb_shake_dump(t_tamb *x, double f) { x->shake_damp = f; }
+static void tamb_shake_dump(t_tamb *x, t_floatarg f) { x->shake_damp = f; }
 
-static void tamb_shake_max(t_tamb *x, double f) { x->shake_max = f; }
+static void tamb_shake_max(t_tamb *x, t_floatarg f) { x->shake_max = f; }
 
-static void tamb_res_freq1(t_tamb *x, double f) { x->res_freq1 = f; }
+static void tamb_res_freq1(t_tamb *x, t_floatarg f) { x->res_freq1 = f; }
 
-static void tamb_res_freq2(t_tamb *x, double f) { x->res_freq2 = f; }
+static void tamb_res_freq2(t_tamb *x, t_floatarg f) { x->res_freq2 = f; }
 
 static void tamb_bang(t_tamb *x) {
     int i;
@@ -218,7 +209,7 @@ static void tamb_bang(t_tamb *x) {
     }
 }
 
-static void *tamb_new(double initial_coeff) {
+static void *tamb_new(t_floatarg initial_coeff) {
     unsigned int i;
 
     t_tamb *x = (t_tamb *)pd_new(tamb_class);
@@ -262,7 +253,8 @@ static void *tamb_new(double initial_coeff) {
 
     tamb_setup(x);
 
-    srand(0.54);
+    Noise_init(&x->noise, 0);
+    Silence_init(&x->silence);
 
     return (x);
 }
@@ -271,7 +263,7 @@ static void tamb_dsp(t_tamb *x, t_signal **sp, short *count) {
     x->srate = sp[0]->s_sr;
     x->one_over_srate = 1. / x->srate;
 
-    dsp_add(tamb_perform, 3, x, sp[0]->s_vec, sp[0]->s_n);
+    Denormals_dspAdd(tamb_perform, 3, x, sp[0]->s_vec, sp[0]->s_n);
 }
 
 static t_int *tamb_perform(t_int *w) {
@@ -300,7 +292,7 @@ static t_int *tamb_perform(t_int *w) {
 
     if (res_freq != x->res_freqSave) {
         x->res_freqSave = x->res_freq = res_freq;
-        x->coeffs[0] = -0.96 * 2.0 * cos(res_freq * TWO_PI / x->srate);
+        x->coeffs[0] = -0.96 * 2.0 * Coeff_cos(res_freq * TWO_PI / x->srate);
     }
 
     if (shake_damp != x->shake_dampSave) {
@@ -327,9 +319,16 @@ static t_int *tamb_perform(t_int *w) {
         // x->srate);
     }
 
+    if (Silence_sleeping(&x->silence, x->shakeEnergy)) {
+        while (n--)
+            *out++ = 0.;
+        return w + 4;
+    }
+
     while (n--) {
         lastOutput = tamb_tick(x);
         *out++ = lastOutput;
     }
+    Silence_check(&x->silence, (t_float *)(w[2]), (int)w[3], x->shakeEnergy);
     return w + 4;
 }
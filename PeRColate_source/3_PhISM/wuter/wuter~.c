@@ -12,13 +12,8 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <math.h>
+#include "stk_c.h"
 #define TWO_PI 6.283185307
-#define ONE_OVER_RANDLIMIT 0.00006103516 // constant = 1. / 16384.0
-#define RANDNORM .000030519
-#define ATTACK 0
-#define DECAY 1
-#define SUSTAIN 2
-#define RELEASE 3
 #define MAX_RANDOM 32768
 #define MAX_SHAKE 1.0
 
@@ -77,6 +72,8 @@ typedef struct _wuter
     float pandropL, pandropR;
    
     float srate, one_over_srate;
+
+    Noise noise;
 } t_wuter;
 
 /****PROTOTYPES****/
@@ -93,10 +90,6 @@ static void wuter_assist(t_wuter *x, void *b, long m, long a, char *s);
 static void wuter_setup(t_wuter *x);
 static float wuter_tick(t_wuter *x);
 
-//noise maker
-static float noise_tick(void);
-static int my_random(int max) ;
-
 /****FUNCTIONS****/
 
 #define WUTR_SOUND_DECAY 0.95
@@ -113,32 +106,34 @@ static void wuter_setup(t_wuter *x)  {
   x->freq =  WUTR_BASE_FREQ * TWO_PI / x->srate;
   x->freq1 = WUTR_BASE_FREQ * 2.0 * TWO_PI / x->srate;
   x->freq2 = WUTR_BASE_FREQ * 3.0 * TWO_PI / x->srate;
-  x->coeffs[0]  = -WUTR_FILT_POLE * 2.0 * cos(x->freq);
+  x->coeffs[0]  = -WUTR_FILT_POLE * 2.0 * Coeff_cos(x->freq);
   x->coeffs[1]  = WUTR_FILT_POLE * WUTR_FILT_POLE;
-  x->coeffs1[0] = -WUTR_FILT_POLE * 2.0 * cos(x->freq1);
+  x->coeffs1[0] = -WUTR_FILT_POLE * 2.0 * Coeff_cos(x->freq1);
   x->coeffs1[1] = WUTR_FILT_POLE * WUTR_FILT_POLE;
-  x->coeffs2[0] = -WUTR_FILT_POLE * 2.0 * cos(x->freq2);
+  x->coeffs2[0] = -WUTR_FILT_POLE * 2.0 * Coeff_cos(x->freq2);
   x->coeffs2[1] = WUTR_FILT_POLE * WUTR_FILT_POLE;
 }
 static float wuter_tick(t_wuter *x) {
   float data;
   int j;
-  if (my_random(32767) < (long)x->num_objects) {     
+  if (Noise_random(&x->noise, 32767) < (long)x->num_objects) {     
     x->sndLevel = x->shakeEnergy;
-    x->pandropL = (float)rand()*RANDNORM;  
+    x->pandropL = Noise_uniform(&x->noise);  
     x->pandropR = 1. - x->pandropL;
-    j = my_random(3);
+    j = Noise_random(&x->noise, 3);
 	  if (j == 0)   {
-      x->freq = x->res_freq * (1. - x->res_spread + (x->res_random * noise_tick()));
-	    x->gain = fabs(noise_tick());
+      x->freq = x->res_freq * (1. - x->res_spread +
+                               (x->res_random * Noise_tick(&x->noise)));
+	    x->gain = fabs(Noise_tick(&x->noise));
 	  }
 	  else if (j == 1)      {
-      x->freq1 = x->res_freq * (1.0 + (x->res_random * noise_tick()));
-	   x->gain1 = fabs(noise_tick());
+      x->freq1 = x->res_freq * (1.0 + (x->res_random * Noise_tick(&x->noise)));
+	   x->gain1 = fabs(Noise_tick(&x->noise));
 	  }
 	  else  {
-      x->freq2 = x->res_freq * (1. + 2.*x->res_spread + (2.*x->res_random * noise_tick()));
-	    x->gain2 = fabs(noise_tick());
+      x->freq2 = x->res_freq * (1. + 2.*x->res_spread +
+                                (2.*x->res_random * Noise_tick(&x->noise)));
+	    x->gain2 = fabs(Noise_tick(&x->noise));
 	  }
 	}
 	
@@ -146,25 +141,25 @@ static float wuter_tick(t_wuter *x) {
   if (x->gain >  0.001) {
     x->freq  *= WUTR_FREQ_SWEEP;
     x->coeffs[0] = -WUTR_FILT_POLE * 2.0 * 
-      cos(x->freq * TWO_PI / x->srate);
+      Coeff_cos(x->freq * TWO_PI / x->srate);
   }
   x->gain1 *= WUTR_FILT_POLE;
   if (x->gain1 > 0.001) {
     x->freq1 *= WUTR_FREQ_SWEEP;
     x->coeffs1[0] = -WUTR_FILT_POLE * 2.0 * 
-      cos(x->freq1 * TWO_PI / x->srate);
+      Coeff_cos(x->freq1 * TWO_PI / x->srate);
   }
   x->gain2 *= WUTR_FILT_POLE;
   if (x->gain2 > 0.001) {
     x->freq2 *= WUTR_FREQ_SWEEP;
     x->coeffs2[0] = -WUTR_FILT_POLE * 2.0 * 
-      cos(x->freq2 * TWO_PI / x->srate);
+      Coeff_cos(x->freq2 * TWO_PI / x->srate);
   }
 	
   x->sndLevel *= x->soundDecay;        // Each (all) event(s) 
   // decay(s) exponentially 
   x->input = x->sndLevel;
-  x->input *= noise_tick();         // Actual Sound is Random
+  x->input *= Noise_tick(&x->noise); // Actual Sound is Random
   x->input1 = x->input * x->gain1;
   x->input2 = x->input * x->gain2;
   x->input *= x->gain;
@@ -192,23 +187,6 @@ static float wuter_tick(t_wuter *x) {
   return data;
 }
 
-static int my_random(int max)  {   //  Return Random Int Between 0 and max
-	unsigned long temp;
-  	temp = (unsigned long) rand();
-	temp *= (unsigned long) max;
-	temp >>= 15;
-	return (int) temp; 
-}
-
-//noise maker
-static float noise_tick(void) 
-{
-	float output;
-	output = (float)rand() - 16384.;
-	output *= ONE_OVER_RANDLIMIT;
-	return output;
-}
-
 #ifdef MSP
 //primary MSP funcs
 void main(void)
@@ -252,6 +230,10 @@ static void wuter_res_freq(t_wuter *x, double f);
 static void wuter_shake_dump(t_wuter *x, double f);
 static void wuter_shake_max(t_wuter *x, double f);
 
+static void wuter_seed(t_wuter *x, t_floatarg f) {
+  Noise_seed(&x->noise, (unsigned int)f);
+}
+
 void wuter_tilde_setup(void)
 {
   wuter_class = class_new(gensym("wuter~"), (t_newmethod)wuter_new, 0,
@@ -263,6 +245,8 @@ void wuter_tilde_setup(void)
   class_addmethod(wuter_class, (t_method)wuter_shake_dump, gensym("shake_dump"), A_FLOAT, 0);
   class_addmethod(wuter_class, (t_method)wuter_shake_max, gensym("shake_max"), A_FLOAT, 0);
   class_addbang(wuter_class, (t_method)wuter_bang);
+  class_addmethod(wuter_class, (t_method)wuter_seed, gensym("seed"), A_FLOAT,
+                  A_NULL);
 }
 
 static void wuter_float(t_wuter *x, double f)
@@ -371,7 +355,7 @@ static void *wuter_new(double initial_coeff)
     
     wuter_setup(x);
     
-    srand(0.54);
+    Noise_init(&x->noise, 0);
     
     return (x);
 }
@@ -447,7 +431,7 @@ static void wuter_dsp(t_wuter *x, t_signal **sp, short *count)
 	x->srate = sp[0]->s_sr;
 	x->one_over_srate = 1./x->srate;
 	
-	dsp_add(wuter_perform, 4, x, sp[0]->s_vec, sp[1]->s_vec, sp[0]->s_n);	
+	Denormals_dspAdd(wuter_perform, 4, x, sp[0]->s_vec, sp[1]->s_vec, sp[0]->s_n);	
 	
 }
 
@@ -15,17 +15,21 @@
 #endif
 #ifdef PD
 #include "m_pd.h"
+#include "genarray.h"
 #endif
 #ifdef NT
 #pragma warning( disable : 4244 )
 #pragma warning( disable : 4305 )
 #endif
 #include <math.h>
+#include <stdio.h>
 
 // maximum number of harmonics specified in a list -- if you make it larger you better 
 // allocated the memory dynamically (right now it's using built-in memory)...
 #define MAXSIZE 64
 #define BUFFER 32768
+// most octaves a mip chain is split into
+#define MIPLEVELS 16
 // maximum size of wavetable -- this memory is allocated with NewPtr()
 #define      PI2    6.2831853 // the big number...
 
@@ -248,6 +252,7 @@ typedef struct gen10
 	float g_args[MAXSIZE];		// array for the harmonic fields
 	float *g_table;				// internal array for the wavetable
 	long g_rescale;				// flag to rescale array
+	t_symbol *g_array;			// array to write the table into, 0 for list output
 } gen10;
 
 /* globalthat holds the class definition */
@@ -255,13 +260,12 @@ static t_class *gen10_class;
 
 // those methods
 
-static void DoTheDo(gen10 *x)
+#ifdef GEN_REFERENCE
+// the reference: sin() for every harmonic at every point...
+static void gen10_sinetable(gen10 *x)
 {
-	register short i,j;
-	t_atom thestuff[2];
-	float wmax, xmax=0.0;
+	register int i,j;
 	
-	// compute the wavetable...
 	for(i = 0; i<x->g_buffsize; i++) x->g_table[i] = 0.0;
 	j=x->g_numharmonics;
 	while(j--) {
@@ -272,6 +276,67 @@ static void DoTheDo(gen10 *x)
 			}
 		}
 	}
+}
+#endif /* GEN_REFERENCE */
+
+// ...and the same sum with no sin() in the loops. harmonic j+1 repeats
+// every g_buffsize/(j+1) points, so its cycle is made RESEED points at a
+// time, by turning a unit vector that is set from cos() and sin() at the
+// start of each piece so it can't drift, and each piece, amplitude and
+// all, is added into every repeat of the cycle. harmonics above top are
+// left out
+#define RESEED 1024
+
+static void gen10_table(gen10 *x, double top)
+{
+	register int i,j,k,n,m;
+	long period, k0;
+	double c, s, cstep, sstep, t;
+	float cycle[RESEED], *dst, amp;
+	
+	for(i = 0; i<x->g_buffsize; i++) x->g_table[i] = 0.0;
+	j=x->g_numharmonics;
+	while(j--) {
+		amp = x->g_args[j];
+		period = x->g_buffsize/(j+1);
+		if(amp == 0.0 || period < 1 || j+1 > top) continue;
+		
+		cstep = cos(PI2/period);
+		sstep = sin(PI2/period);
+		for(k0=0; k0<period; k0+=m) {
+			m = period - k0 < RESEED ? period - k0 : RESEED;
+			c = cos(PI2*k0/period);
+			s = sin(PI2*k0/period);
+			for(k=0; k<m; k++) {
+				cycle[k] = s*amp;
+				t = c*cstep - s*sstep;
+				s = s*cstep + c*sstep;
+				c = t;
+			}
+			for(i=k0; i<x->g_buffsize; i+=period) {
+				n = x->g_buffsize - i < m ? x->g_buffsize - i : m;
+				dst = x->g_table + i;
+				// four at a time, which -O2 turns into one vector add
+				for(k=0; k+4<=n; k+=4) {
+					dst[k] += cycle[k];
+					dst[k+1] += cycle[k+1];
+					dst[k+2] += cycle[k+2];
+					dst[k+3] += cycle[k+3];
+				}
+				for(; k<n; k++) dst[k] += cycle[k];
+			}
+		}
+	}
+}
+
+static void DoTheDo(gen10 *x)
+{
+	register int i,j;
+	t_atom thestuff[2];
+	float wmax, xmax=0.0;
+	
+	// compute the wavetable...
+	gen10_table(x, HUGE_VAL);
 
 if(x->g_rescale) {
 	// rescale the wavetable to go between -1. and 1.
@@ -283,6 +348,13 @@ if(x->g_rescale) {
 	}
 }
 
+	// ...or into the array set with 'set'
+	if (x->g_array) {
+		gen_writearray(x, "gen10", x->g_array, x->g_table, x->g_buffsize,
+			x->g_offset * x->g_buffsize, 0);
+		return;
+	}
+
 	// output the wavetable in index, amplitude pairs...
 	for(i=0;i<x->g_buffsize;i++) {
 		SETFLOAT(thestuff,i+(x->g_offset*x->g_buffsize));
@@ -306,6 +378,44 @@ static void gen10_size(gen10 *x, t_floatarg n)
 
 }
 
+static void gen10_set(gen10 *x, t_symbol *s)
+{
+	gen_set(&x->g_array, s);
+}
+
+// 'mip name': one table per octave into the arrays name-0, name-1, ...
+// for as many of them as there are. level k is for playing the table at
+// up to 2^k times samplerate/size, so it keeps the harmonics up to
+// size/2^(k+1) and nothing folds over nyquist there. all levels are
+// rescaled by the peak of level 0, so they keep their loudness...
+static void gen10_mip(gen10 *x, t_symbol *s)
+{
+	char name[MAXPDSTRING];
+	t_symbol *level;
+	register int j,k;
+	float wmax, xmax=0.0;
+	
+	for(k = 0; k < MIPLEVELS; k++)
+	{
+		if(x->g_buffsize < (2L << k)) break;
+		sprintf(name, "%s-%d", s->s_name, k);
+		if(!pd_findbyclass(level = gensym(name), garray_class)) break;
+		
+		gen10_table(x, x->g_buffsize / (double)(2L << k));
+		if(x->g_rescale)
+		{
+			if(k == 0)
+				for(j = 0; j < x->g_buffsize; j++)
+					if ((wmax = fabs(x->g_table[j])) > xmax) xmax = wmax;
+			if(xmax > 0.0)
+				for(j = 0; j < x->g_buffsize; j++)
+					x->g_table[j] /= xmax;
+		}
+		gen_writearray(x, "gen10", level, x->g_table, x->g_buffsize, 0, 1);
+	}
+	if(k == 0) pd_error(x, "gen10: no array %s-0", s->s_name);
+}
+
 static void gen10_offset(gen10 *x, t_floatarg n)
 {
 	
@@ -342,9 +452,10 @@ void gen10_list(gen10 *x, t_symbol *s, t_int argc, t_atom *argv)
 
 void *gen10_new(t_floatarg n, t_floatarg o)
 {
-	register short c;
+	register int c;
 	
 	gen10 *x = (gen10 *)pd_new(gen10_class);
+	x->g_array = 0;
 	
 	x->g_offset = 0;
 	if (o) {
@@ -404,6 +515,8 @@ void gen10_setup(void)
 	class_addbang(gen10_class, (t_method)gen10_bang); /* put out the same shit */
     class_addmethod(gen10_class, (t_method)gen10_size, gensym("size"), A_FLOAT, 0);	/* change buffer */
     class_addmethod(gen10_class, (t_method)gen10_offset, gensym("offset"), A_FLOAT, 0);	/* change buffer offset */
+	class_addmethod(gen10_class, (t_method)gen10_set, gensym("set"), A_DEFSYM, 0);	/* write into an array */
+	class_addmethod(gen10_class, (t_method)gen10_mip, gensym("mip"), A_SYMBOL, 0);	/* band-limited octaves */
 	class_addmethod(gen10_class, (t_method)gen10_rescale, gensym("rescale"), A_FLOAT, 0);	/* change array rescaling */
 	class_addmethod(gen10_class, (t_method)gen10_list, gensym("list"), A_GIMME, 0);	/* the goods... */
     class_sethelpsymbol(gen10_class, gensym("help-gen10.pd"));
@@ -16,6 +16,7 @@
 #endif
 #ifdef PD
 #include "m_pd.h"
+#include "genarray.h"
 #endif
 #ifdef NT
 #pragma warning( disable : 4244 )
@@ -254,6 +255,7 @@ typedef struct gen17
 	float g_args[MAXSIZE];		// array for the harmonic fields
 	float *g_table;				// internal array for the wavetable
 	long g_rescale;				// flag to rescale array
+	t_symbol *g_array;			// array to write the table into, 0 for list output
 } gen17;
 
 /* globalthat holds the class definition */
@@ -263,7 +265,7 @@ static t_class *gen17_class;
 
 static void DoTheDo(gen17 *x)
 {
-	register short i,j;
+	register int i,j;
 	t_atom thestuff[2];
 	float Tn, Tn1, Tn2, v,d;
 	float wmax, xmax=0.0;
@@ -293,6 +295,13 @@ if(x->g_rescale) {
 	}
 }
 
+	// ...or into the array set with 'set'
+	if (x->g_array) {
+		gen_writearray(x, "gen17", x->g_array, x->g_table, x->g_buffsize,
+			x->g_offset * x->g_buffsize, 0);
+		return;
+	}
+
 	// output the transfer function in index/amplitude pairs...
 	for(i=0;i<x->g_buffsize;i++) {
 		SETFLOAT(thestuff,i+(x->g_offset*x->g_buffsize));
@@ -316,6 +325,11 @@ static void gen17_size(gen17 *x, t_floatarg n)
 
 }
 
+static void gen17_set(gen17 *x, t_symbol *s)
+{
+	gen_set(&x->g_array, s);
+}
+
 static void gen17_offset(gen17 *x, t_floatarg n)
 {
 	
@@ -352,9 +366,10 @@ void gen17_list(gen17 *x, t_symbol *s, t_int argc, t_atom *argv)
 
 void *gen17_new(t_floatarg n, t_floatarg o)
 {
-	register short c;
+	register int c;
 	
 	gen17 *x = (gen17 *)pd_new(gen17_class);
+	x->g_array = 0;
 	
 	x->g_offset = 0;
 	if (o) {
@@ -414,6 +429,7 @@ void gen17_setup(void)
 	class_addbang(gen17_class, (t_method)gen17_bang); /* put out the same shit */
     class_addmethod(gen17_class, (t_method)gen17_size, gensym("size"), A_FLOAT, 0);	/* change buffer */
     class_addmethod(gen17_class, (t_method)gen17_offset, gensym("offset"), A_FLOAT, 0);	/* change buffer offset */
+	class_addmethod(gen17_class, (t_method)gen17_set, gensym("set"), A_DEFSYM, 0);	/* write into an array */
 	class_addmethod(gen17_class, (t_method)gen17_rescale, gensym("rescale"), A_FLOAT, 0);	/* change array rescaling */
 	class_addmethod(gen17_class, (t_method)gen17_list, gensym("list"), A_GIMME, 0);	/* the goods... */
     class_sethelpsymbol(gen17_class, gensym("help-gen17.pd"));
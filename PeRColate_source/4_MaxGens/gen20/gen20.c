@@ -19,6 +19,7 @@
 #endif
 #ifdef PD
 #include "m_pd.h"
+#include "genarray.h"
 #endif
 #ifdef NT
 #pragma warning( disable : 4244 )
@@ -302,6 +303,7 @@ typedef struct gen20
 	t_int g_buffsize;			// size of buffer
 	t_int g_offset;				// offset into output buffer (for list output)
 	t_float *g_table;				// internal array for computing the transfer function
+	t_symbol *g_array;			// array to write the table into, 0 for list output
 } gen20;
 
 
@@ -313,7 +315,7 @@ static t_class *gen20_class;
 
 static void DoTheDo(gen20 *x)
 {
-	register short i,j;
+	register int i,j;
 	int k;
 	t_atom thestuff[2];
 	int N=12;
@@ -415,6 +417,13 @@ switch(x->g_mode) {
 		x->g_table[j] = (x->g_table[j]*2.0)-1.;
 	}
 
+	// ...or into the array set with 'set'
+	if (x->g_array) {
+		gen_writearray(x, "gen20", x->g_array, x->g_table, x->g_buffsize,
+			x->g_offset * x->g_buffsize, 0);
+		return;
+	}
+
 	// output the random series in index/amplitude pairs...
 	for(i=0;i<x->g_buffsize;i++) {
 		SETFLOAT(thestuff,i+(x->g_offset*x->g_buffsize));
@@ -437,6 +446,11 @@ static void gen20_size(gen20 *x, long n)
 	if (x->g_buffsize>BUFFER) x->g_buffsize = BUFFER; // don't go beyond max limit of buffer
 }
 
+static void gen20_set(gen20 *x, t_symbol *s)
+{
+	gen_set(&x->g_array, s);
+}
+
 static void gen20_offset(gen20 *x, long n)
 {
 	x->g_offset = n; // change buffer offset
@@ -466,9 +480,10 @@ static void gen20_int(gen20 *x, t_floatarg mode)
 
 static void *gen20_new(t_floatarg n, t_floatarg o)
 {
-	register short c;
+	register int c;
 	
 	gen20 *x = (gen20 *)pd_new(gen20_class);		// get memory for the object
+	x->g_array = 0;
 
 	x->g_offset = 0;
 	if (o) {
@@ -522,6 +537,7 @@ void gen20_setup(void)
 	class_addfloat(gen20_class, gen20_int);
     class_addmethod(gen20_class, (t_method)gen20_size, gensym("size"), A_FLOAT, 0);	/* change buffer */
     class_addmethod(gen20_class, (t_method)gen20_offset, gensym("offset"), A_FLOAT, 0);	/* change buffer offset */
+	class_addmethod(gen20_class, (t_method)gen20_set, gensym("set"), A_DEFSYM, 0);	/* write into an array */
     class_sethelpsymbol(gen20_class, gensym("help-gen20.pd"));
 }
 #endif /* PD */
@@ -16,6 +16,7 @@
 #endif
 #ifdef PD
 #include "m_pd.h"
+#include "genarray.h"
 #endif
 #ifdef NT
 #pragma warning( disable : 4244 )
@@ -255,6 +256,7 @@ typedef struct gen24
 	float g_args[MAXSIZE];		// array for the harmonic fields
 	float *g_table;				// internal array for the wavetable
 	long g_rescale;				// flag to rescale array
+	t_symbol *g_array;			// array to write the table into, 0 for list output
 } gen24;
 
 /* globalthat holds the class definition */
@@ -264,7 +266,7 @@ static t_class *gen24_class;
 
 static void DoTheDo(gen24 *x)
 {
-	register short i,j,k,l;
+	register int i,j,k,l;
 	t_atom thestuff[2];
 	float scaler, amp2, amp1, wmax, xmax=0.0;
 	
@@ -295,6 +297,13 @@ if(x->g_rescale) {
 	}
 }
 
+	// ...or into the array set with 'set'
+	if (x->g_array) {
+		gen_writearray(x, "gen24", x->g_array, x->g_table, x->g_buffsize,
+			x->g_offset * x->g_buffsize, 0);
+		return;
+	}
+
 	// output the transfer function in index/amplitude pairs...
 	for(i=0;i<x->g_buffsize;i++) {
 		SETFLOAT(thestuff,i+(x->g_offset*x->g_buffsize));
@@ -318,6 +327,11 @@ static void gen24_size(gen24 *x, t_floatarg n)
 
 }
 
+static void gen24_set(gen24 *x, t_symbol *s)
+{
+	gen_set(&x->g_array, s);
+}
+
 static void gen24_offset(gen24 *x, t_floatarg n)
 {
 	
@@ -354,9 +368,10 @@ void gen24_list(gen24 *x, t_symbol *s, t_int argc, t_atom *argv)
 
 void *gen24_new(t_floatarg n, t_floatarg o)
 {
-	register short c;
+	register int c;
 	
 	gen24 *x = (gen24 *)pd_new(gen24_class);
+	x->g_array = 0;
 	
 	x->g_offset = 0;
 	if (o) {
@@ -416,6 +431,7 @@ void gen24_setup(void)
 	class_addbang(gen24_class, (t_method)gen24_bang); /* put out the same shit */
     class_addmethod(gen24_class, (t_method)gen24_size, gensym("size"), A_FLOAT, 0);	/* change buffer */
     class_addmethod(gen24_class, (t_method)gen24_offset, gensym("offset"), A_FLOAT, 0);	/* change buffer offset */
+	class_addmethod(gen24_class, (t_method)gen24_set, gensym("set"), A_DEFSYM, 0);	/* write into an array */
 	class_addmethod(gen24_class, (t_method)gen24_rescale, gensym("rescale"), A_FLOAT, 0);	/* change array rescaling */
 	class_addmethod(gen24_class, (t_method)gen24_list, gensym("list"), A_GIMME, 0);	/* the goods... */
     class_sethelpsymbol(gen24_class, gensym("help-gen24.pd"));
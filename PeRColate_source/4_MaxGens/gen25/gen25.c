@@ -19,6 +19,7 @@
 #endif
 #ifdef PD
 #include "m_pd.h"
+#include "genarray.h"
 #endif
 #ifdef NT
 #pragma warning( disable : 4244 )
@@ -252,6 +253,7 @@ typedef struct gen25
 	t_int g_buffsize;			// size of buffer
 	t_int g_offset;				// offset into output buffer (for list output)
 	t_float *g_table;				// internal array for computing the transfer function
+	t_symbol *g_array;			// array to write the table into, 0 for list output
 } gen25;
 
 
@@ -263,7 +265,7 @@ static t_class *gen25_class;
 
 static void DoTheDo(gen25 *x)
 {
-	register short i, j;
+	register int i, j;
 	t_atom thestuff[2];
 	float wmax, xmax=0.0;
 
@@ -286,6 +288,13 @@ static void DoTheDo(gen25 *x)
 		x->g_table[j] /= xmax;
 	}
 
+	// ...or into the array set with 'set'
+	if (x->g_array) {
+		gen_writearray(x, "gen25", x->g_array, x->g_table, x->g_buffsize,
+			x->g_offset * x->g_buffsize, 0);
+		return;
+	}
+
 	// output the wavetable in index, amplitude pairs...
 	for(i=0;i<x->g_buffsize;i++) {
 		SETFLOAT(thestuff,i+(x->g_offset*x->g_buffsize));
@@ -308,6 +317,11 @@ static void gen25_size(gen25 *x, long n)
 	if (x->g_buffsize>BUFFER) x->g_buffsize = BUFFER; // don't go beyond max limit of buffer
 }
 
+static void gen25_set(gen25 *x, t_symbol *s)
+{
+	gen_set(&x->g_array, s);
+}
+
 static void gen25_offset(gen25 *x, long n)
 {
 	x->g_offset = n; // change buffer offset
@@ -337,9 +351,10 @@ static void gen25_int(gen25 *x, t_floatarg mode)
 
 static void *gen25_new(t_floatarg n, t_floatarg o)
 {
-	register short c;
+	register int c;
 	
 	gen25 *x = (gen25 *)pd_new(gen25_class);		// get memory for the object
+	x->g_array = 0;
 
 	x->g_offset = 0;
 	if (o) {
@@ -393,6 +408,7 @@ void gen25_setup(void)
 	class_addfloat(gen25_class, gen25_int);
     class_addmethod(gen25_class, (t_method)gen25_size, gensym("size"), A_FLOAT, 0);	/* change buffer */
     class_addmethod(gen25_class, (t_method)gen25_offset, gensym("offset"), A_FLOAT, 0);	/* change buffer offset */
+	class_addmethod(gen25_class, (t_method)gen25_set, gensym("set"), A_DEFSYM, 0);	/* write into an array */
     class_sethelpsymbol(gen25_class, gensym("help-gen25.pd"));
 }
 #endif /* PD */
@@ -18,6 +18,7 @@
 #endif
 #ifdef PD
 #include "m_pd.h"
+#include "genarray.h"
 #endif
 #ifdef NT
 #pragma warning( disable : 4244 )
@@ -256,6 +257,7 @@ typedef struct gen5
 	t_float g_args[MAXSIZE];		// array for the harmonic fields
 	t_float *g_table;				// internal array for the wavetable
 	t_int g_rescale;				// flag to rescale array
+	t_symbol *g_array;			// array to write the table into, 0 for list output
 } gen5;
 
 
@@ -265,7 +267,7 @@ static t_class *gen5_class;
 // those methods
 static void DoTheDo(gen5 *x)
 {
-	register short j,k,l;
+	register int j,k,l;
 	t_atom thestuff[2];
 	t_float c, amp2, amp1, wmax, xmax=0.0;
 	t_int i=0;
@@ -295,6 +297,13 @@ static void DoTheDo(gen5 *x)
 		}
 	}
 
+	// ...or into the array set with 'set'
+	if (x->g_array) {
+		gen_writearray(x, "gen5", x->g_array, x->g_table, x->g_buffsize,
+			x->g_offset * x->g_buffsize, 0);
+		return;
+	}
+
 	// output the wavetable in index, amplitude pairs...
 	for(i=0;i<x->g_buffsize;i++) {
 		SETFLOAT(thestuff,i+(x->g_offset*x->g_buffsize));
@@ -318,6 +327,11 @@ static void gen5_size(gen5 *x, t_floatarg n)
 
 }
 
+static void gen5_set(gen5 *x, t_symbol *s)
+{
+	gen_set(&x->g_array, s);
+}
+
 static void gen5_offset(gen5 *x, t_floatarg n)
 {
 	
@@ -352,9 +366,10 @@ static void gen5_list(gen5 *x, t_symbol *s, t_int argc, t_atom *argv)
 
 static void *gen5_new(t_floatarg n, t_floatarg o)
 {
-	register short c;
+	register int c;
 	
 	gen5 *x = (gen5 *)pd_new(gen5_class);		// get memory for the object
+	x->g_array = 0;
 	
 	x->g_offset = 0;
 	if (o) {
@@ -412,6 +427,7 @@ void gen5_setup(void)
 	class_addbang(gen5_class, (t_method)gen5_bang); /* put out the same shit */
     class_addmethod(gen5_class, (t_method)gen5_size, gensym("size"), A_FLOAT, 0);	/* change buffer */
     class_addmethod(gen5_class, (t_method)gen5_offset, gensym("offset"), A_FLOAT, 0);	/* change buffer offset */
+	class_addmethod(gen5_class, (t_method)gen5_set, gensym("set"), A_DEFSYM, 0);	/* write into an array */
 	class_addmethod(gen5_class, (t_method)gen5_rescale, gensym("rescale"), A_FLOAT, 0);	/* change array rescaling */
 	class_addmethod(gen5_class, (t_method)gen5_list, gensym("list"), A_GIMME, 0);	/* the goods... */
     class_sethelpsymbol(gen5_class, gensym("help-gen5.pd"));
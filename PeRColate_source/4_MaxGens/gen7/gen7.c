@@ -15,6 +15,7 @@
 #endif
 #ifdef PD
 #include "m_pd.h"
+#include "genarray.h"
 #endif
 #ifdef NT
 #pragma warning( disable : 4244 )
@@ -253,6 +254,7 @@ typedef struct gen7
 	t_float g_args[MAXSIZE];		// array for the harmonic fields
 	t_float *g_table;				// internal array for the wavetable
 	t_int g_rescale;				// flag to rescale array
+	t_symbol *g_array;			// array to write the table into, 0 for list output
 } gen7;
 
 
@@ -262,7 +264,7 @@ static t_class *gen7_class;
 // those methods
 static void DoTheDo(gen7 *x)
 {
-	register short j,k,l;
+	register int j,k,l;
 	t_atom thestuff[2];
 	t_float scaler, amp2, amp1, wmax, xmax=0.0;
 	t_int i=0;
@@ -290,6 +292,13 @@ static void DoTheDo(gen7 *x)
 		}
 	}
 
+	// ...or into the array set with 'set'
+	if (x->g_array) {
+		gen_writearray(x, "gen7", x->g_array, x->g_table, x->g_buffsize,
+			x->g_offset * x->g_buffsize, 0);
+		return;
+	}
+
 	// output the wavetable in index, amplitude pairs...
 	for(i=0;i<x->g_buffsize;i++) {
 		SETFLOAT(thestuff,i+(x->g_offset*x->g_buffsize));
@@ -313,6 +322,11 @@ static void gen7_size(gen7 *x, t_floatarg n)
 
 }
 
+static void gen7_set(gen7 *x, t_symbol *s)
+{
+	gen_set(&x->g_array, s);
+}
+
 static void gen7_offset(gen7 *x, t_floatarg n)
 {
 	
@@ -347,9 +361,10 @@ static void gen7_list(gen7 *x, t_symbol *s, t_int argc, t_atom *argv)
 
 static void *gen7_new(t_floatarg n, t_floatarg o)
 {
-	register short c;
+	register int c;
 	
 	gen7 *x = (gen7 *)pd_new(gen7_class);		// get memory for the object
+	x->g_array = 0;
 	
 	x->g_offset = 0;
 	if (o) {
@@ -407,6 +422,7 @@ void gen7_setup(void)
 	class_addbang(gen7_class, (t_method)gen7_bang); /* put out the same shit */
     class_addmethod(gen7_class, (t_method)gen7_size, gensym("size"), A_FLOAT, 0);	/* change buffer */
     class_addmethod(gen7_class, (t_method)gen7_offset, gensym("offset"), A_FLOAT, 0);	/* change buffer offset */
+	class_addmethod(gen7_class, (t_method)gen7_set, gensym("set"), A_DEFSYM, 0);	/* write into an array */
 	class_addmethod(gen7_class, (t_method)gen7_rescale, gensym("rescale"), A_FLOAT, 0);	/* change array rescaling */
 	class_addmethod(gen7_class, (t_method)gen7_list, gensym("list"), A_GIMME, 0);	/* the goods... */
     class_sethelpsymbol(gen7_class, gensym("help-gen7.pd"));
@@ -15,17 +15,21 @@
 #endif
 #ifdef PD
 #include "m_pd.h"
+#include "genarray.h"
 #endif
 #ifdef NT
 #pragma warning( disable : 4244 )
 #pragma warning( disable : 4305 )
 #endif
 #include <math.h>
+#include <stdio.h>
 
 // maximum number of p-fields specified in a list -- if you make it larger you better 
 // allocated the memory dynamically (right now it's using built-in memory)...
 #define MAXSIZE 64
 #define BUFFER 32768
+// most octaves a mip chain is split into
+#define MIPLEVELS 16
 // maximum size of wavetable -- this memory is allocated with NewPtr()
 #define      PI2    6.2831853 // the big number...
 
@@ -252,6 +256,7 @@ typedef struct gen9
 	float g_args[MAXSIZE];		// array for the harmonic fields
 	float *g_table;				// internal array for the wavetable
 	long g_rescale;				// flag to rescale array
+	t_symbol *g_array;			// array to write the table into, 0 for list output
 } gen9;
 
 /* globalthat holds the class definition */
@@ -259,14 +264,12 @@ static t_class *gen9_class;
 
 // those methods
 
-static void DoTheDo(gen9 *x)
+#ifdef GEN_REFERENCE
+// the reference: sin() for every partial at every point...
+static void gen9_sinetable(gen9 *x)
 {
-	register short i,j,k,l;
-	t_atom thestuff[2];
-	float scaler, amp2, amp1, wmax, xmax=0.0;
-	double sin(double);
+	register int i,j;
 	
-
 	for(i = 0; i < x->g_buffsize; i++) x->g_table[i] = 0;
 
 	for(j = x->g_numpoints-1; j > 0; j -= 3)
@@ -281,6 +284,70 @@ static void DoTheDo(gen9 *x)
 			}
 		}
 	}
+}
+#endif /* GEN_REFERENCE */
+
+// ...and the same sum with no sin() in the loops. partials needn't be
+// whole numbers, so each one is a unit vector turning by its step; LANES
+// of them, a point apart and each turning LANES steps at a time, keep the
+// loop free of a single long chain. every RESEED points they are set from
+// cos() and sin() again, so they can't drift. partials above top are
+// left out
+#define LANES 8
+#define RESEED 1024
+
+static void gen9_table(gen9 *x, double top)
+{
+	register int i,j,k,l,n;
+	double c[LANES], s[LANES], t[LANES];
+	double step, phase, cstep, sstep;
+	float amp;
+	
+	for(i = 0; i < x->g_buffsize; i++) x->g_table[i] = 0;
+
+	for(j = x->g_numpoints-1; j > 0; j -= 3)
+	{
+		amp = x->g_args[j-1];
+		if(amp == 0 || fabs(x->g_args[j-2]) > top) continue;
+		step = PI2*x->g_args[j-2]/x->g_buffsize;
+		phase = PI2*x->g_args[j]/360.;
+		cstep = cos(LANES*step);
+		sstep = sin(LANES*step);
+		
+		for(i = 0; i < x->g_buffsize; i += n)
+		{
+			n = x->g_buffsize - i < RESEED ? x->g_buffsize - i : RESEED;
+			for(l = 0; l < LANES; l++)
+			{
+				c[l] = cos(step*(i+l) + phase);
+				s[l] = sin(step*(i+l) + phase);
+			}
+			for(k = 0; k + LANES <= n; k += LANES)
+			{
+				for(l = 0; l < LANES; l++)
+				{
+					x->g_table[i+k+l] += (float)(s[l]*amp);
+					t[l] = c[l]*cstep - s[l]*sstep;
+					s[l] = s[l]*cstep + c[l]*sstep;
+					c[l] = t[l];
+				}
+			}
+			for(l = 0; k + l < n; l++)
+				x->g_table[i+k+l] += (float)(s[l]*amp);
+		}
+	}
+}
+
+static void DoTheDo(gen9 *x)
+{
+	register int i,j,k,l;
+	t_atom thestuff[2];
+	float scaler, amp2, amp1, wmax, xmax=0.0;
+	double sin(double);
+	
+
+	// compute the wavetable...
+	gen9_table(x, HUGE_VAL);
 
 	if(x->g_rescale)
 	{
@@ -295,6 +362,13 @@ static void DoTheDo(gen9 *x)
 		}
 	}
 
+	// ...or into the array set with 'set'
+	if (x->g_array) {
+		gen_writearray(x, "gen9", x->g_array, x->g_table, x->g_buffsize,
+			x->g_offset * x->g_buffsize, 0);
+		return;
+	}
+
 	// output the wavetable in index, amplitude pairs...
 	for(i=0;i<x->g_buffsize;i++) {
 		SETFLOAT(thestuff,i+(x->g_offset*x->g_buffsize));
@@ -318,6 +392,44 @@ static void gen9_size(gen9 *x, t_floatarg n)
 
 }
 
+static void gen9_set(gen9 *x, t_symbol *s)
+{
+	gen_set(&x->g_array, s);
+}
+
+// 'mip name': one table per octave into the arrays name-0, name-1, ...
+// for as many of them as there are. level k is for playing the table at
+// up to 2^k times samplerate/size, so it keeps the partials up to
+// size/2^(k+1) and nothing folds over nyquist there. all levels are
+// rescaled by the peak of level 0, so they keep their loudness...
+static void gen9_mip(gen9 *x, t_symbol *s)
+{
+	char name[MAXPDSTRING];
+	t_symbol *level;
+	register int j,k;
+	float wmax, xmax=0.0;
+	
+	for(k = 0; k < MIPLEVELS; k++)
+	{
+		if(x->g_buffsize < (2L << k)) break;
+		sprintf(name, "%s-%d", s->s_name, k);
+		if(!pd_findbyclass(level = gensym(name), garray_class)) break;
+		
+		gen9_table(x, x->g_buffsize / (double)(2L << k));
+		if(x->g_rescale)
+		{
+			if(k == 0)
+				for(j = 0; j < x->g_buffsize; j++)
+					if ((wmax = fabs(x->g_table[j])) > xmax) xmax = wmax;
+			if(xmax > 0.0)
+				for(j = 0; j < x->g_buffsize; j++)
+					x->g_table[j] /= xmax;
+		}
+		gen_writearray(x, "gen9", level, x->g_table, x->g_buffsize, 0, 1);
+	}
+	if(k == 0) pd_error(x, "gen9: no array %s-0", s->s_name);
+}
+
 static void gen9_offset(gen9 *x, t_floatarg n)
 {
 	
@@ -354,9 +466,10 @@ void gen9_list(gen9 *x, t_symbol *s, t_int argc, t_atom *argv)
 
 void *gen9_new(t_floatarg n, t_floatarg o)
 {
-	register short c;
+	register int c;
 	
 	gen9 *x = (gen9 *)pd_new(gen9_class);
+	x->g_array = 0;
 	
 	x->g_offset = 0;
 	if (o) {
@@ -416,6 +529,8 @@ void gen9_setup(void)
 	class_addbang(gen9_class, (t_method)gen9_bang); /* put out the same shit */
     class_addmethod(gen9_class, (t_method)gen9_size, gensym("size"), A_FLOAT, 0);	/* change buffer */
     class_addmethod(gen9_class, (t_method)gen9_offset, gensym("offset"), A_FLOAT, 0);	/* change buffer offset */
+	class_addmethod(gen9_class, (t_method)gen9_set, gensym("set"), A_DEFSYM, 0);	/* write into an array */
+	class_addmethod(gen9_class, (t_method)gen9_mip, gensym("mip"), A_SYMBOL, 0);	/* band-limited octaves */
 	class_addmethod(gen9_class, (t_method)gen9_rescale, gensym("rescale"), A_FLOAT, 0);	/* change array rescaling */
 	class_addmethod(gen9_class, (t_method)gen9_list, gensym("list"), A_GIMME, 0);	/* the goods... */
     class_sethelpsymbol(gen9_class, gensym("help-gen9.pd"));
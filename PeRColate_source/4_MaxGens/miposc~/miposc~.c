@@ -0,0 +1,145 @@
+// miposc~ -- plays the band-limited octaves gen9 and gen10 write with
+// 'mip name' into the arrays name-0, name-1, ...
+//
+// the frequency comes in as a signal. every block it reads the level
+// that is band-limited for the fastest frequency in that block, so the
+// table never folds over nyquist as long as there are levels enough;
+// past the last one the last one is read. linear interpolation.
+//
+// objects and source are provided without warranty of any kind, express or
+// implied.
+//
+
+#include "m_pd.h"
+#include <math.h>
+#include <stdio.h>
+
+// most levels read, as many as the gens write
+#define MIPLEVELS 16
+
+static t_class *miposc_class;
+
+typedef struct _miposc {
+    t_object x_obj;
+    t_float x_f;                   // frequency when no signal is connected
+    t_symbol *x_name;              // the levels are x_name-0, x_name-1, ...
+    t_word *x_vec[MIPLEVELS];      // the levels found
+    int x_nlevels;
+    int x_size;                    // points in every level
+    double x_phase;                // 0 to 1
+    double x_conv;                 // 1 / samplerate
+} t_miposc;
+
+// look up the levels, stopping at the first one missing or of another size
+static void miposc_find(t_miposc *x) {
+    char name[MAXPDSTRING];
+    t_garray *a;
+    t_word *vec;
+    int k, size;
+
+    x->x_nlevels = 0;
+    for (k = 0; k < MIPLEVELS; k++) {
+        sprintf(name, "%s-%d", x->x_name->s_name, k);
+        if (!(a = (t_garray *)pd_findbyclass(gensym(name), garray_class)))
+            break;
+        if (!garray_getfloatwords(a, &size, &vec)) {
+            pd_error(x, "miposc~: bad template for %s", name);
+            break;
+        }
+        if (k == 0)
+            x->x_size = size;
+        else if (size != x->x_size) {
+            pd_error(x, "miposc~: %s is not %d points long", name, x->x_size);
+            break;
+        }
+        garray_usedindsp(a);
+        x->x_vec[x->x_nlevels++] = vec;
+    }
+    if (!x->x_nlevels && *x->x_name->s_name)
+        pd_error(x, "miposc~: no array %s-0", x->x_name->s_name);
+}
+
+static t_int *miposc_perform(t_int *w) {
+    t_miposc *x = (t_miposc *)(w[1]);
+    t_float *in = (t_float *)(w[2]);
+    t_float *out = (t_float *)(w[3]);
+    int n = (int)(w[4]);
+    double phase = x->x_phase, conv = x->x_conv, idx, frac;
+    t_float fmax = 0, f;
+    t_word *tab;
+    int i, j, k, size = x->x_size;
+
+    if (!x->x_nlevels || size < 1) {
+        while (n--)
+            *out++ = 0;
+        return (w + 5);
+    }
+
+    // level k is for up to 2^k times samplerate/size
+    for (i = 0; i < n; i++)
+        if ((f = fabs(in[i])) > fmax)
+            fmax = f;
+    frac = frexp(fmax * size * conv, &k);
+    if (frac == 0.5)
+        k--;
+    if (k < 0)
+        k = 0;
+    if (k >= x->x_nlevels)
+        k = x->x_nlevels - 1;
+    tab = x->x_vec[k];
+
+    // in and out may be the same vector, so the frequency is read first
+    for (i = 0; i < n; i++) {
+        f = in[i];
+        idx = phase * size;
+        j = (int)idx;
+        frac = idx - j;
+        if (j >= size)
+            j = 0;
+        out[i] = tab[j].w_float +
+                 frac * (tab[j + 1 < size ? j + 1 : 0].w_float - tab[j].w_float);
+        phase += f * conv;
+        phase -= floor(phase);
+    }
+    x->x_phase = phase;
+    return (w + 5);
+}
+
+static void miposc_set(t_miposc *x, t_symbol *s) {
+    x->x_name = s;
+    miposc_find(x);
+}
+
+static void miposc_phase(t_miposc *x, t_floatarg f) {
+    x->x_phase = f - floor(f);
+}
+
+static void miposc_dsp(t_miposc *x, t_signal **sp) {
+    x->x_conv = 1. / sp[0]->s_sr;
+    miposc_find(x);
+    dsp_add(miposc_perform, 4, x, sp[0]->s_vec, sp[1]->s_vec, sp[0]->s_n);
+}
+
+static void *miposc_new(t_symbol *s) {
+    t_miposc *x = (t_miposc *)pd_new(miposc_class);
+    x->x_f = 0;
+    x->x_name = s;
+    x->x_nlevels = 0;
+    x->x_size = 0;
+    x->x_phase = 0;
+    x->x_conv = 1. / 44100.;
+    inlet_new(&x->x_obj, &x->x_obj.ob_pd, gensym("float"), gensym("phase"));
+    outlet_new(&x->x_obj, gensym("signal"));
+    return (x);
+}
+
+void miposc_tilde_setup(void) {
+    miposc_class = class_new(gensym("miposc~"), (t_newmethod)miposc_new, 0,
+                             sizeof(t_miposc), 0, A_DEFSYM, 0);
+    CLASS_MAINSIGNALIN(miposc_class, t_miposc, x_f);
+    class_addmethod(miposc_class, (t_method)miposc_dsp, gensym("dsp"), A_NULL);
+    class_addmethod(miposc_class, (t_method)miposc_set, gensym("set"),
+                    A_SYMBOL, 0);
+    class_addmethod(miposc_class, (t_method)miposc_phase, gensym("phase"),
+                    A_FLOAT, 0);
+}
@@ -15,6 +15,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <math.h>
+#include "stk_c.h"
 #define TWOPI 6.283185307
 
 /* ---------------------------- MSP ------------------- */
@@ -160,7 +161,7 @@ static void dcblock_dsp(t_dcblock *x, t_signal **sp)
 	x->srate = sp[0]->s_sr;
 	x->one_over_srate = 1./x->srate;
 
-	dsp_add(dcblock_perform, 4, x, sp[0]->s_vec, sp[1]->s_vec, sp[0]->s_n);	
+	Denormals_dspAdd(dcblock_perform, 4, x, sp[0]->s_vec, sp[1]->s_vec, sp[0]->s_n);	
 }
 
 static void *dcblock_new(void)
@@ -13,7 +13,9 @@
 #include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <math.h>
+#include "stk_c.h"
 #define TWOPI 6.283185307
 #define MAXBANKS 20
 
@@ -609,22 +611,27 @@ typedef struct _gq
 	t_outlet *x_outfloat;
     t_outlet *x_outlist;
     
-    //user controlled vars
-    float x_cf[MAXBANKS];			//centerfreq	
-    float x_bw[MAXBANKS];			//bandwidth
-    float x_bt[MAXBANKS]; 			//boost
-    float x_rf[MAXBANKS]; 			//response freq	
+    //user controlled vars, numbanks of each (see gq_allocbanks)
+    t_float *x_cf;			//centerfreq	
+    t_float *x_bw;			//bandwidth
+    t_float *x_bt; 			//boost
+    t_float *x_rf; 			//response freq	
     
     //filter stuff
-    t_float inputs[2][MAXBANKS], outputs[2][MAXBANKS];
-    t_float inputsL[2][MAXBANKS],  inputsR[2][MAXBANKS];
-    t_float outputsL[2][MAXBANKS], outputsR[2][MAXBANKS];    
-    t_float zeroCoeffs[2][MAXBANKS], poleCoeffs[2][MAXBANKS];
-    t_float x_gn[MAXBANKS];	//gain;
+    t_float *inputs[2];
+    t_float *inputsL[2],  *inputsR[2];
+    t_float *zeroCoeffs[2], *poleCoeffs[2];
+    t_float *x_gn;	//gain;
+    t_float *bankMem;
     
     long currentbank;
     long numbanks;
 	long numchans;
+	short parallel;	//sum the banks instead of running them in series
+	
+	//the input and one bank's output, per channel, for the parallel banks
+	t_float *scratch;
+	long scratchSize;
     
     //response stuff
     void *outfloat;
@@ -632,291 +639,434 @@ typedef struct _gq
     
     //stuff
     float srate, one_over_srate;
-    float cf_save[MAXBANKS], bw_save[MAXBANKS], bt_save[MAXBANKS], rf_save[MAXBANKS];
 } t_gq;
 
 
 //filter funcs
-static t_float returnFreqResponse(t_gq *x, t_float freq)
-{
-	t_float ReTop,  ReBottom,  ImTop,  ImBottom,  w,  response, temp;
-	int i;
-	    
-    w = TWOPI*freq/x->srate;
-    response = 1.;
-    
-    for(i=0;i<x->numbanks;i++) {
-	    if(x->x_bt[i] == 1.) temp = 1.;
-	    else {
-		    ReTop = x->x_gn[i]*cos(2.*w) + x->zeroCoeffs[0][i]*cos(w) + x->zeroCoeffs[1][i];
-		    ReBottom = cos(2.*w) - x->poleCoeffs[0][i]*cos(w) - x->poleCoeffs[1][i];
-		    ImTop = x->x_gn[i]*sin(2.*w) + x->zeroCoeffs[0][i]*sin(w);
-		    ImBottom = sin(2.*w) - x->poleCoeffs[0][i]*sin(w);
+//magnitude response at m (up to GQ_CHUNK) frequencies, given the cos and
+//sin of each; the banks are the outer loop, so the inner one runs over
+//the frequencies
+#define GQ_CHUNK 64
 
-		    temp = pow((pow(ReTop,  2.) + pow(ImTop,  2.)) / (pow(ReBottom,  2.) + pow(ImBottom,  2.)),  0.5);
+static void gq_responsechunk(t_gq *x, int m, const double *c1, const double *s1, t_float *mag)
+{
+	double c2[GQ_CHUNK], s2[GQ_CHUNK];
+	double re[GQ_CHUNK], im[GQ_CHUNK];
+	double ReTop, ReBottom, ImTop, ImBottom, bottom;
+	double gain, z0, z1, p0, p1;
+	int i, k;
+	
+	for(k = 0; k < m; k++) {
+		c2[k] = 2. * c1[k] * c1[k] - 1.;
+		s2[k] = 2. * s1[k] * c1[k];
+		//series: |top|^2 and |bottom|^2, multiplied up over the banks
+		//parallel: 1 + the sum of (H - 1), complex
+		re[k] = 1.;
+		im[k] = x->parallel ? 0. : 1.;
+	}
+	
+	for(i = 0; i < x->numbanks; i++) {
+		if(x->x_bt[i] == 1.) continue;
+		gain = x->x_gn[i];
+		z0 = x->zeroCoeffs[0][i];
+		z1 = x->zeroCoeffs[1][i];
+		p0 = x->poleCoeffs[0][i];
+		p1 = x->poleCoeffs[1][i];
+		for(k = 0; k < m; k++) {
+			ReTop = gain*c2[k] + z0*c1[k] + z1;
+			ReBottom = c2[k] - p0*c1[k] - p1;
+			ImTop = gain*s2[k] + z0*s1[k];
+			ImBottom = s2[k] - p0*s1[k];
+			if(x->parallel) {
+				bottom = ReBottom*ReBottom + ImBottom*ImBottom;
+				re[k] += (ReTop*ReBottom + ImTop*ImBottom) / bottom - 1.;
+				im[k] += (ImTop*ReBottom - ReTop*ImBottom) / bottom;
+			}
+			else {
+				re[k] *= ReTop*ReTop + ImTop*ImTop;
+				im[k] *= ReBottom*ReBottom + ImBottom*ImBottom;
+			}
 		}
-		response *= temp;
 	}
 	
-    return response;
+	for(k = 0; k < m; k++) {
+		if(x->parallel) mag[k] = sqrt(re[k]*re[k] + im[k]*im[k]);
+		else mag[k] = sqrt(re[k] / im[k]);
+	}
+}
+
+//the response at n given frequencies
+static void gq_response(t_gq *x, int n, const t_float *freq, t_float *mag)
+{
+	double c1[GQ_CHUNK], s1[GQ_CHUNK], w;
+	int c, k, m;
+	
+	for(c = 0; c < n; c += m) {
+		m = n - c < GQ_CHUNK ? n - c : GQ_CHUNK;
+		for(k = 0; k < m; k++) {
+			w = TWOPI * freq[c + k] / x->srate;
+			c1[k] = cos(w);
+			s1[k] = sin(w);
+		}
+		gq_responsechunk(x, m, c1, s1, mag + c);
+	}
+}
 
+//the response at n frequencies from f0 to f1, log or linearly spaced.
+//a linear grid turns by the same angle each step, so cos and sin come
+//from a rotation, started afresh from the real thing every chunk
+static void gq_responsegrid(t_gq *x, int n, double f0, double f1, int lin, t_float *mag)
+{
+	double c1[GQ_CHUNK], s1[GQ_CHUNK], w, step, cstep, sstep;
+	int c, k, m;
+	
+	if(n < 2) step = 0.;
+	else if(lin) step = (f1 - f0) / (n - 1);
+	else step = pow(f1 / f0, 1. / (n - 1));
+	cstep = cos(TWOPI * step / x->srate);
+	sstep = sin(TWOPI * step / x->srate);
+	
+	for(c = 0; c < n; c += m) {
+		m = n - c < GQ_CHUNK ? n - c : GQ_CHUNK;
+		if(lin) {
+			w = TWOPI * (f0 + c * step) / x->srate;
+			c1[0] = cos(w);
+			s1[0] = sin(w);
+			for(k = 1; k < m; k++) {
+				c1[k] = c1[k-1] * cstep - s1[k-1] * sstep;
+				s1[k] = s1[k-1] * cstep + c1[k-1] * sstep;
+			}
+		}
+		else {
+			for(k = 0; k < m; k++) {
+				w = TWOPI * f0 * pow(step, c + k) / x->srate;
+				c1[k] = cos(w);
+				s1[k] = sin(w);
+			}
+		}
+		gq_responsechunk(x, m, c1, s1, mag + c);
+	}
 }
 
 static void updateResponse(t_gq *x, double f)
 {
-	t_float response;
-	response = returnFreqResponse(x, f);
+	t_float freq = f, response;
+	gq_response(x, 1, &freq, &response);
 	outlet_float(x->outfloat, response);
 }
 
-static void setFreqBoostBandwidth(t_gq *x, float freq, float boost, float thisBandwidth)
+static void setFreqBoostBandwidth(t_gq *x, long bank, float freq, float boost, float thisBandwidth)
 {
 	float d, a_boost, a_cut, Vzero, true_bw, thisSR;
+	double t;
 	
 	thisSR = x->srate;
 	
-	x->x_cf[x->currentbank] = freq;
-	x->x_bt[x->currentbank] = boost;
-	x->x_bw[x->currentbank] = thisBandwidth;
+	x->x_cf[bank] = freq;
+	x->x_bt[bank] = boost;
+	x->x_bw[bank] = thisBandwidth;
 	true_bw = freq * thisBandwidth;
 	Vzero = boost - 1.;
 	
-	a_boost = (tan(true_bw*TWOPI/(2.*thisSR)) - 1.) / (tan(true_bw*TWOPI/(2.*thisSR)) + 1.);
-    a_cut = (tan(true_bw*TWOPI/(2.*thisSR)) - boost) / (tan(true_bw*TWOPI/(2.*thisSR)) + boost);
-    d = -cos(freq*TWOPI/thisSR); 
+	t = Coeff_tan(true_bw*TWOPI/(2.*thisSR));
+	a_boost = (t - 1.) / (t + 1.);
+    a_cut = (t - boost) / (t + boost);
+    d = -Coeff_cos(freq*TWOPI/thisSR); 
     
 /* cut */
 	if(boost <= 1.0) {
-    	x->x_gn[x->currentbank] 			=  1.0 + (1.0 + a_cut)*Vzero/2.0;
-    	x->zeroCoeffs[0][x->currentbank] 	= d*(1 - a_cut);
-    	x->zeroCoeffs[1][x->currentbank] 	= (-a_cut - (1 + a_cut)*Vzero/2.0);
+    	x->x_gn[bank] 			=  1.0 + (1.0 + a_cut)*Vzero/2.0;
+    	x->zeroCoeffs[0][bank] 	= d*(1 - a_cut);
+    	x->zeroCoeffs[1][bank] 	= (-a_cut - (1 + a_cut)*Vzero/2.0);
 
-    	x->poleCoeffs[0][x->currentbank]	= -d*(1.0 - a_cut);
-    	x->poleCoeffs[1][x->currentbank] 	= a_cut; 
+    	x->poleCoeffs[0][bank]	= -d*(1.0 - a_cut);
+    	x->poleCoeffs[1][bank] 	= a_cut; 
 	} 
 
 /* boost */     
 	if(boost > 1.0) {
-    	x->x_gn[x->currentbank] 			= 1.0 + (1.0 + a_boost)*Vzero/2.0;
-    	x->zeroCoeffs[0][x->currentbank] 	= d*(1 - a_boost);
-    	x->zeroCoeffs[1][x->currentbank] 	= (-a_boost - (1 + a_boost)*Vzero/2.0);
+    	x->x_gn[bank] 			= 1.0 + (1.0 + a_boost)*Vzero/2.0;
+    	x->zeroCoeffs[0][bank] 	= d*(1 - a_boost);
+    	x->zeroCoeffs[1][bank] 	= (-a_boost - (1 + a_boost)*Vzero/2.0);
 
-    	x->poleCoeffs[0][x->currentbank] 	= -d*(1.0 - a_boost);
-    	x->poleCoeffs[1][x->currentbank]	= a_boost; 
+    	x->poleCoeffs[0][bank] 	= -d*(1.0 - a_boost);
+    	x->poleCoeffs[1][bank]	= a_boost; 
 	}	
 }
 
 //primary MSP funcs
-static t_int *gq_performMono(t_int *w)
+//the cascade runs a section at a time over the whole block, feeding each
+//section's output block to the next, so a section's state and coefficients
+//sit in registers for the block. flat sections (boost 1) are skipped.
+//per sample the math is as before:
+//	temp = in + p0*s0 + p1*s1;  out = gain*temp + z0*s0 + z1*s1
+//in parallel, every section gets the input and what each adds to or takes
+//from it is summed: out = in + sum(section(in) - in)
+static void gq_section(t_gq *x, long i, t_float *src, t_float *dst, long n)
 {
-	t_gq *x = (t_gq *)(w[1]);
+	t_float temp, outputs, s0, s1;
+	float gain, p0, p1, z0, z1;
+	int k;
 	
-	t_float *in = (t_float *)(w[2]);
-
-	float cf = x->x_cf[x->currentbank];
-	float bw = x->x_bw[x->currentbank];
-	float bt = x->x_bt[x->currentbank];
-	float rf = x->x_rf[x->currentbank];
+	gain = x->x_gn[i];
+	p0 = x->poleCoeffs[0][i];
+	p1 = x->poleCoeffs[1][i];
+	z0 = x->zeroCoeffs[0][i];
+	z1 = x->zeroCoeffs[1][i];
+	s0 = x->inputs[0][i];
+	s1 = x->inputs[1][i];
 	
-	t_float *out = (t_float *)(w[3]);
-
-	long n = w[4];
+	for(k=0;k<n;k++) {
+		temp = src[k];
+		temp += s0 * p0;
+		temp += s1 * p1;
+		outputs = gain * temp;
+		outputs += s0 * z0;
+		outputs += s1 * z1;
+		s1 = s0;
+		s0 = temp;
+		dst[k] = outputs;
+	}
 	
-	float temp, outputs, outputsSave;
-	float gain[MAXBANKS];
-	float inputs[2][MAXBANKS];
-	float poleCoeffs[2][MAXBANKS];
-	float zeroCoeffs[2][MAXBANKS];
+	x->inputs[0][i] = s0;
+	x->inputs[1][i] = s1;
+}
+
+//the two channels go through a section side by side, two independent
+//recursions in one loop. both inputs are read before either output is
+//written, in case Pd gave dstL the right input's buffer
+static void gq_section2(t_gq *x, long i, t_float *srcL, t_float *srcR,
+	t_float *dstL, t_float *dstR, long n)
+{
+	t_float tempL, tempR, outputsL, outputsR, l0, l1, r0, r1;
+	float gain, p0, p1, z0, z1;
+	int k;
 	
-	float response;
-	int i;
-	long numbanks = x->numbanks;
+	gain = x->x_gn[i];
+	p0 = x->poleCoeffs[0][i];
+	p1 = x->poleCoeffs[1][i];
+	z0 = x->zeroCoeffs[0][i];
+	z1 = x->zeroCoeffs[1][i];
+	l0 = x->inputsL[0][i];
+	l1 = x->inputsL[1][i];
+	r0 = x->inputsR[0][i];
+	r1 = x->inputsR[1][i];
 	
-	for(i=0;i<numbanks;i++) {
-		inputs[0][i] 	= x->inputs[0][i];
-		inputs[1][i] 	= x->inputs[1][i];
-		gain[i] 		= x->x_gn[i];
-		
-		poleCoeffs[0][i] = x->poleCoeffs[0][i];
-		poleCoeffs[1][i] = x->poleCoeffs[1][i];
-		zeroCoeffs[0][i] = x->zeroCoeffs[0][i];
-		zeroCoeffs[1][i] = x->zeroCoeffs[1][i];
+	for(k=0;k<n;k++) {
+		tempL = srcL[k];
+		tempR = srcR[k];
+		tempL += l0 * p0;
+		tempR += r0 * p0;
+		tempL += l1 * p1;
+		tempR += r1 * p1;
+		outputsL = gain * tempL;
+		outputsR = gain * tempR;
+		outputsL += l0 * z0;
+		outputsR += r0 * z0;
+		outputsL += l1 * z1;
+		outputsR += r1 * z1;
+		l1 = l0;
+		r1 = r0;
+		l0 = tempL;
+		r0 = tempR;
+		dstL[k] = outputsL;
+		dstR[k] = outputsR;
 	}
 	
-	if(x->cf_save[x->currentbank] != cf) {
-		x->cf_save[x->currentbank] = cf;
-		setFreqBoostBandwidth(x, cf, bt, bw);
-	}
+	x->inputsL[0][i] = l0;
+	x->inputsL[1][i] = l1;
+	x->inputsR[0][i] = r0;
+	x->inputsR[1][i] = r1;
+}
+
+static t_int *gq_performMono(t_int *w)
+{
+	t_gq *x = (t_gq *)(w[1]);
+	t_float *in = (t_float *)(w[2]);
+	t_float *out = (t_float *)(w[3]);
+	long n = w[4];
 	
-	if(x->bw_save[x->currentbank] != bw) {
-		x->bw_save[x->currentbank] = bw;
-		setFreqBoostBandwidth(x, cf, bt, bw);
-	}
+	t_float *src = in, *dry = x->scratch, *wet = x->scratch + n;
+	int i, k;
 	
-	if(x->bt_save[x->currentbank] != bt) {
-		x->bt_save[x->currentbank] = bt;
-		setFreqBoostBandwidth(x, cf, bt, bw);
+	if(x->parallel) {
+		for(k=0;k<n;k++) dry[k] = in[k];
+		for(k=0;k<n;k++) out[k] = dry[k];
 	}
-
-	while(n--) {
-		
-	    outputsSave = *in++; 
-		    
-		//run the filters in series
-		for(i=0;i<numbanks;i++) { 
-		
-			temp = outputsSave;			//feed output of last filter in to next filter     
-			            
-																/* Here's the math for the  */
-		    temp += inputs[0][i] * poleCoeffs[0][i];          	/* version which implements */
-		    temp += inputs[1][i] * poleCoeffs[1][i];          	/* only 2 state variables.  */
-		    
-		    outputs = gain[i] * temp;                   		/* This form takes          */
-		    outputs += (inputs[0][i] * zeroCoeffs[0][i]); 		/* 5 multiplies and         */
-		    outputs += (inputs[1][i] * zeroCoeffs[1][i]);  		/* 4 adds                   */
-		    inputs[1][i] = inputs[0][i];                      	/* and 3 moves              */
-		    inputs[0][i] = temp;                           		/* too!!!                   */
-		    
-		    outputsSave = outputs;
-		    
+	
+	for(i=0;i<x->numbanks;i++) {
+		if(x->x_bt[i] == 1.) {
+			x->inputs[0][i] = x->inputs[1][i] = 0.;
+			continue;
+		}
+		if(x->parallel) {
+			gq_section(x, i, dry, wet, n);
+			for(k=0;k<n;k++) out[k] += wet[k] - dry[k];
+		}
+		else {
+			gq_section(x, i, src, out, n);
+			src = out;
 		}
-
-	    *out++ = outputsSave;
-	}
-	for(i=0;i<numbanks;i++) {
-		x->inputs[0][i] = inputs[0][i];
-		x->inputs[1][i] = inputs[1][i];
 	}
+	
+	if(src != out && !x->parallel)
+		for(k=0;k<n;k++) out[k] = src[k];
 	return w + 5;
 }	
 
 static t_int *gq_performStereo(t_int *w)
 {
 	t_gq *x = (t_gq *)(w[1]);
-	
 	t_float *inL = (t_float *)(w[2]);
 	t_float *inR = (t_float *)(w[3]);
-
-	float cf = x->x_cf[x->currentbank];
-	float bw = x->x_bw[x->currentbank];
-	float bt = x->x_bt[x->currentbank];
-	float rf = x->x_rf[x->currentbank];
-	
 	t_float *outL = (t_float *)(w[4]); 
 	t_float *outR = (t_float *)(w[5]); 
-	
-	float response;
-	
 	long n = w[6];
-	int i;
-	int numbanks = x->numbanks;
-	
-	t_float temp, outputs, outputsLsave, outputsRsave;
-	float gain[MAXBANKS];
-	t_float inputsL[2][MAXBANKS], inputsR[2][MAXBANKS];
-	float poleCoeffs[2][MAXBANKS];
-	float zeroCoeffs[2][MAXBANKS];
 	
-	for (i=0;i<numbanks;i++){
-		inputsL[0][i] = x->inputsL[0][i];
-		inputsL[1][i] = x->inputsL[1][i];
-		inputsR[0][i] = x->inputsR[0][i];
-		inputsR[1][i] = x->inputsR[1][i];
-		
-		poleCoeffs[0][i] = x->poleCoeffs[0][i];
-		poleCoeffs[1][i] = x->poleCoeffs[1][i];
-		zeroCoeffs[0][i] = x->zeroCoeffs[0][i];
-		zeroCoeffs[1][i] = x->zeroCoeffs[1][i];
-		gain[i] = x->x_gn[i];
+	t_float *srcL = inL, *srcR = inR;
+	t_float *dryL = x->scratch, *dryR = x->scratch + n;
+	t_float *wetL = x->scratch + 2*n, *wetR = x->scratch + 3*n;
+	t_float tempL, tempR;
+	int i, k;
 	
-	}
-		
-	if(x->cf_save[x->currentbank] != cf) {
-		x->cf_save[x->currentbank] = cf;
-		setFreqBoostBandwidth(x, cf, bt, bw);
+	if(x->parallel) {
+		for(k=0;k<n;k++) {
+			dryL[k] = inL[k];
+			dryR[k] = inR[k];
+		}
+		for(k=0;k<n;k++) {
+			outL[k] = dryL[k];
+			outR[k] = dryR[k];
+		}
 	}
 	
-	if(x->bw_save[x->currentbank] != bw) {
-		x->bw_save[x->currentbank] = bw;
-		setFreqBoostBandwidth(x, cf, bt, bw);
+	for(i=0;i<x->numbanks;i++) {
+		if(x->x_bt[i] == 1.) {
+			x->inputsL[0][i] = x->inputsL[1][i] = 0.;
+			x->inputsR[0][i] = x->inputsR[1][i] = 0.;
+			continue;
+		}
+		if(x->parallel) {
+			gq_section2(x, i, dryL, dryR, wetL, wetR, n);
+			for(k=0;k<n;k++) {
+				outL[k] += wetL[k] - dryL[k];
+				outR[k] += wetR[k] - dryR[k];
+			}
+		}
+		else {
+			gq_section2(x, i, srcL, srcR, outL, outR, n);
+			srcL = outL;
+			srcR = outR;
+		}
 	}
 	
-	if(x->bt_save[x->currentbank] != bt) {
-		x->bt_save[x->currentbank] = bt;
-		setFreqBoostBandwidth(x, cf, bt, bw);
-	}
-
-	while(n--) {
-			    
-	    //left channel
-	    outputsLsave = *inL++;                       			  
-	    for(i=0;i<numbanks;i++) {
-	    
-	    	temp = outputsLsave;
-	    														/* Here's the math for the  */
-		    temp += inputsL[0][i] * poleCoeffs[0][i];         	/* version which implements */
-		    temp += inputsL[1][i] * poleCoeffs[1][i];         	/* only 2 state variables.  */
-		    
-		    outputs = gain[i] * temp;                   		/* This form takes          */
-		    outputs += (inputsL[0][i] * zeroCoeffs[0][i]);  	/* 5 multiplies and         */
-		    outputs += (inputsL[1][i] * zeroCoeffs[1][i]);  	/* 4 adds                   */
-		    inputsL[1][i] = inputsL[0][i];                      /* and 3 moves              */
-		    inputsL[0][i] = temp;                           	/* too!!!                   */
-		    
-		    outputsLsave = outputs;
-	    }
-	    
-	    //right channel
-        outputsRsave = *inR++;          											
-	    for(i=0;i<numbanks;i++) {
-	    
-	    	temp = outputsRsave;
-	    														/* Here's the math for the  */
-		    temp += inputsR[0][i] * poleCoeffs[0][i];         	/* version which implements */
-		    temp += inputsR[1][i] * poleCoeffs[1][i];         	/* only 2 state variables.  */
-		    
-		    outputs = gain[i] * temp;                   		/* This form takes          */
-		    outputs += (inputsR[0][i] * zeroCoeffs[0][i]);  	/* 5 multiplies and         */
-		    outputs += (inputsR[1][i] * zeroCoeffs[1][i]);  	/* 4 adds                   */
-		    inputsR[1][i] = inputsR[0][i];                      /* and 3 moves              */
-		    inputsR[0][i] = temp;                           	/* too!!!                   */
-		    
-		    outputsRsave = outputs;
+	if(srcL != outL && !x->parallel) {
+		for(k=0;k<n;k++) {
+			tempL = srcL[k];
+			tempR = srcR[k];
+			outL[k] = tempL;
+			outR[k] = tempR;
 		}
-
-	    //outputs
-	    *outL++ = outputsLsave;
-	    *outR++ = outputsRsave;
-	}
-
-	for(i=0;i<numbanks;i++){
-		x->inputsL[0][i] = inputsL[0][i];
-		x->inputsL[1][i] = inputsL[1][i];
-		x->inputsR[0][i] = inputsR[0][i];
-		x->inputsR[1][i] = inputsR[1][i];
 	}
-	
 	return w + 7;
 }	
 
 static void gq_dsp(t_gq *x, t_signal **sp)
 {
-	x->srate = sp[0]->s_sr;
-    x->one_over_srate = 1./x->srate;
+	long i;
+	
+	//the coefficients depend on the sample rate
+	if(x->srate != sp[0]->s_sr) {
+		x->srate = sp[0]->s_sr;
+	    x->one_over_srate = 1./x->srate;
+		for(i=0;i<x->numbanks;i++)
+			setFreqBoostBandwidth(x, i, x->x_cf[i], x->x_bt[i], x->x_bw[i]);
+	}
+	
+	if(x->scratchSize != 4 * sp[0]->s_n) {
+		x->scratch = (t_float *)t_resizebytes(x->scratch, x->scratchSize * sizeof(t_float),
+			4 * sp[0]->s_n * sizeof(t_float));
+		x->scratchSize = 4 * sp[0]->s_n;
+	}
 
 	/* can we check how many signal inlets are in use ? */
 	/* stereo */
 	if(2>1)
 	{
-		dsp_add(gq_performStereo, 6, x, sp[0]->s_vec, sp[1]->s_vec, sp[2]->s_vec, sp[3]->s_vec, sp[0]->s_n);	
+		Denormals_dspAdd(gq_performStereo, 6, x, sp[0]->s_vec, sp[1]->s_vec, sp[2]->s_vec, sp[3]->s_vec, sp[0]->s_n);	
 	}
 	else /* mono */
 	{
-		dsp_add(gq_performMono, 4, x, sp[0]->s_vec, sp[2]->s_vec, sp[0]->s_n);
+		Denormals_dspAdd(gq_performMono, 4, x, sp[0]->s_vec, sp[2]->s_vec, sp[0]->s_n);
 	}
 }
 
 
+//the bank arrays, numbanks floats each, all in bankMem
+#define GQ_NFIELDS 15
+
+static void gq_fields(t_gq *x, t_float ***fields)
+{
+	fields[0] = &x->x_cf;
+	fields[1] = &x->x_bw;
+	fields[2] = &x->x_bt;
+	fields[3] = &x->x_rf;
+	fields[4] = &x->x_gn;
+	fields[5] = &x->inputs[0];
+	fields[6] = &x->inputs[1];
+	fields[7] = &x->inputsL[0];
+	fields[8] = &x->inputsL[1];
+	fields[9] = &x->inputsR[0];
+	fields[10] = &x->inputsR[1];
+	fields[11] = &x->zeroCoeffs[0];
+	fields[12] = &x->zeroCoeffs[1];
+	fields[13] = &x->poleCoeffs[0];
+	fields[14] = &x->poleCoeffs[1];
+}
+
+static void gq_initbank(t_gq *x, long i)
+{
+	x->x_cf[i] = 440.;			//centerfreq	
+	x->x_bw[i] = 0.1;			//bandwidth
+	x->x_bt[i] = 1.;			//boost
+	x->x_rf[i] = 440.; 			//response freq	
+	
+	x->inputsL[0][i] = 0.;
+	x->inputsL[1][i] = 0.;
+	x->inputsR[0][i] = 0.;
+	x->inputsR[1][i] = 0.;
+	
+	x->inputs[0][i] = 0.;
+	x->inputs[1][i] = 0.;
+	
+	setFreqBoostBandwidth(x, i, x->x_cf[i], x->x_bt[i], x->x_bw[i]);
+}
+
+//(re)sizes the banks to n. the ones that stay keep their settings and
+//state, new ones are flat
+static int gq_allocbanks(t_gq *x, long n)
+{
+	t_float **fields[GQ_NFIELDS];
+	t_float *mem;
+	long keep = x->numbanks < n ? x->numbanks : n, i;
+	int j;
+	
+	mem = (t_float *)t_getbytes(GQ_NFIELDS * n * sizeof(t_float));
+	if(!mem) return 0;
+	gq_fields(x, fields);
+	for(j = 0; j < GQ_NFIELDS; j++) {
+		if(keep) memcpy(mem + j * n, *fields[j], keep * sizeof(t_float));
+		*fields[j] = mem + j * n;
+	}
+	if(x->bankMem) t_freebytes(x->bankMem, GQ_NFIELDS * x->numbanks * sizeof(t_float));
+	x->bankMem = mem;
+	x->numbanks = n;
+	
+	for(i = keep; i < n; i++) gq_initbank(x, i);
+	if(x->currentbank >= n) x->currentbank = n - 1;
+	return 1;
+}
+
 void gq_setbank(t_gq *x, t_floatarg bank)
 {
 	int temp, i;
@@ -925,7 +1075,7 @@ void gq_setbank(t_gq *x, t_floatarg bank)
 
 	temp = bank;
 	if(temp < 0) temp = 0;
-	if(temp > x->numbanks) temp = x->numbanks;
+	if(temp >= x->numbanks) temp = x->numbanks - 1;
 	x->currentbank = temp;
     //post("gq: using bank %d ", x->currentbank);
 
@@ -943,62 +1093,21 @@ void gq_setbank(t_gq *x, t_floatarg bank)
 	post("gQ: bank %d: bandwidth %f", x->currentbank, banksettings[1]);
 	post("gQ: bank %d: boost %f", x->currentbank, banksettings[2]);
 }
-/* 
-void gq_updatebank(t_gq *x, t_symbol *s, t_int argc, t_atom* argv)
+//updatebank bank cf bw mult [bank cf bw mult ...], any number of banks at once
+void gq_updatebank(t_gq *x, t_symbol *s, int argc, t_atom *argv)
 {
-	t_int bank, banksave;
-	t_float cf, bw, mult;
+	long bank;
 	
-	if(argc<4) post("gQ: need 'bank cf bw mult' to setbank");
+	if(argc < 4 || argc % 4) post("gQ: need 'bank cf bw mult' to updatebank");
 	
-	switch (argv[0].a_type) {
-		case A_FLOAT:
-			bank = (t_int)argv[0].a_w.w_float;
-			break;
-	}
-	switch (argv[1].a_type) {
-		case A_FLOAT:
-			cf = argv[1].a_w.w_float;
-			break;
+	for(; argc >= 4; argc -= 4, argv += 4) {
+		bank = atom_getfloatarg(0, argc, argv);
+		if(bank >= 0 && bank < x->numbanks)
+			setFreqBoostBandwidth(x, bank, atom_getfloatarg(1, argc, argv),
+				atom_getfloatarg(3, argc, argv), atom_getfloatarg(2, argc, argv));
+		else
+			post("gQ: not a valid bank number");
 	}
-	switch (argv[2].a_type) {
-		case A_FLOAT:
-			bw = argv[2].a_w.w_float;
-			break;
-	}
-	switch (argv[3].a_type) {
-		case A_FLOAT:
-			mult = argv[3].a_w.w_float;
-			break;
-	}
-
-	if (bank < MAXBANKS) {
-		banksave = x->currentbank;
-		x->currentbank = bank;
-		setFreqBoostBandwidth(x, cf, mult, bw);
-		x->currentbank = banksave;
-		
-	} else
-		post("gQ: not a valid bank number");
-	
-} */
-
-void gq_updatebank(t_gq *x, t_floatarg bank, t_floatarg cf, t_floatarg bw, t_floatarg mult)
-{
-	t_int banksave;
-	
-	// post("gQ: need 'bank cf bw mult' to setbank");
-	
-
-	if (bank < MAXBANKS) {
-		banksave = x->currentbank;
-		x->currentbank = bank;
-		setFreqBoostBandwidth(x, cf, mult, bw);
-		x->currentbank = banksave;
-		
-	} else
-		post("gQ: not a valid bank number");
-	
 }
 
 void gq_clear(t_gq *x)
@@ -1006,7 +1115,7 @@ void gq_clear(t_gq *x)
 	int i;
 	post("gQ: clearing delay lines");
 	
-	for(i=0;i<MAXBANKS;i++) {
+	for(i=0;i<x->numbanks;i++) {
 	    
 	    x->inputsL[0][i] = 0.;
 		x->inputsL[1][i] = 0.;
@@ -1024,50 +1133,40 @@ void gq_clearsettings(t_gq *x)
 	int i;
 	post("gQ: clearing settings and delay lines");
 	
-	for(i=0;i<MAXBANKS;i++) {
-	    x->x_cf[i] = 440.;			//centerfreq	
-	    x->x_bw[i] = 0.1;			//bandwidth
-	    x->x_bt[i] = 1.;			//boost
-	    x->x_rf[i] = 440.; 			//response freq	
-	    
-	    x->cf_save[i] = 232.;
-	    x->bw_save[i] = .13;
-	    x->bt_save[i] = 1.;
-	    x->rf_save[i] = 223.;
-	    
-	    x->inputsL[0][i] = 0.;
-		x->inputsL[1][i] = 0.;
-		x->inputsR[0][i] = 0.;
-		x->inputsR[1][i] = 0.;
-		
-		x->inputs[0][i] = 0.;
-		x->inputs[1][i] = 0.;
-		
-		x->poleCoeffs[0][i] = 0.;
-		x->poleCoeffs[1][i] = 0.;
-		x->zeroCoeffs[0][i] = 0.;
-		x->zeroCoeffs[1][i] = 0.;
-		
-		x->x_gn[i] = 1.;
-		
-		setFreqBoostBandwidth(x, x->x_cf[i], x->x_bt[i], x->x_bw[i]);
-	}
+	for(i=0;i<x->numbanks;i++) gq_initbank(x, i);
 }
 
-static void gq_float(t_gq *x, t_floatarg f)
+static void gq_banks(t_gq *x, t_floatarg f)
 {
-	x->x_cf[x->currentbank] = f;
+	long n = f;
+	
+	if(n < 1) n = 1;
+	if(!gq_allocbanks(x, n)) pd_error(x, "gQ: out of memory for %ld banks", n);
+	else post("gQ: using %d banks", (int)x->numbanks);
+}
 
+static void gq_parallel(t_gq *x, t_floatarg f)
+{
+	x->parallel = (f != 0.);
+}
+
+//the coefficients are worked out here, not in the perform routines
+static void gq_float(t_gq *x, t_floatarg f)
+{
+	long i = x->currentbank;
+	setFreqBoostBandwidth(x, i, f, x->x_bt[i], x->x_bw[i]);
 }
 
 static void gq_bw(t_gq *x, t_floatarg f)
 {
-	x->x_bw[x->currentbank] = f;
+	long i = x->currentbank;
+	setFreqBoostBandwidth(x, i, x->x_cf[i], x->x_bt[i], f);
 }
 
 static void gq_bt(t_gq *x, t_floatarg f)
 {
-	x->x_bt[x->currentbank] = f;
+	long i = x->currentbank;
+	setFreqBoostBandwidth(x, i, x->x_cf[i], f, x->x_bw[i]);
 }
 
 static void gq_rf(t_gq *x, t_floatarg f)
@@ -1076,6 +1175,71 @@ static void gq_rf(t_gq *x, t_floatarg f)
 	updateResponse(x, f);
 }
 
+//response f1 f2 ...: the response at each of them, as a list
+static void gq_responselist(t_gq *x, t_symbol *s, int argc, t_atom *argv)
+{
+	t_float *freq, *mag;
+	t_atom *out;
+	int i;
+	
+	if(argc < 1) return;
+	freq = (t_float *)t_getbytes(2 * argc * sizeof(t_float));
+	out = (t_atom *)t_getbytes(argc * sizeof(t_atom));
+	mag = freq + argc;
+	for(i = 0; i < argc; i++) freq[i] = atom_getfloatarg(i, argc, argv);
+	gq_response(x, argc, freq, mag);
+	for(i = 0; i < argc; i++) SETFLOAT(out + i, mag[i]);
+	outlet_list(x->outfloat, 0L, argc, out);
+	t_freebytes(out, argc * sizeof(t_atom));
+	t_freebytes(freq, 2 * argc * sizeof(t_float));
+}
+
+//plot array [f0 f1] [lin]: the response across the array, one frequency
+//per point, log spaced from f0 (20 Hz) to f1 (20 kHz, at most Nyquist).
+//lin may come anywhere after the array; the first two floats are f0, f1
+static void gq_plot(t_gq *x, t_symbol *s, int argc, t_atom *argv)
+{
+	t_symbol *name = atom_getsymbolarg(0, argc, argv);
+	t_garray *a;
+	t_word *vec;
+	t_float *mag;
+	double f0 = 20., f1 = 20000.;
+	int lin = 0, nf = 0, n, i;
+	
+	for(i = 1; i < argc; i++) {
+		if(argv[i].a_type == A_SYMBOL && argv[i].a_w.w_symbol == gensym("lin")) lin = 1;
+		else if(argv[i].a_type == A_FLOAT && nf < 2) {
+			if(nf++ == 0) f0 = argv[i].a_w.w_float;
+			else f1 = argv[i].a_w.w_float;
+		}
+	}
+	if(f1 > .5 * x->srate) f1 = .5 * x->srate;
+	if(f0 < 1.) f0 = 1.;
+	if(f1 < f0) f1 = f0;
+	
+	if(!(a = (t_garray *)pd_findbyclass(name, garray_class))) {
+		pd_error(x, "gQ: no array %s", name->s_name);
+		return;
+	}
+	if(!garray_getfloatwords(a, &n, &vec)) {
+		pd_error(x, "gQ: bad template for %s", name->s_name);
+		return;
+	}
+	if(n < 1) return;
+	
+	mag = (t_float *)t_getbytes(n * sizeof(t_float));
+	gq_responsegrid(x, n, f0, f1, lin, mag);
+	for(i = 0; i < n; i++) vec[i].w_float = mag[i];
+	t_freebytes(mag, n * sizeof(t_float));
+	garray_redraw(a);
+}
+
+static void gq_free(t_gq *x)
+{
+	if(x->bankMem) t_freebytes(x->bankMem, GQ_NFIELDS * x->numbanks * sizeof(t_float));
+	if(x->scratch) t_freebytes(x->scratch, x->scratchSize * sizeof(t_float));
+}
+
 
 static void *gq_new(t_floatarg banks, t_floatarg initial_coeff)
 {
@@ -1103,64 +1267,40 @@ static void *gq_new(t_floatarg banks, t_floatarg initial_coeff)
     x->srate = sys_getsr();
     x->one_over_srate = 1./x->srate;
     
-    x->numbanks = banks;
 	x->numchans = initial_coeff;
     post("gQ: initial coeff =  %f banks", initial_coeff);
-    if(x->numbanks < 1)
+    x->currentbank = 0;
+    x->numbanks = 0;
+	if(banks < 1)
 	{
-		x->numbanks = 1;
-		post("gQ: number of banks set to %d", (int)x->numbanks);
+		banks = 1;
+		post("gQ: number of banks set to %d", (int)banks);
 	}
-	else
+	if(!gq_allocbanks(x, banks))
 	{
-		post("gQ: using %d banks", (int)x->numbanks);
+		pd_error(x, "gQ: out of memory for %d banks", (int)banks);
+		return (0);
 	}
-    x->currentbank = 0;
-    
-    for(i=0;i<MAXBANKS;i++) {
-	    x->x_cf[i] = 440.;			//centerfreq	
-	    x->x_bw[i] = 0.1;			//bandwidth
-	    x->x_bt[i] = 1.;			//boost
-	    x->x_rf[i] = 440.; 			//response freq	
-	    
-	    x->cf_save[i] = 232.;
-	    x->bw_save[i] = .13;
-	    x->bt_save[i] = 1.;
-	    x->rf_save[i] = 223.;
-	    
-	    x->inputsL[0][i] = 0.;
-		x->inputsL[1][i] = 0.;
-		x->inputsR[0][i] = 0.;
-		x->inputsR[1][i] = 0.;
-		
-		x->inputs[0][i] = 0.;
-		x->inputs[1][i] = 0.;
-		
-		x->poleCoeffs[0][i] = 0.;
-		x->poleCoeffs[1][i] = 0.;
-		x->zeroCoeffs[0][i] = 0.;
-		x->zeroCoeffs[1][i] = 0.;
-		
-		x->x_gn[i] = 1.;
-		
-		setFreqBoostBandwidth(x, x->x_cf[i], x->x_bt[i], x->x_bw[i]);
-	}
-    
+	post("gQ: using %d banks", (int)x->numbanks);
 
     return (x);
 }
 
 void gQ_tilde_setup(void)
 {
-    gq_class = class_new(gensym("gQ~"), (t_newmethod)gq_new, 0,
+    gq_class = class_new(gensym("gQ~"), (t_newmethod)gq_new, (t_method)gq_free,
         sizeof(t_gq), 0, A_DEFFLOAT, A_DEFFLOAT, 0);
     class_addmethod(gq_class, nullfn, gensym("signal"), A_NULL);
     class_addmethod(gq_class, (t_method)gq_dsp, gensym("dsp"), A_NULL);
 	class_addfloat(gq_class, (t_method)gq_float);
     class_addmethod(gq_class, (t_method)gq_clear, gensym("clear"), A_NULL);
     class_addmethod(gq_class, (t_method)gq_clearsettings, gensym("clearsettings"), A_NULL);
-    class_addmethod(gq_class, (t_method)gq_updatebank, gensym("updatebank"), A_FLOAT, A_NULL);
+    class_addmethod(gq_class, (t_method)gq_updatebank, gensym("updatebank"), A_GIMME, A_NULL);
     class_addmethod(gq_class, (t_method)gq_setbank, gensym("setbank"), A_FLOAT, A_NULL);
+    class_addmethod(gq_class, (t_method)gq_banks, gensym("banks"), A_FLOAT, A_NULL);
+    class_addmethod(gq_class, (t_method)gq_parallel, gensym("parallel"), A_FLOAT, A_NULL);
+    class_addmethod(gq_class, (t_method)gq_responselist, gensym("response"), A_GIMME, A_NULL);
+    class_addmethod(gq_class, (t_method)gq_plot, gensym("plot"), A_GIMME, A_NULL);
 
     class_addmethod(gq_class, (t_method)gq_bw, gensym("bw"), A_FLOAT, A_NULL);
     class_addmethod(gq_class, (t_method)gq_bt, gensym("bt"), A_FLOAT, A_NULL);
@@ -1170,15 +1310,19 @@ void gQ_tilde_setup(void)
 
 void gq_tilde_setup(void)
 {
-    gq_class = class_new(gensym("gq~"), (t_newmethod)gq_new, 0,
+    gq_class = class_new(gensym("gq~"), (t_newmethod)gq_new, (t_method)gq_free,
         sizeof(t_gq), 0, A_DEFFLOAT, A_DEFFLOAT, 0);
     class_addmethod(gq_class, nullfn, gensym("signal"), A_NULL);
     class_addmethod(gq_class, (t_method)gq_dsp, gensym("dsp"), A_NULL);
 	class_addfloat(gq_class, (t_method)gq_float);
     class_addmethod(gq_class, (t_method)gq_clear, gensym("clear"), A_NULL);
     class_addmethod(gq_class, (t_method)gq_clearsettings, gensym("clearsettings"), A_NULL);
-    class_addmethod(gq_class, (t_method)gq_updatebank, gensym("updatebank"), A_FLOAT, A_NULL);
+    class_addmethod(gq_class, (t_method)gq_updatebank, gensym("updatebank"), A_GIMME, A_NULL);
     class_addmethod(gq_class, (t_method)gq_setbank, gensym("setbank"), A_FLOAT, A_NULL);
+    class_addmethod(gq_class, (t_method)gq_banks, gensym("banks"), A_FLOAT, A_NULL);
+    class_addmethod(gq_class, (t_method)gq_parallel, gensym("parallel"), A_FLOAT, A_NULL);
+    class_addmethod(gq_class, (t_method)gq_responselist, gensym("response"), A_GIMME, A_NULL);
+    class_addmethod(gq_class, (t_method)gq_plot, gensym("plot"), A_GIMME, A_NULL);
 
     class_addmethod(gq_class, (t_method)gq_bw, gensym("bw"), A_FLOAT, A_NULL);
     class_addmethod(gq_class, (t_method)gq_bt, gensym("bt"), A_FLOAT, A_NULL);
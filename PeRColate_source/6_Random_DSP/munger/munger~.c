@@ -18,6 +18,7 @@
 #endif
 #ifdef PD
 #include "m_pd.h"
+#include "stk_c.h"
 #endif
 #ifdef NT
 #pragma warning( disable : 4244 )
@@ -41,8 +42,8 @@
 #define RAND11 ((float)rand() - 16384.) * ONE_OVER_HALFRAND //random numbers -1 to 1
 #endif /* MSP */
 #ifdef PD
-#define RAND01 (t_float)rand() * ONE_OVER_MAXRAND //random numbers 0-1
-#define RAND11 ((t_float)rand() - 16384.) * ONE_OVER_HALFRAND //random numbers -1 to 1
+#define RAND01 Noise_uniform(&x->noise) //random numbers 0-1, per instance
+#define RAND11 Noise_tick(&x->noise) //random numbers -1 to 1, per instance
 #endif /* PD */
 #define WINLENGTH 1024
 #define PITCHTABLESIZE 100 					//max number of transpositions for the "scale" message
@@ -1036,6 +1037,38 @@ t_int *munger_perform(t_int *w)
 
 static t_class *munger_class;
 
+//the record buffer. every munger~ has its own unless told to share one
+//by name: munger~s on a shared buffer granulate the same recording,
+//made by whichever of them runs first in each run of the dsp chain.
+//shared buffers are listed in munger_buffers, under StkLock since Pd
+//instances may make and free munger~s on their own threads
+typedef struct _mungerbuf
+{
+	t_symbol *name;			//0 if not shared
+	int refcount;
+	t_float *data;
+	t_float buflen;
+	long ringsize;			//slots the record head cycles through
+	long recordCurrent;
+	double recorded;		//logical time of the last block recorded
+	int recordedRun;		//and which run of the perform in that tick
+	
+	//the context the sharers record in, see munger_checkshare
+	double dspTime;			//logical time the dsp chain was last built
+	int dspN;
+	t_float dspSr;
+	
+	//what that block overwrote, see readSamp
+	t_float *overwritten;
+	int overwrittenSize;
+	long overwrittenStart;
+	int overwrittenCount;
+	
+	struct _mungerbuf *next;
+} t_mungerbuf;
+
+static t_mungerbuf *munger_buffers;
+
 typedef struct _munger
 {
 	//header
@@ -1066,29 +1099,47 @@ typedef struct _munger
 
     //window stuff
     short doHanning;
-    t_float winTime[NUMVOICES], winRate[NUMVOICES];
+    t_float *winTime, *winRate;
     t_float winTable[WINLENGTH];
     t_float rampLength; //for simple linear ramp
     
-    //voice parameters
-    long gvoiceSize[NUMVOICES];			//sample size
-    double gvoiceSpeed[NUMVOICES];		//1 = at pitch
-    double gvoiceCurrent[NUMVOICES];	//current sample position
-    int gvoiceDirection[NUMVOICES];		//1 = forward, -1 backwards
-    int gvoiceOn[NUMVOICES];			//currently playing? boolean
-    long gvoiceDone[NUMVOICES];			//how many samples already played from grain
-    t_float gvoiceLPan[NUMVOICES];
-    t_float gvoiceRPan[NUMVOICES];
-    t_float gvoiceRamp[NUMVOICES];
-    t_float gvoiceOneOverRamp[NUMVOICES];
-    t_float gvoiceGain[NUMVOICES];
+    //voice parameters, maxvoices of each (see munger_allocvoices)
+    long *gvoiceSize;			//sample size
+    double *gvoiceSpeed;		//1 = at pitch
+    double *gvoiceCurrent;		//current sample position
+    int *gvoiceDirection;		//1 = forward, -1 backwards
+    int *gvoiceOn;				//currently playing? boolean
+    long *gvoiceDone;			//how many samples already played from grain
+    t_float *gvoiceLPan;		//gain on outlet gvoiceChan
+    t_float *gvoiceRPan;		//gain on the outlet after it
+    int *gvoiceChan;
+    t_float *gvoiceRamp;
+    t_float *gvoiceOneOverRamp;
+    t_float *gvoiceGain;
     int voices;
     t_float gimme;
     
+    //grains playing, in slot order, and free slots as a heap, lowest first
+    int *activeVoice;
+    int numActive;
+    int *freeVoice;
+    int numFree;
+    
+    //where the voice arrays live
+    char *voiceMem;
+    size_t voiceMemSize;
+    
     //sample buffer
-    t_float *recordBuf;
+    t_mungerbuf *buf;
+    t_float *recordBuf; //buf->data
     int recordOn; //boolean
-    long recordCurrent;
+    long recordCurrent; //buf->recordCurrent as of the current block
+    int blocksize;
+    double runTime; //logical time of the last perform
+    int run; //performs in that tick, more than one when reblocked
+    int shareRecord; //0 for a sharer out of step with the buffer's context
+    
+    int nchans; //signal outlets
     
     //other stuff
     long time; 
@@ -1097,11 +1148,110 @@ typedef struct _munger
 
     t_float srate, one_over_srate;
     t_float srate_ms, one_over_srate_ms;
+
+    Noise noise;
 } t_munger;
 
 
 
 /****FUNCTIONS****/
+//finds the shared buffer called name, or makes it buflen samples long;
+//with no name, makes one of the munger~'s own
+static t_mungerbuf *mungerbuf_new(t_symbol *name, t_float buflen)
+{
+	t_mungerbuf *b;
+	
+	StkLock_lock();
+	for(b = munger_buffers; name && b; b = b->next) {
+		if(b->name == name) {
+			b->refcount++;
+			StkLock_unlock();
+			return b;
+		}
+	}
+	
+	b = (t_mungerbuf *)t_getbytes(sizeof(t_mungerbuf));
+	if(!b) {
+		StkLock_unlock();
+		return 0;
+	}
+	b->name = name;
+	b->refcount = 1;
+	b->buflen = buflen;
+	b->ringsize = (long)ceil(buflen);
+	b->data = (t_float *)t_getbytes(b->ringsize * sizeof(t_float));
+	if(!b->data) {
+		t_freebytes(b, sizeof(t_mungerbuf));
+		StkLock_unlock();
+		return 0;
+	}
+	memset(b->data, 0, b->ringsize * sizeof(t_float));
+	b->recordCurrent = 0;
+	b->recorded = -1.;
+	b->recordedRun = 0;
+	b->dspTime = -1.;
+	b->dspN = 0;
+	b->dspSr = 0.;
+	b->overwritten = 0;
+	b->overwrittenSize = b->overwrittenCount = 0;
+	b->overwrittenStart = 0;
+	
+	if(name) {
+		b->next = munger_buffers;
+		munger_buffers = b;
+	}
+	else b->next = 0;
+	StkLock_unlock();
+	return b;
+}
+
+static void mungerbuf_free(t_mungerbuf *b)
+{
+	t_mungerbuf **p;
+	
+	StkLock_lock();
+	if(--b->refcount) {
+		StkLock_unlock();
+		return;
+	}
+	for(p = &munger_buffers; *p; p = &(*p)->next) {
+		if(*p == b) {
+			*p = b->next;
+			break;
+		}
+	}
+	StkLock_unlock();
+	t_freebytes(b->data, b->ringsize * sizeof(t_float));
+	if(b->overwritten) t_freebytes(b->overwritten, b->overwrittenSize * sizeof(t_float));
+	t_freebytes(b, sizeof(t_mungerbuf));
+}
+
+//room to keep a block of n samples the recording overwrites
+static void mungerbuf_window(t_mungerbuf *b, int n)
+{
+	t_float *p;
+	
+	if(n <= b->overwrittenSize) return;
+	p = (t_float *)t_resizebytes(b->overwritten, b->overwrittenSize * sizeof(t_float), n * sizeof(t_float));
+	if(!p) return;
+	b->overwritten = p;
+	b->overwrittenSize = n;
+}
+
+//switches the munger~ over to buffer b, grain sizes follow its length
+static void munger_usebuf(t_munger *x, t_mungerbuf *b)
+{
+	if(x->buf) mungerbuf_free(x->buf);
+	x->buf = b;
+	x->recordBuf = b->data;
+	x->recordCurrent = b->recordCurrent;
+	x->buflen = b->buflen;
+	x->maxsize = x->buflen / 3.;
+	x->twothirdBufsize = x->maxsize * 2.;
+	x->onethirdBufsize = x->maxsize;
+	mungerbuf_window(b, x->blocksize);
+}
+
 //creates a size for a new grain
 //actual number of samples PLAYED, regardless of pitch
 //might be shorter for higher pitches and long grains, to avoid collisions with recordCurrent
@@ -1112,9 +1262,9 @@ static t_float newSize(t_munger *x, int whichOne)
 	int pitchChoice, pitchExponent;
 	
 	//set grain pitch
-	if(x->smoothPitch == 1) x->gvoiceSpeed[whichOne] = x->gpitch + ((t_float)rand() - 16384.) * ONE_OVER_HALFRAND*x->gpitch_var;
+	if(x->smoothPitch == 1) x->gvoiceSpeed[whichOne] = x->gpitch + RAND11*x->gpitch_var;
 	else {
-		temp = (t_float)rand() * ONE_OVER_MAXRAND * x->gpitch_var * (t_float)PITCHTABLESIZE * .1;
+		temp = RAND01 * x->gpitch_var * (t_float)PITCHTABLESIZE * .1;
 		pitchChoice = (int) temp;
 		if(pitchChoice > PITCHTABLESIZE) pitchChoice = PITCHTABLESIZE;
 		if(pitchChoice < 0) pitchChoice = 0;
@@ -1123,7 +1273,7 @@ static t_float newSize(t_munger *x, int whichOne)
 	}
 	
 	if(x->gvoiceSpeed[whichOne] < MINSPEED) x->gvoiceSpeed[whichOne] = MINSPEED;
-	newsize = x->srate_ms*(x->glen + ((t_float)rand() - 16384.) * ONE_OVER_HALFRAND*x->glen_var);
+	newsize = x->srate_ms*(x->glen + RAND11*x->glen_var);
 	if(newsize > x->maxsize) newsize = x->maxsize;
 	if(newsize*x->gvoiceSpeed[whichOne] > x->maxsize) 
 		newsize = x->maxsize/x->gvoiceSpeed[whichOne];
@@ -1138,7 +1288,7 @@ static int newDirection(t_munger *x)
 //1  == only forwards
 	int dir;
 	if(x->ambi == 0) {
-		dir = rand() - 16384;
+		dir = Noise_random(&x->noise, 2) - 1;
 		if (dir < 0) dir = -1;
 		else dir = 1;
 	} 
@@ -1170,33 +1320,74 @@ static t_float win_tick(t_munger *x, int whichone)
 }
 
 //grain funcs
-static t_float envelope(t_munger *x, int whichone, t_float sample)
+//the free slots are kept as a min-heap, so the lowest is freeVoice[0]
+static void pushFree(t_munger *x, int v)
 {
-	long done = x->gvoiceDone[whichone];
-	long tail = x->gvoiceSize[whichone] - x->gvoiceDone[whichone];
+	int i = x->numFree++, parent;
 	
-	/*
-	if(x->doHanning) sample *= win_tick(x, whichone);
-	else{
-		if(done < x->gvoiceRamp[whichone]) sample *= (done*x->gvoiceOneOverRamp[whichone]);
-		else if(tail < x->gvoiceRamp[whichone]) sample *= (tail*x->gvoiceOneOverRamp[whichone]);
+	while(i > 0 && x->freeVoice[parent = (i - 1) / 2] > v) {
+		x->freeVoice[i] = x->freeVoice[parent];
+		i = parent;
 	}
-	*/
-	if(done < x->gvoiceRamp[whichone]) sample *= (done*x->gvoiceOneOverRamp[whichone]);
-	else if(tail < x->gvoiceRamp[whichone]) sample *= (tail*x->gvoiceOneOverRamp[whichone]);
+	x->freeVoice[i] = v;
+}
+
+static int popFree(t_munger *x)
+{
+	int top = x->freeVoice[0], last = x->freeVoice[--x->numFree];
+	int i = 0, child;
 	
-	return sample;
+	while((child = 2 * i + 1) < x->numFree) {
+		if(child + 1 < x->numFree && x->freeVoice[child + 1] < x->freeVoice[child]) child++;
+		if(x->freeVoice[child] >= last) break;
+		x->freeVoice[i] = x->freeVoice[child];
+		i = child;
+	}
+	x->freeVoice[i] = last;
+	return top;
 }
 
 //tries to find an available voice; return -1 if no voices available
+//takes the lowest free slot below x->voices, like the scan over gvoiceOn did
 static int findVoice(t_munger *x)
 {
-	int i = 0, foundOne = -1;
-	while(foundOne < 0 && i < x->voices ) {
-		if (!x->gvoiceOn[i]) foundOne = i;
-		i++;
+	int v, i;
+	
+	if(!x->numFree || x->freeVoice[0] >= x->voices) return -1;
+	v = popFree(x);
+	for(i = x->numActive; i > 0 && x->activeVoice[i - 1] > v; i--)
+		x->activeVoice[i] = x->activeVoice[i - 1];
+	x->activeVoice[i] = v;
+	x->numActive++;
+	return v;
+}
+
+//moves grains that have finished from the active list to the free list
+static void releaseVoices(t_munger *x)
+{
+	int i, j, v;
+	
+	for(i = j = 0; i < x->numActive; i++) {
+		v = x->activeVoice[i];
+		if(x->gvoiceOn[v]) x->activeVoice[j++] = v;
+		else pushFree(x, v);
 	}
-	return foundOne;
+	x->numActive = j;
+}
+
+//more than two outlets are a ring of speakers: the stereo pan picks a place
+//on it, and the grain goes to the two outlets either side, dumb linear
+static void newPan(t_munger *x, int whichVoice)
+{
+	double where = (double)x->gvoiceLPan[whichVoice] * x->nchans;
+	int chan;
+	
+	where -= floor(where / x->nchans) * x->nchans;
+	chan = (int)where;
+	if(chan >= x->nchans) chan = 0;
+	x->gvoiceChan[whichVoice] = chan;
+	x->gvoiceRPan[whichVoice] = where - chan;
+	x->gvoiceLPan[whichVoice] = 1. - x->gvoiceRPan[whichVoice];
 }
 
 //creates a new (random) start position for a new grain, returns beginning start sample
@@ -1208,11 +1399,13 @@ static t_float newSetup(t_munger *x, int whichVoice)
 	
 	x->gvoiceSize[whichVoice] 		= newSize(x, whichVoice);
 	x->gvoiceDirection[whichVoice] 	= newDirection(x);
-	x->gvoiceLPan[whichVoice] 		= ((t_float)rand() - 16384.) * ONE_OVER_MAXRAND * x->gpan_spread + 0.5;
+	x->gvoiceLPan[whichVoice] 		= RAND11 * 0.5 * x->gpan_spread + 0.5;
 	x->gvoiceRPan[whichVoice]		= 1. - x->gvoiceLPan[whichVoice];
+	x->gvoiceChan[whichVoice]		= 0;
+	if(x->nchans != 2) newPan(x, whichVoice);
 	x->gvoiceOn[whichVoice] 		= 1;
 	x->gvoiceDone[whichVoice]		= 0;
-	x->gvoiceGain[whichVoice]		= x->gain + ((t_float)rand() - 16384.) * ONE_OVER_HALFRAND * x->randgain;
+	x->gvoiceGain[whichVoice]		= x->gain + RAND11 * x->randgain;
 	
 	if(x->gvoiceSize[whichVoice] < 2.*x->rampLength) {
 		x->gvoiceRamp[whichVoice] = .5 * x->gvoiceSize[whichVoice];
@@ -1232,13 +1425,13 @@ static t_float newSetup(t_munger *x, int whichVoice)
 	if(x->position == -1. && x->recordOn == 1) { 
 		if(x->gvoiceDirection[whichVoice] == 1) {//going forward			
 			if(x->gvoiceSpeed[whichVoice] > 1.) 
-				newPosition = x->recordCurrent - x->onethirdBufsize - (t_float)rand() * ONE_OVER_MAXRAND * x->onethirdBufsize;
+				newPosition = x->recordCurrent - x->onethirdBufsize - RAND01 * x->onethirdBufsize;
 			else
-				newPosition = x->recordCurrent - (t_float)rand() * ONE_OVER_MAXRAND * x->onethirdBufsize;//was 2/3rds
+				newPosition = x->recordCurrent - RAND01 * x->onethirdBufsize;//was 2/3rds
 		}
 		
 		else //going backwards
-			newPosition = x->recordCurrent - (t_float)rand() * ONE_OVER_MAXRAND * x->onethirdBufsize;
+			newPosition = x->recordCurrent - RAND01 * x->onethirdBufsize;
 	}
 	
 	// 2. fixed positioning and moving buffer	
@@ -1260,10 +1453,10 @@ static t_float newSetup(t_munger *x, int whichVoice)
 	// 3. random positioning and fixed buffer	
 	else if (x->position == -1. && x->recordOn == 0) {
 		if(x->gvoiceDirection[whichVoice] == 1) {//going forward			
-			newPosition = x->recordCurrent - x->onethirdBufsize - (t_float)rand() * ONE_OVER_MAXRAND * x->onethirdBufsize;
+			newPosition = x->recordCurrent - x->onethirdBufsize - RAND01 * x->onethirdBufsize;
 		}	
 		else //going backwards
-			newPosition = x->recordCurrent - (t_float)rand() * ONE_OVER_MAXRAND * x->onethirdBufsize;
+			newPosition = x->recordCurrent - RAND01 * x->onethirdBufsize;
 	}
 	
 	// 4. fixed positioning and fixed buffer	
@@ -1288,7 +1481,63 @@ void recordSamp(t_munger *x, float sample)
 	x->recordBuf[x->recordCurrent++] = sample;
 }
 
-static t_float getSamp(t_munger *x, double where)
+//records a block into the buffer, keeping what it overwrites for readSamp.
+//a shared buffer is recorded once per run of the perform, by the first
+//munger~ on it with recording on; until then this run's window is empty.
+//a run is the logical time and how many times the perform has been
+//called in it, so an overlapped or upsampled block~ records every run
+static void recordBlock(t_munger *x, t_float *in, int n)
+{
+	t_mungerbuf *b = x->buf;
+	double now = clock_getlogicaltime();
+	int k;
+	
+	if(x->runTime != now) {
+		x->runTime = now;
+		x->run = 0;
+	}
+	x->run++;
+	if(b->name && b->recorded == now && b->recordedRun == x->run) return;
+	b->overwrittenCount = 0;
+	if(!x->recordOn || !x->shareRecord || n > b->overwrittenSize) return;
+	
+	for(k = 0; k < n; k++) {
+		if(b->recordCurrent >= b->buflen) b->recordCurrent = 0;
+		if(!k) b->overwrittenStart = b->recordCurrent;
+		b->overwritten[k] = b->data[b->recordCurrent];
+		b->data[b->recordCurrent++] = in[k];
+	}
+	b->overwrittenCount = n;
+	b->recorded = now;
+	b->recordedRun = x->run;
+}
+
+//a block's input is recorded before its grains are played, so this hands
+//back what was in the buffer at sample k of the block: slots recorded
+//later in the block still hold their old contents for that grain
+static t_float readSamp(t_munger *x, long where, int k)
+{
+	t_mungerbuf *b = x->buf;
+	long d = where - b->overwrittenStart;
+	
+	if(d < 0) d += b->ringsize;
+	if(d > k && d < b->overwrittenCount) return b->overwritten[d];
+	return x->recordBuf[where];
+}
+
+//does [lo, hi] touch the slots recorded this block?
+static int overlapsRecording(t_munger *x, long lo, long hi)
+{
+	t_mungerbuf *b = x->buf;
+	long start = b->overwrittenStart;
+	long end = start + b->overwrittenCount - 1;
+	
+	if(!b->overwrittenCount) return 0;
+	if(end < b->ringsize) return lo <= end && hi >= start;
+	return hi >= start || lo <= end - b->ringsize;
+}
+
+static t_float getSamp(t_munger *x, double where, int k)
 {
 	double alpha, om_alpha, output;
 	long first;
@@ -1301,18 +1550,100 @@ static t_float getSamp(t_munger *x, double where)
 	alpha = where - first;
 	om_alpha = 1. - alpha;
 	
-	output = x->recordBuf[first++] * om_alpha;
+	output = readSamp(x, first++, k) * om_alpha;
 	if(first <  x->buflen) {
-		output += x->recordBuf[first] * alpha;
+		output += readSamp(x, first, k) * alpha;
 	}
 	else {
-		output += x->recordBuf[0] * alpha;
+		output += readSamp(x, 0, k) * alpha;
 	}
 	
 	return (t_float)output;
 	
 }
 
+//plays grain v from sample k0 to k1 of the block, or until it ends.
+//a grain that stays clear of the buffer's ends and of this block's
+//recording reads the buffer directly with one wrap for the whole run;
+//the envelope is split into its ramps and the flat part in between,
+//which is only gain and pan. the grain plays on two of the outlets
+static void renderGrain(t_munger *x, int v, int k0, int k1, t_float **outs)
+{
+	t_float samp[STK_BLOCKSIZE];
+	t_float *buf = x->recordBuf;
+	
+	double cur = x->gvoiceCurrent[v];
+	double step = (double)x->gvoiceDirection[v] * x->gvoiceSpeed[v];
+	double buflen = x->buflen, lo, hi, offset, where, alpha;
+	long done = x->gvoiceDone[v], size = x->gvoiceSize[v], first;
+	t_float ramp = x->gvoiceRamp[v], oneOverRamp = x->gvoiceOneOverRamp[v];
+	t_float gain = x->gvoiceGain[v];
+	t_float lpan = x->gvoiceLPan[v], rpan = x->gvoiceRPan[v];
+	t_float *outL = outs[x->gvoiceChan[v]];
+	t_float *outR = outs[(x->gvoiceChan[v] + 1) % x->nchans];
+	t_float sample;
+	int j, n = k1 - k0, up, down;
+	
+	if(n > size - done) n = size - done;
+	
+	//where getSamp would wrap, it wraps every sample of the run the same way
+	lo = hi = cur;
+	if(step < 0.) lo += (n - 1) * step;
+	else hi += (n - 1) * step;
+	offset = lo < 0. ? buflen : hi >= buflen ? -buflen : 0.;
+	
+	if(lo + offset >= 1. && hi + offset < x->buf->ringsize - 2
+		&& !overlapsRecording(x, (long)(lo + offset) - 1, (long)(hi + offset) + 2)) {
+		for(j = 0; j < n; j++) {
+			where = cur + offset;
+			first = (long)where;
+			alpha = where - first;
+			samp[j] = (t_float)(buf[first] * (1. - alpha) + buf[first + 1] * alpha);
+			cur += step;
+		}
+	}
+	else {
+		for(j = 0; j < n; j++) {
+			samp[j] = getSamp(x, cur, k0 + j);
+			cur += step;
+		}
+	}
+	
+	//samples [0, up) are on the way in, [down, n) on the way out
+	for(up = 0; up < n && done + up < ramp; up++)
+		samp[up] *= (done + up) * oneOverRamp;
+	for(down = n; down > up && size - (done + down - 1) < ramp; down--)
+		;
+	for(j = down; j < n; j++)
+		samp[j] *= (size - (done + j)) * oneOverRamp;
+	
+	//pan it, dumb linear
+	outL += k0;
+	outR += k0;
+	for(j = 0; j < n; j++) {
+		sample = samp[j] * gain;
+		outL[j] += sample * lpan;
+		outR[j] += sample * rpan;
+	}
+	
+	x->gvoiceCurrent[v] = cur;
+	x->gvoiceDone[v] = done + n;
+	if(done + n >= size) x->gvoiceOn[v] = 0;
+}
+
+//mixes the playing grains, in slot order, over samples k0 to k1 of the block
+static void mixGrains(t_munger *x, int k0, int k1, t_float **outs)
+{
+	int i, v;
+	
+	if(k1 <= k0) return;
+	for(i = 0; i < x->numActive; i++) {
+		v = x->activeVoice[i];
+		renderGrain(x, v, k0, k1, outs);
+	}
+	releaseVoices(x);
+}
+
 //primary MSP funcs
 static t_int *munger_perform(t_int *w)
 {
@@ -1327,13 +1658,11 @@ static t_int *munger_perform(t_int *w)
 	t_float gpitch_var	= x->gpitch_var;
 	t_float gpan_spread	= x->gpan_spread;
 	
-	t_float *outL = (t_float *)(w[3]);
-	t_float *outR = (t_float *)(w[4]);
-	long n = w[5];
+	t_float **outs = (t_float **)(w + 3);
+	long n = w[3 + x->nchans];
 	
-	t_float gimme;
-	t_float outsampL, outsampR, samp;
-	int newvoice, i;
+	t_mungerbuf *b = x->buf;
+	int newvoice, c, k, k0, k1, i;
 		
 	//make sure vars are updated if signals are connected; stupid, lazy, boob.
 	x->grate = grate;
@@ -1345,70 +1674,100 @@ static t_int *munger_perform(t_int *w)
 	x->gpan_spread = gpan_spread;
 		
 	//grate = grate + RAND01 * grate_var;
-	//grate = grate + ((t_float)rand() - 16384.) * ONE_OVER_HALFRAND * grate_var;
+	//grate = grate + RAND11 * grate_var;
 	//gimme = x->srate_ms * grate; //grate is actually time-distance between grains
 
 	if(gpan_spread > 1.) gpan_spread = 1.;
 	if(gpan_spread < 0.) gpan_spread = 0.;
 	
 	if(!x->power) {
-		while(n--) {
-			*outL++ = 0.;
-			*outR++ = 0.;
-		}
+		for(i = 0; i < x->nchans; i++)
+			for(k = 0; k < n; k++) outs[i][k] = 0.;
 	}
 
 	else {
-		while(n--) {
-			outsampL = outsampR = 0.;
-			
-			//record a sample
-			if(x->recordOn) recordSamp(x, *in++);
-			
-			//find a voice if it's time (high resolution)
-			if(x->time++ >= (long)x->gimme) {
-				x->time = 0;
-				newvoice = findVoice(x);
-				if(newvoice >= 0) {
-					x->gvoiceCurrent[newvoice] = newSetup(x, newvoice);
-				}
-				grate = grate + ((t_float)rand() - 16384.) * ONE_OVER_HALFRAND * grate_var;
-				x->gimme = x->srate_ms * grate; //grate is actually time-distance between grains
-			}
+		//record the whole block up front, readSamp keeps the grains in step
+		recordBlock(x, in, n);
+		x->recordCurrent = b->recordCurrent;
+		
+		for(i = 0; i < x->nchans; i++)
+			for(k = 0; k < n; k++) outs[i][k] = 0.;
+		
+		//in runs of up to STK_BLOCKSIZE, for renderGrain's scratch
+		for(c = 0; c < n; c = k1) {
+			k1 = n - c < STK_BLOCKSIZE ? n : c + STK_BLOCKSIZE;
 			
-			//mix 'em, pan 'em
-			for(i=0; i< x->maxvoices; i++) {
-			//for(i=0; i<x->voices; i++) {
-				if(x->gvoiceOn[i]) {
-					//get a sample, envelope it
-					samp = getSamp(x, x->gvoiceCurrent[i]);
-					samp = envelope(x, i, samp) * x->gvoiceGain[i];
-					
-					//pan it, dumb linear
-					outsampL += samp * x->gvoiceLPan[i];
-					outsampR += samp * x->gvoiceRPan[i];
-					
-					//see if grain is done after jumping to next sample point
-					x->gvoiceCurrent[i] += (double)x->gvoiceDirection[i] * x->gvoiceSpeed[i];
-					if(++x->gvoiceDone[i] >= x->gvoiceSize[i]) x->gvoiceOn[i] = 0;
+			//find a voice if it's time (high resolution), mixing what plays up to then
+			for(k = k0 = c; k < k1; k++) {
+				if(x->time++ >= (long)x->gimme) {
+					x->time = 0;
+					mixGrains(x, k0, k, outs);
+					k0 = k;
+					newvoice = findVoice(x);
+					if(newvoice >= 0) {
+						//start from where the record head was at this sample
+						if(b->overwrittenCount)
+							x->recordCurrent = (b->overwrittenStart + k) % b->ringsize + 1;
+						x->gvoiceCurrent[newvoice] = newSetup(x, newvoice);
+						x->recordCurrent = b->recordCurrent;
+					}
+					grate = grate + RAND11 * grate_var;
+					x->gimme = x->srate_ms * grate; //grate is actually time-distance between grains
 				}
 			}
-			*outL++ = outsampL;
-			*outR++ = outsampR;
+			mixGrains(x, k0, k1, outs);
 		}
 	}
-	return w + 6;	
+	return w + x->nchans + 4;	
+}
+
+//sharers have to record in step, so at one block size and sample rate:
+//the first sharer a rebuilt dsp chain reaches sets them, and one in
+//another context only plays the buffer. an overlapped block~ has to
+//match too, but that can't be seen from here
+static void munger_checkshare(t_munger *x, int rebuilt)
+{
+	t_mungerbuf *b = x->buf;
+	double now = clock_getlogicaltime();
+	
+	x->shareRecord = 1;
+	if(!b->name || !x->blocksize) return;
+	if(rebuilt && b->dspTime != now) {
+		b->dspTime = now;
+		b->dspN = x->blocksize;
+		b->dspSr = x->srate;
+	}
+	else if(b->dspN && (x->blocksize != b->dspN || x->srate != b->dspSr)) {
+		pd_error(x, "munger~: %s records at block size %d and %g Hz, this one only plays it",
+			b->name->s_name, b->dspN, b->dspSr);
+		x->shareRecord = 0;
+	}
 }
 
 static void munger_dsp(t_munger *x, t_signal **sp)
 {
+	t_int *vec;
+	int i;
+	
 	x->srate = sp[0]->s_sr;
     x->one_over_srate = 1./x->srate;
 
     x->srate_ms = x->srate * .001;
     x->one_over_srate_ms = 1000. * x->one_over_srate;
 
-	dsp_add(munger_perform, 5, x, sp[0]->s_vec, sp[1]->s_vec, sp[2]->s_vec, sp[0]->s_n);	
+	x->blocksize = sp[0]->s_n;
+	mungerbuf_window(x->buf, x->blocksize);
+	munger_checkshare(x, 1);
+	
+	//x, the input, the outlets, the block size
+	vec = (t_int *)t_getbytes((x->nchans + 3) * sizeof(t_int));
+	vec[0] = (t_int)x;
+	vec[1] = (t_int)sp[0]->s_vec;
+	for(i = 0; i < x->nchans; i++)
+		vec[2 + i] = (t_int)sp[1 + i]->s_vec;
+	vec[2 + x->nchans] = sp[0]->s_n;
+	dsp_addv(munger_perform, x->nchans + 3, vec);
+	t_freebytes(vec, (x->nchans + 3) * sizeof(t_int));
 	
 }
 
@@ -1455,7 +1814,7 @@ static void munger_bufsize(t_munger *x, t_floatarg temp)
 	temp *= x->srate;
 	if(temp < 20.*(t_float)MINSIZE) temp = 20.*(t_float)MINSIZE;
 	//if(temp > (t_float)BUFLENGTH) temp = (t_float)BUFLENGTH;
-	if(temp > x->initbuflen) temp = x->initbuflen;
+	if(temp > x->buflen) temp = x->buflen;
 	//x->buflen = temp;
 	//x->maxsize = x->buflen / 3.;
 	x->maxsize = temp / 3.;
@@ -1469,7 +1828,7 @@ static void munger_bufsize_ms(t_munger *x, t_floatarg temp)
 	temp *= x->srate_ms;
 	if(temp < 20.*(t_float)MINSIZE) temp = 20.*(t_float)MINSIZE;
 	//if(temp > (float)BUFLENGTH) temp = (t_float)BUFLENGTH;
-	if(temp > x->initbuflen) temp = x->initbuflen;
+	if(temp > x->buflen) temp = x->buflen;
 	//x->buflen = temp;
 	//x->maxsize = x->buflen / 3.;
 	x->maxsize = temp / 3.;
@@ -1498,11 +1857,12 @@ static void munger_setvoices(t_munger *x, t_floatarg temp)
     //post("munger: setting max voices to: %d ", x->voices);
 }
 
+static int munger_allocvoices(t_munger *x, long n);
+
 static void munger_maxvoices(t_munger *x, t_floatarg temp)
 {
 	if(temp < 0) temp = 0;
-	if(temp > NUMVOICES) temp = NUMVOICES;
-	x->maxvoices = temp;
+	if(!munger_allocvoices(x, temp)) return;
     //post("munger: setting max voices to: %d ", x->voices);
 }
 
@@ -1570,21 +1930,117 @@ static void munger_smooth(t_munger *x)
 	x->smoothPitch = 1;
 }
 
-static void munger_alloc(t_munger *x)
+//share <name> records into and plays from the buffer called name, shared
+//with every munger~ given the same name (which should all get the same
+//input); share with no name goes back to a buffer of its own
+static void munger_share(t_munger *x, t_symbol *s)
 {
-	//x->recordBuf = t_getbytes(BUFLENGTH * sizeof(float));
-	x->recordBuf = t_getbytes(x->buflen * sizeof(t_float));
-	if (!x->recordBuf) {
-		perror("munger: out of memory");
+	t_mungerbuf *b = mungerbuf_new(*s->s_name ? s : 0, x->initbuflen);
+	
+	if(!b) {
+		pd_error(x, "munger~: out of memory for the record buffer");
 		return;
 	}
+	if(b == x->buf) {
+		mungerbuf_free(b);
+		return;
+	}
+	munger_usebuf(x, b);
+	munger_checkshare(x, 0);
+	if(b->buflen != x->initbuflen)
+		post("munger: sharing %s, delaylength %f seconds", s->s_name, x->buflen / x->srate);
+}
+
+//points field at its array in the voice memory, each array on its own
+//cache line, copying over the first keep voices; with no mem it only
+//adds up the bytes
+static void munger_layout(char *mem, size_t *used, void *field, size_t size, long n, long keep)
+{
+	void **p = (void **)field;
+	
+	if(mem) {
+		if(keep) memcpy(mem + *used, *p, keep * size);
+		*p = mem + *used;
+	}
+	*used += (n * size + STK_TABLE_ALIGN - 1) & ~(size_t)(STK_TABLE_ALIGN - 1);
+}
+
+static size_t munger_layoutvoices(t_munger *x, char *mem, long n, long keep)
+{
+	size_t used = 0;
+	
+	munger_layout(mem, &used, &x->gvoiceSize, sizeof(long), n, keep);
+	munger_layout(mem, &used, &x->gvoiceSpeed, sizeof(double), n, keep);
+	munger_layout(mem, &used, &x->gvoiceCurrent, sizeof(double), n, keep);
+	munger_layout(mem, &used, &x->gvoiceDirection, sizeof(int), n, keep);
+	munger_layout(mem, &used, &x->gvoiceOn, sizeof(int), n, keep);
+	munger_layout(mem, &used, &x->gvoiceDone, sizeof(long), n, keep);
+	munger_layout(mem, &used, &x->gvoiceLPan, sizeof(t_float), n, keep);
+	munger_layout(mem, &used, &x->gvoiceRPan, sizeof(t_float), n, keep);
+	munger_layout(mem, &used, &x->gvoiceChan, sizeof(int), n, keep);
+	munger_layout(mem, &used, &x->gvoiceRamp, sizeof(t_float), n, keep);
+	munger_layout(mem, &used, &x->gvoiceOneOverRamp, sizeof(t_float), n, keep);
+	munger_layout(mem, &used, &x->gvoiceGain, sizeof(t_float), n, keep);
+	munger_layout(mem, &used, &x->winTime, sizeof(t_float), n, keep);
+	munger_layout(mem, &used, &x->winRate, sizeof(t_float), n, keep);
+	munger_layout(mem, &used, &x->activeVoice, sizeof(int), n, keep);
+	munger_layout(mem, &used, &x->freeVoice, sizeof(int), n, keep);
+	return used;
+}
+
+//(re)sizes the voice arrays to n voices. grains in slots that go away
+//are cut, the others carry on
+static int munger_allocvoices(t_munger *x, long n)
+{
+	size_t size = munger_layoutvoices(x, 0, n, 0) + STK_TABLE_ALIGN;
+	char *mem = t_getbytes(size);
+	long keep = x->maxvoices < n ? x->maxvoices : n;
+	int i, j;
+	
+	if(!mem) {
+		pd_error(x, "munger~: out of memory for %ld voices", n);
+		return 0;
+	}
+	
+	for(i = j = 0; i < x->numActive; i++)
+		if(x->activeVoice[i] < n) x->activeVoice[j++] = x->activeVoice[i];
+	x->numActive = j;
+	
+	munger_layoutvoices(x, (char *)(((size_t)mem + STK_TABLE_ALIGN - 1) & ~(size_t)(STK_TABLE_ALIGN - 1)), n, keep);
+	if(x->voiceMem) t_freebytes(x->voiceMem, x->voiceMemSize);
+	x->voiceMem = mem;
+	x->voiceMemSize = size;
+	x->maxvoices = n;
+	if(x->voices > n) x->voices = n;
+	
+	for(i = keep; i < n; i++) {
+		x->gvoiceSize[i] = 1000;
+		x->gvoiceSpeed[i] = 1.;
+		x->gvoiceCurrent[i] = 0.;
+		x->gvoiceDirection[i] = 1;
+		x->gvoiceOn[i] = 0;
+		x->gvoiceDone[i] = 0;
+		x->gvoiceRPan[i] = .5;
+		x->gvoiceLPan[i] = .5;
+		x->gvoiceChan[i] = 0;
+		x->gvoiceGain[i] = 1.;
+		x->winTime[i] = 0.;
+		x->winRate[i] = 0.;
+	}
+	
+	//free slots in increasing order are already a heap
+	x->numFree = 0;
+	for(i = 0; i < n; i++)
+		if(!x->gvoiceOn[i]) x->freeVoice[x->numFree++] = i;
+	return 1;
 }
 
 static void munger_free(t_munger *x)
 {
-	if (x->recordBuf)
-		//t_freebytes(x->recordBuf, BUFLENGTH * sizeof(float));
-		t_freebytes(x->recordBuf, x->initbuflen * sizeof(t_float));
+	if (x->voiceMem)
+		t_freebytes(x->voiceMem, x->voiceMemSize);
+	if (x->buf)
+		mungerbuf_free(x->buf);
 }
 
 
@@ -1618,13 +2074,18 @@ static void munger_gpan_spread(t_munger *x, t_floatarg f)
 {
 	x->gpan_spread = f;
 }
+static void munger_seed(t_munger *x, t_floatarg f)
+{
+	Noise_seed(&x->noise, (unsigned int)f);
+}
 
 
 //hanning y = 0.5 + 0.5*cos(TWOPI * n/N + PI)
 
-static void *munger_new(t_floatarg maxdelay)
+static void *munger_new(t_floatarg maxdelay, t_floatarg channels)
 {
 	unsigned int i;
+	t_mungerbuf *b;
     
     t_munger *x = (t_munger *)pd_new(munger_class);
     //zero out the struct, to be careful (takk to jkclayton)
@@ -1636,8 +2097,10 @@ static void *munger_new(t_floatarg maxdelay)
 	if (maxdelay < 100.) maxdelay = 3000.; //set maxdelay to 3000ms by default
 	post("munger: maxdelay = %f milliseconds", maxdelay);
 	
-	outlet_new(&x->x_obj, gensym("signal"));
-	outlet_new(&x->x_obj, gensym("signal"));
+	//two outlets, left and right, or a ring of them
+	x->nchans = channels < 1. ? 2 : (int)channels;
+	for(i = 0; i < x->nchans; i++)
+		outlet_new(&x->x_obj, gensym("signal"));
     			   
 	inlet_new(&x->x_obj, &x->x_obj.ob_pd, &s_float, gensym("grate_var"));
 	inlet_new(&x->x_obj, &x->x_obj.ob_pd, &s_float, gensym("glen"));
@@ -1651,22 +2114,19 @@ static void *munger_new(t_floatarg maxdelay)
     x->srate_ms = x->srate/1000.;
     x->one_over_srate_ms = 1./x->srate_ms;
     
-    //x->buflen = (float)BUFLENGTH;
-    if (x->recordBuf)
-		t_freebytes(x->recordBuf, x->initbuflen * sizeof(t_float));
-		
     x->initbuflen = (t_float)maxdelay * 44.1;
-    x->buflen = x->initbuflen;
-    x->maxsize = x->buflen / 3.;
-    x->twothirdBufsize = x->maxsize * 2.;
-    x->onethirdBufsize = x->maxsize;
+    b = mungerbuf_new(0, x->initbuflen);
+    if (!b) {
+        pd_error(x, "munger~: out of memory for the record buffer");
+        return (0);
+    }
+    munger_usebuf(x, b);
+    x->shareRecord = 1;
     x->minsize = MINSIZE;
     x->voices = 10;
     x->gain = 1.;
     x->randgain = 0.;
     
-    munger_alloc(x);
-    
     x->twelfth = 1./12.;
     x->semitone = pow(2., 1./12.);
     x->smoothPitch = 1;
@@ -1685,18 +2145,12 @@ static void *munger_new(t_floatarg maxdelay)
     
     x->power = 1;
     x->ambi = 0;
-    x->maxvoices = 20;
-        
-    for(i=0; i<NUMVOICES; i++) {
-    	x->gvoiceSize[i] = 1000;			
-    	x->gvoiceSpeed[i] = 1.;			
-    	x->gvoiceCurrent[i] = 0.;		
-    	x->gvoiceDirection[i] = 1;		
-    	x->gvoiceOn[i] = 0;			
-    	x->gvoiceDone[i] = 0;			
-    	x->gvoiceRPan[i] = .5;
-    	x->gvoiceLPan[i] = .5;
-    	x->gvoiceGain[i] = 1.;
+    
+    //voices, grown or shrunk by the maxvoices message
+    x->numActive = 0;
+    if (!munger_allocvoices(x, 20)) {
+        mungerbuf_free(x->buf);
+        return (0);
     }
     
     //init hanning window
@@ -1711,12 +2165,9 @@ static void *munger_new(t_floatarg maxdelay)
     x->rampLength = 256.;
     
     //sample buffer
-    //for(i=0; i<BUFLENGTH; i++) x->recordBuf[i] = 0.;
-    for(i=0; i<x->initbuflen; i++) x->recordBuf[i] = 0.;
     x->recordOn = 1; //boolean
-	x->recordCurrent = 0;
 
-    srand(0.54);
+    Noise_init(&x->noise, 0);
     //post("mungery away");
     
     return (x);
@@ -1726,7 +2177,7 @@ static void *munger_new(t_floatarg maxdelay)
 void munger_tilde_setup(void)
 {
 	munger_class = class_new(gensym("munger~"), (t_newmethod)munger_new, (t_method)munger_free,
-        sizeof(t_munger), 0, A_DEFFLOAT, 0);
+        sizeof(t_munger), 0, A_DEFFLOAT, A_DEFFLOAT, 0);
     class_addmethod(munger_class, nullfn, gensym("signal"), A_NULL);
     class_addmethod(munger_class, (t_method)munger_dsp, gensym("dsp"), A_NULL);
 	class_addfloat(munger_class, (t_method)munger_float);
@@ -1753,6 +2204,8 @@ void munger_tilde_setup(void)
     class_addmethod(munger_class, (t_method)munger_gpitch, gensym("gpitch"), A_FLOAT, A_NULL);
     class_addmethod(munger_class, (t_method)munger_gpitch_var, gensym("gpitch_var"), A_FLOAT, A_NULL);
     class_addmethod(munger_class, (t_method)munger_gpan_spread, gensym("gpan_spread"), A_FLOAT, A_NULL);
+    class_addmethod(munger_class, (t_method)munger_seed, gensym("seed"), A_FLOAT, A_NULL);
+    class_addmethod(munger_class, (t_method)munger_share, gensym("share"), A_DEFSYM, A_NULL);
     class_sethelpsymbol(munger_class, gensym("help-munger~.pd"));
 }
 #endif /* PD */
@@ -0,0 +1,296 @@
+/********************************************/
+/*  Offline benchmark for one external.     */
+/*                                          */
+/*  Built once per object against pdstub.c  */
+/*  with -DBENCH_SETUP=<name>_tilde_setup,  */
+/*  it plays a parameter script into the    */
+/*  object and times its perform routines:  */
+/*                                          */
+/*    bench [-b blocksize] [-r samplerate]  */
+/*          [-s seconds] [-n runs]          */
+/*          [-o out.raw] script             */
+/*                                          */
+/*  Script lines are                        */
+/*    <sample> <selector> [floats...]       */
+/*  in time order,                          */
+/*  and, once each,                         */
+/*    new <floats...>     creation args     */
+/*    repeat <samples>    replay period     */
+/*    array <name> <size> a table to read   */
+/*    mute <sample>       inputs go silent  */
+/*    mark <sample>       time what follows */
+/*                        on its own        */
+/*  and # comments. Signal inlets get       */
+/*  white noise. -o writes the outlets of   */
+/*  the first run as interleaved floats.    */
+/********************************************/
+
+#include "pdstub.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCH_CYCLES() ((double)__rdtsc())
+#else
+#define BENCH_CYCLES() (-1.)
+#define BENCH_NOCYCLES // no counter: cycles stay -1 and print as n/a
+#endif
+
+#define BENCH_MAXEVENTS 1024
+#define BENCH_MAXSEL 64
+
+typedef struct _event {
+    long when;
+    char sel[BENCH_MAXSEL];
+    int argc;
+    t_float argv[STUB_MAXARGS];
+} t_event;
+
+typedef struct _script {
+    t_event events[BENCH_MAXEVENTS];
+    int nevents;
+    long repeat;
+    long mute, mark; // 0 if not given
+    int argc; // creation arguments
+    t_float argv[STUB_MAXARGS];
+} t_script;
+
+typedef struct _result {
+    double ns, cycles; // in the perform routines only
+    double before, after; // ns/sample either side of the mark
+    long setupallocs, setupbytes;
+    long runallocs, runbytes;
+    long leaked;
+} t_result;
+
+void BENCH_SETUP(void);
+
+static double bench_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static int bench_readscript(const char *path, t_script *sc) {
+    char line[1024], *tok;
+    t_event *e;
+    FILE *fd = fopen(path, "r");
+
+    if (!fd) {
+        perror(path);
+        return 0;
+    }
+    memset(sc, 0, sizeof(t_script));
+    while (fgets(line, sizeof(line), fd)) {
+        tok = strtok(line, " \t\r\n");
+        if (!tok || *tok == '#')
+            continue;
+        if (!strcmp(tok, "new")) {
+            while ((tok = strtok(0, " \t\r\n")) && sc->argc < STUB_MAXARGS)
+                sc->argv[sc->argc++] = atof(tok);
+        } else if (!strcmp(tok, "repeat")) {
+            tok = strtok(0, " \t\r\n");
+            sc->repeat = tok ? atol(tok) : 0;
+        } else if (!strcmp(tok, "mute") || !strcmp(tok, "mark")) {
+            long *when = !strcmp(tok, "mute") ? &sc->mute : &sc->mark;
+            tok = strtok(0, " \t\r\n");
+            *when = tok ? atol(tok) : 0;
+        } else if (!strcmp(tok, "array")) {
+            char *name = strtok(0, " \t\r\n");
+            tok = strtok(0, " \t\r\n");
+            if (name && tok)
+                stub_array(gensym(name), atoi(tok));
+        } else if (sc->nevents < BENCH_MAXEVENTS) {
+            e = &sc->events[sc->nevents];
+            e->when = atol(tok);
+            if (!(tok = strtok(0, " \t\r\n")))
+                continue;
+            strncpy(e->sel, tok, BENCH_MAXSEL - 1);
+            while ((tok = strtok(0, " \t\r\n")) && e->argc < STUB_MAXARGS)
+                e->argv[e->argc++] = atof(tok);
+            sc->nevents++;
+        }
+    }
+    fclose(fd);
+    return 1;
+}
+
+// deterministic input, the same for every run
+static void bench_noise(t_sample *vec, int n, unsigned int *state) {
+    unsigned int s = *state;
+    while (n--) {
+        s ^= s << 13;
+        s ^= s >> 17;
+        s ^= s << 5;
+        *vec++ = (t_sample)((int)s * (0.5 / 2147483648.));
+    }
+    *state = s;
+}
+
+static int bench_run(t_script *sc, int blocksize, long length, FILE *out,
+                     t_result *res) {
+    t_signal sigs[STUB_MAXSIGNALS], *sp[STUB_MAXSIGNALS];
+    unsigned int noise = 2463534242u;
+    long pos, offset = 0, allocs, bytes, live;
+    int i, j, k, nsigs, ev = 0;
+    double t0, c0, t;
+    void *x;
+
+    allocs = stub_allocs;
+    live = stub_allocbytes - stub_freedbytes;
+
+    if (!(x = stub_new(sc->argc, sc->argv))) {
+        fprintf(stderr, "%s: couldn't create\n", stub_class->name->s_name);
+        return 0;
+    }
+    nsigs = stub_sigin + stub_sigout;
+    if (nsigs > STUB_MAXSIGNALS) {
+        fprintf(stderr, "%s: too many signals\n", stub_class->name->s_name);
+        return 0;
+    }
+    for (i = 0; i < nsigs; i++) {
+        sigs[i].s_n = blocksize;
+        sigs[i].s_sr = stub_srate;
+        sigs[i].s_nchans = 1;
+        sigs[i].s_vec = calloc(blocksize, sizeof(t_sample));
+        sp[i] = &sigs[i];
+    }
+    stub_dsp(x, sp);
+
+    res->setupallocs = stub_allocs - allocs;
+    res->setupbytes = stub_allocbytes - stub_freedbytes - live;
+    allocs = stub_allocs;
+    bytes = stub_allocbytes;
+    res->ns = res->cycles = res->before = res->after = 0.;
+
+    for (pos = 0; pos < length; pos += blocksize) {
+        // messages land on block boundaries, as they do in Pd
+        while (sc->nevents) {
+            if (ev == sc->nevents) {
+                if (!sc->repeat)
+                    break;
+                ev = 0;
+                offset += sc->repeat;
+            }
+            if (sc->events[ev].when + offset > pos)
+                break;
+            stub_send(x, sc->events[ev].sel, sc->events[ev].argc,
+                      sc->events[ev].argv);
+            ev++;
+        }
+        for (i = 0; i < stub_sigin; i++) {
+            if (sc->mute && pos >= sc->mute)
+                memset(sigs[i].s_vec, 0, blocksize * sizeof(t_sample));
+            else
+                bench_noise(sigs[i].s_vec, blocksize, &noise);
+        }
+
+        c0 = BENCH_CYCLES();
+        t0 = bench_now();
+        stub_tick();
+        t = bench_now() - t0;
+        res->cycles += BENCH_CYCLES() - c0;
+        res->ns += t;
+        if (pos < sc->mark)
+            res->before += t;
+        else
+            res->after += t;
+
+        if (out) {
+            for (j = 0; j < blocksize; j++)
+                for (k = stub_sigin; k < nsigs; k++)
+                    fwrite(&sigs[k].s_vec[j], sizeof(t_sample), 1, out);
+        }
+    }
+    res->ns /= pos;
+    if (sc->mark && sc->mark < pos) {
+        length = (sc->mark + blocksize - 1) / blocksize * blocksize;
+        res->before /= length;
+        res->after /= pos - length;
+    }
+#ifdef BENCH_NOCYCLES
+    res->cycles = -1.;
+#else
+    res->cycles /= pos;
+#endif
+    res->runallocs = stub_allocs - allocs;
+    res->runbytes = stub_allocbytes - bytes;
+
+    stub_free(x);
+    res->leaked = stub_allocbytes - stub_freedbytes - live;
+    for (i = 0; i < nsigs; i++)
+        free(sigs[i].s_vec);
+    return 1;
+}
+
+static void bench_usage(void) {
+    fprintf(stderr, "usage: bench [-b blocksize] [-r samplerate] [-s seconds] "
+                    "[-n runs] [-o out.raw] script\n");
+    exit(1);
+}
+
+int main(int argc, char **argv) {
+    int blocksize = 64, runs = 5, i;
+    double seconds = 10.;
+    const char *outpath = 0, *scriptpath = 0;
+    t_script *sc = malloc(sizeof(t_script));
+    t_result res, best;
+    FILE *out = 0;
+
+    for (i = 1; i < argc; i++) {
+        if (argv[i][0] != '-')
+            scriptpath = argv[i];
+        else if (i + 1 == argc)
+            bench_usage();
+        else if (!strcmp(argv[i], "-b"))
+            blocksize = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-r"))
+            stub_srate = atof(argv[++i]);
+        else if (!strcmp(argv[i], "-s"))
+            seconds = atof(argv[++i]);
+        else if (!strcmp(argv[i], "-n"))
+            runs = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-o"))
+            outpath = argv[++i];
+        else
+            bench_usage();
+    }
+    if (!scriptpath || blocksize < 1 || runs < 1 || stub_srate <= 0.)
+        bench_usage();
+
+    BENCH_SETUP();
+    if (!bench_readscript(scriptpath, sc))
+        return 1;
+    if (outpath && !(out = fopen(outpath, "wb"))) {
+        perror(outpath);
+        return 1;
+    }
+
+    // best of the runs, the others mostly measure the machine
+    for (i = 0; i < runs; i++) {
+        if (!bench_run(sc, blocksize, (long)(seconds * stub_srate), out, &res))
+            return 1;
+        if (out) {
+            fclose(out);
+            out = 0;
+        }
+        if (!i || res.ns < best.ns)
+            best = res;
+    }
+
+    printf("%-12s %5d @ %6g Hz  %8.2f ns/sample", stub_class->name->s_name,
+           blocksize, stub_srate, best.ns);
+    if (best.cycles >= 0.)
+        printf("  %8.2f cycles/sample", best.cycles);
+    else
+        printf("  %8s cycles/sample", "n/a");
+    printf("  allocs: %ld setup (%ld bytes), %ld running, %ld bytes leaked",
+           best.setupallocs, best.setupbytes, best.runallocs, best.leaked);
+    if (sc->mark)
+        printf("\n%12s before sample %ld: %.2f ns/sample, after: %.2f ns/sample",
+               "", sc->mark, best.before, best.after);
+    printf("\n");
+    return 0;
+}
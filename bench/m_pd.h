@@ -0,0 +1,142 @@
+/********************************************/
+/*  m_pd.h for the offline benchmarks       */
+/*                                          */
+/*  Just the part of the Pd API the         */
+/*  PeRColate objects use, implemented by   */
+/*  pdstub.c instead of a running Pd.       */
+/********************************************/
+
+#ifndef __m_pd_h_
+#define __m_pd_h_
+
+#include <stddef.h>
+
+#define PD_MAJOR_VERSION 0
+#define PD_MINOR_VERSION 54
+#define MAXPDSTRING 1000
+#define CLASS_DEFAULT 0
+
+typedef float t_float;
+typedef float t_floatarg;
+typedef float t_sample;
+typedef long t_int;
+
+typedef struct _symbol {
+    const char *s_name;
+} t_symbol;
+
+typedef struct _class t_class;
+typedef t_class *t_pd;
+typedef struct _outlet t_outlet;
+typedef struct _inlet t_inlet;
+typedef struct _garray t_garray;
+
+typedef struct _object {
+    t_pd ob_pd;
+} t_object;
+typedef t_object t_text;
+
+typedef struct _signal {
+    int s_n;
+    t_sample *s_vec;
+    t_float s_sr;
+    int s_nchans;
+} t_signal;
+
+typedef enum {
+    A_NULL,
+    A_FLOAT,
+    A_SYMBOL,
+    A_POINTER,
+    A_SEMI,
+    A_COMMA,
+    A_DEFFLOAT,
+    A_DEFSYM,
+    A_DOLLAR,
+    A_DOLLSYM,
+    A_GIMME,
+    A_CANT
+} t_atomtype;
+
+typedef union word {
+    t_float w_float;
+    t_symbol *w_symbol;
+    int w_index;
+} t_word;
+
+typedef struct _atom {
+    t_atomtype a_type;
+    union word a_w;
+} t_atom;
+
+typedef void (*t_method)(void);
+typedef void *(*t_newmethod)(void);
+typedef t_int *(*t_perfroutine)(t_int *w);
+
+#define SETFLOAT(atom, f) ((atom)->a_type = A_FLOAT, (atom)->a_w.w_float = (f))
+#define SETSYMBOL(atom, s)                                                     \
+    ((atom)->a_type = A_SYMBOL, (atom)->a_w.w_symbol = (s))
+
+extern t_symbol s_float, s_signal, s_list, s_bang, s_symbol;
+extern t_class *garray_class;
+
+// classes and objects
+t_symbol *gensym(const char *s);
+t_class *class_new(t_symbol *name, t_newmethod newmethod, t_method freemethod,
+                   size_t size, int flags, t_atomtype arg1, ...);
+void class_addmethod(t_class *c, t_method fn, t_symbol *sel, t_atomtype arg1,
+                     ...);
+void class_addbang(t_class *c, t_method fn);
+void class_addfloat(t_class *c, t_method fn);
+void class_addlist(t_class *c, t_method fn);
+void class_addanything(t_class *c, t_method fn);
+void class_sethelpsymbol(t_class *c, t_symbol *s);
+void class_domainsignalin(t_class *c, int onset);
+#define CLASS_MAINSIGNALIN(c, type, field)                                     \
+    class_domainsignalin(c, (char *)(&((type *)0)->field) - (char *)0)
+void nullfn(void);
+t_pd *pd_new(t_class *cls);
+void *pd_findbyclass(t_symbol *s, const t_class *c);
+void pd_bind(t_pd *x, t_symbol *s);
+void pd_unbind(t_pd *x, t_symbol *s);
+
+// inlets and outlets
+t_outlet *outlet_new(t_object *owner, t_symbol *s);
+t_inlet *inlet_new(t_object *owner, t_pd *dest, t_symbol *s1, t_symbol *s2);
+t_inlet *floatinlet_new(t_object *owner, t_float *fp);
+void outlet_bang(t_outlet *x);
+void outlet_float(t_outlet *x, t_float f);
+void outlet_list(t_outlet *x, t_symbol *s, int argc, t_atom *argv);
+
+// console
+void post(const char *fmt, ...);
+void error(const char *fmt, ...);
+void pd_error(const void *object, const char *fmt, ...);
+
+// memory
+void *getbytes(size_t nbytes);
+void *resizebytes(void *old, size_t oldsize, size_t newsize);
+void freebytes(void *x, size_t nbytes);
+#define t_getbytes getbytes
+#define t_resizebytes resizebytes
+#define t_freebytes freebytes
+
+// atoms
+t_float atom_getfloat(const t_atom *a);
+t_float atom_getfloatarg(int which, int argc, const t_atom *argv);
+t_symbol *atom_getsymbolarg(int which, int argc, const t_atom *argv);
+
+// dsp
+t_float sys_getsr(void);
+double clock_getlogicaltime(void);
+void dsp_add(t_perfroutine f, int n, ...);
+void dsp_addv(t_perfroutine f, int n, t_int *vec);
+
+// arrays
+int garray_getfloatarray(t_garray *x, int *size, t_float **vec);
+int garray_getfloatwords(t_garray *x, int *size, t_word **vec);
+void garray_redraw(t_garray *x);
+void garray_resize_long(t_garray *x, long n);
+void garray_usedindsp(t_garray *x);
+
+#endif // __m_pd_h_
@@ -0,0 +1,42 @@
+# The signal objects the benchmarks and the regression tests can run,
+# with their sources relative to bench/ or test/
+
+src := ../PeRColate_source
+sdk := ../percolate/stk.c
+
+# 1_Physical_Models
+blotar~.sources := $(src)/1_Physical_Models/blotar/blotar~.c $(sdk)
+bowed~.sources := $(src)/1_Physical_Models/bowed/bowed~.c $(sdk)
+bowedbar~.sources := $(src)/1_Physical_Models/bowedbar/bowedbar~.c $(sdk)
+brass~.sources := $(src)/1_Physical_Models/brass/brass~.c $(sdk)
+clarinet~.sources := $(src)/1_Physical_Models/clarinet/clar~.c $(sdk)
+flute~.sources := $(src)/1_Physical_Models/flute/flute~.c $(sdk)
+mandolin~.sources := $(src)/1_Physical_Models/mandolin/mandolin~.c $(sdk)
+plucked~.sources := $(src)/1_Physical_Models/plucked/plucked~.c $(sdk)
+
+# 2_Modal_Synthesis
+agogo~.sources := $(src)/2_Modal_Synthesis/agogo/agogo~.c $(sdk)
+marimba~.sources := $(src)/2_Modal_Synthesis/marimba/marimba~.c $(sdk)
+vibraphone~.sources := $(src)/2_Modal_Synthesis/vibraphone/vibraphone~.c $(sdk)
+
+# 3_PhISM
+bamboo~.sources := $(src)/3_PhISM/bamboo/bamboo~.c $(sdk)
+cabasa~.sources := $(src)/3_PhISM/cabasa/cabasa~.c $(sdk)
+guiro~.sources := $(src)/3_PhISM/guiro/guiro~.c $(sdk)
+metashake~.sources := $(src)/3_PhISM/meta-shaker/metashake~.c $(sdk)
+sekere~.sources := $(src)/3_PhISM/sekere/sekere~.c $(sdk)
+shaker~.sources := $(src)/3_PhISM/shaker/shaker~.c $(sdk)
+sleigh~.sources := $(src)/3_PhISM/sleighbells/sleigh~.c $(sdk)
+tamb~.sources := $(src)/3_PhISM/tamb/tamb~.c $(sdk)
+
+# 5_SID
+chase~.sources := $(src)/5_SID/chase~/chase~.c
+klutz~.sources := $(src)/5_SID/klutz~/klutz~.c
+
+# 6_Random_DSP
+gQ~.sources := $(src)/6_Random_DSP/gQ/gQ~.c $(sdk)
+munger~.sources := $(src)/6_Random_DSP/munger/munger~.c $(sdk)
+
+OBJECTS ?= blotar~ bowed~ bowedbar~ brass~ clarinet~ flute~ mandolin~ \
+	plucked~ agogo~ marimba~ vibraphone~ bamboo~ cabasa~ guiro~ \
+	metashake~ sekere~ shaker~ sleigh~ tamb~ chase~ klutz~ gQ~ munger~
@@ -0,0 +1,383 @@
+/********************************************/
+/*  A stand-in for the Pd runtime, enough   */
+/*  to make one object, hand it messages    */
+/*  and run its dsp chain outside of Pd.    */
+/*  Allocations are counted so the bench    */
+/*  can tell setup from perform-time ones.  */
+/********************************************/
+
+#include "pdstub.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+t_symbol s_float = {"float"};
+t_symbol s_signal = {"signal"};
+t_symbol s_list = {"list"};
+t_symbol s_bang = {"bang"};
+t_symbol s_symbol = {"symbol"};
+
+t_class *stub_class;
+int stub_sigin, stub_sigout;
+t_stubperform stub_chain[STUB_MAXCHAIN];
+int stub_nchain;
+long stub_allocs, stub_allocbytes, stub_freedbytes;
+t_float stub_srate = 44100.;
+
+/* -------------------------------- symbols -------------------------------- */
+
+typedef struct _stubsym {
+    t_symbol sym;
+    struct _stubsym *next;
+} t_stubsym;
+
+static t_stubsym *stub_symbols;
+
+t_symbol *gensym(const char *s) {
+    t_stubsym *sym;
+    for (sym = stub_symbols; sym; sym = sym->next)
+        if (!strcmp(sym->sym.s_name, s))
+            return &sym->sym;
+    sym = malloc(sizeof(t_stubsym));
+    sym->sym.s_name = strdup(s);
+    sym->next = stub_symbols;
+    stub_symbols = sym;
+    return &sym->sym;
+}
+
+/* -------------------------------- classes -------------------------------- */
+
+static int stub_countargs(t_atomtype arg, va_list ap, int *gimme) {
+    int n = 0;
+    *gimme = 0;
+    while (arg != A_NULL) {
+        if (arg == A_GIMME)
+            *gimme = 1;
+        else if (arg == A_FLOAT || arg == A_DEFFLOAT)
+            n++;
+        arg = va_arg(ap, t_atomtype);
+    }
+    return n;
+}
+
+t_class *class_new(t_symbol *name, t_newmethod newmethod, t_method freemethod,
+                   size_t size, int flags, t_atomtype arg1, ...) {
+    va_list ap;
+    t_class *c = calloc(1, sizeof(t_class));
+    c->name = name;
+    c->newmethod = newmethod;
+    c->freemethod = freemethod;
+    c->size = size;
+    va_start(ap, arg1);
+    c->nargs = stub_countargs(arg1, ap, &c->gimme);
+    va_end(ap);
+    stub_class = c;
+    return c;
+}
+
+void class_addmethod(t_class *c, t_method fn, t_symbol *sel, t_atomtype arg1,
+                     ...) {
+    va_list ap;
+    t_stubmethod *m;
+    if (c->nmethods == STUB_MAXMETHODS) {
+        fprintf(stderr, "pdstub: %s has too many methods\n", c->name->s_name);
+        return;
+    }
+    m = &c->methods[c->nmethods++];
+    m->sel = sel;
+    m->fn = fn;
+    va_start(ap, arg1);
+    m->nargs = stub_countargs(arg1, ap, &m->gimme);
+    va_end(ap);
+    if (sel == &s_signal || !strcmp(sel->s_name, "signal"))
+        c->mainsignalin = 1;
+}
+
+void class_addbang(t_class *c, t_method fn) { c->bangmethod = fn; }
+void class_addfloat(t_class *c, t_method fn) { c->floatmethod = fn; }
+void class_addlist(t_class *c, t_method fn) { c->listmethod = fn; }
+void class_addanything(t_class *c, t_method fn) {}
+void class_sethelpsymbol(t_class *c, t_symbol *s) {}
+void class_domainsignalin(t_class *c, int onset) { c->mainsignalin = 1; }
+void nullfn(void) {}
+
+t_pd *pd_new(t_class *c) {
+    t_object *x = getbytes(c->size);
+    x->ob_pd = c;
+    stub_sigin = c->mainsignalin;
+    stub_sigout = 0;
+    return &x->ob_pd;
+}
+
+void pd_bind(t_pd *x, t_symbol *s) {}
+void pd_unbind(t_pd *x, t_symbol *s) {}
+
+/* ---------------------------- inlets, outlets ----------------------------- */
+
+static int stub_issignal(t_symbol *s) {
+    return s && (s == &s_signal || !strcmp(s->s_name, "signal"));
+}
+
+t_outlet *outlet_new(t_object *owner, t_symbol *s) {
+    if (stub_issignal(s))
+        stub_sigout++;
+    return (t_outlet *)owner;
+}
+
+t_inlet *inlet_new(t_object *owner, t_pd *dest, t_symbol *s1, t_symbol *s2) {
+    if (stub_issignal(s1))
+        stub_sigin++;
+    return (t_inlet *)owner;
+}
+
+t_inlet *floatinlet_new(t_object *owner, t_float *fp) {
+    return (t_inlet *)owner;
+}
+
+void outlet_bang(t_outlet *x) {}
+void outlet_float(t_outlet *x, t_float f) {}
+void outlet_list(t_outlet *x, t_symbol *s, int argc, t_atom *argv) {}
+
+/* -------------------------------- console -------------------------------- */
+
+void post(const char *fmt, ...) {}
+
+void error(const char *fmt, ...) {
+    va_list ap;
+    va_start(ap, fmt);
+    vfprintf(stderr, fmt, ap);
+    va_end(ap);
+    fputc('\n', stderr);
+}
+
+void pd_error(const void *object, const char *fmt, ...) {
+    va_list ap;
+    va_start(ap, fmt);
+    vfprintf(stderr, fmt, ap);
+    va_end(ap);
+    fputc('\n', stderr);
+}
+
+/* -------------------------------- memory --------------------------------- */
+
+void *getbytes(size_t nbytes) {
+    stub_allocs++;
+    stub_allocbytes += nbytes;
+    return calloc(1, nbytes ? nbytes : 1);
+}
+
+void *resizebytes(void *old, size_t oldsize, size_t newsize) {
+    void *x = realloc(old, newsize ? newsize : 1);
+    if (x && newsize > oldsize)
+        memset((char *)x + oldsize, 0, newsize - oldsize);
+    stub_allocs++;
+    stub_allocbytes += newsize;
+    stub_freedbytes += oldsize;
+    return x;
+}
+
+void freebytes(void *x, size_t nbytes) {
+    stub_freedbytes += nbytes;
+    free(x);
+}
+
+/* --------------------------------- atoms --------------------------------- */
+
+t_float atom_getfloat(const t_atom *a) {
+    return a->a_type == A_FLOAT ? a->a_w.w_float : 0;
+}
+
+t_float atom_getfloatarg(int which, int argc, const t_atom *argv) {
+    return which < argc ? atom_getfloat(argv + which) : 0;
+}
+
+t_symbol *atom_getsymbolarg(int which, int argc, const t_atom *argv) {
+    if (which < argc && argv[which].a_type == A_SYMBOL)
+        return argv[which].a_w.w_symbol;
+    return &s_symbol;
+}
+
+/* ---------------------------------- dsp ---------------------------------- */
+
+t_float sys_getsr(void) { return stub_srate; }
+
+// one step per tick, all that objects can tell apart
+static double stub_time;
+
+double clock_getlogicaltime(void) { return stub_time; }
+
+void dsp_addv(t_perfroutine f, int n, t_int *vec) {
+    int i;
+    if (stub_nchain == STUB_MAXCHAIN || n > STUB_MAXARGS) {
+        fprintf(stderr, "pdstub: dsp chain too long\n");
+        return;
+    }
+    stub_chain[stub_nchain].f = f;
+    for (i = 0; i < n; i++)
+        stub_chain[stub_nchain].w[i + 1] = vec[i];
+    stub_nchain++;
+}
+
+void dsp_add(t_perfroutine f, int n, ...) {
+    t_int vec[STUB_MAXARGS];
+    va_list ap;
+    int i;
+    va_start(ap, n);
+    for (i = 0; i < n && i < STUB_MAXARGS; i++)
+        vec[i] = va_arg(ap, t_int);
+    va_end(ap);
+    dsp_addv(f, n, vec);
+}
+
+/* --------------------------------- arrays -------------------------------- */
+
+struct _garray {
+    t_symbol *name;
+    int size;
+    t_word *vec;
+    struct _garray *next;
+};
+
+t_class *garray_class;
+static t_garray *stub_arrays;
+
+t_garray *stub_array(t_symbol *name, int size) {
+    t_garray *a = calloc(1, sizeof(t_garray));
+    a->name = name;
+    a->size = size;
+    a->vec = calloc(size ? size : 1, sizeof(t_word));
+    a->next = stub_arrays;
+    stub_arrays = a;
+    return a;
+}
+
+void *pd_findbyclass(t_symbol *s, const t_class *c) {
+    t_garray *a;
+    if (c != garray_class)
+        return 0;
+    for (a = stub_arrays; a; a = a->next)
+        if (a->name == s)
+            return a;
+    return 0;
+}
+
+int garray_getfloatwords(t_garray *x, int *size, t_word **vec) {
+    *size = x->size;
+    *vec = x->vec;
+    return 1;
+}
+
+// like Pd, only works where a t_word is a float
+int garray_getfloatarray(t_garray *x, int *size, t_float **vec) {
+    if (sizeof(t_word) != sizeof(t_float)) {
+        error("%s: not a float array on this platform", x->name->s_name);
+        return 0;
+    }
+    *size = x->size;
+    *vec = (t_float *)x->vec;
+    return 1;
+}
+
+void garray_resize_long(t_garray *x, long n) {
+    t_word *vec = calloc(n ? n : 1, sizeof(t_word));
+    memcpy(vec, x->vec, (n < x->size ? n : x->size) * sizeof(t_word));
+    free(x->vec);
+    x->vec = vec;
+    x->size = (int)n;
+}
+
+void garray_redraw(t_garray *x) {}
+void garray_usedindsp(t_garray *x) {}
+
+/* ------------------------------ bench hooks ------------------------------ */
+
+typedef void *(*t_newgimme)(t_symbol *s, int argc, t_atom *argv);
+typedef void *(*t_newfloats)(t_floatarg, t_floatarg, t_floatarg, t_floatarg,
+                             t_floatarg);
+typedef void (*t_methgimme)(void *x, t_symbol *s, int argc, t_atom *argv);
+typedef void (*t_methfloats)(void *x, t_floatarg, t_floatarg, t_floatarg,
+                             t_floatarg, t_floatarg);
+
+static void stub_atoms(int argc, t_float *argv, t_atom *atoms) {
+    int i;
+    for (i = 0; i < argc; i++)
+        SETFLOAT(atoms + i, argv[i]);
+}
+
+// creation arguments past argc are 0, as with A_DEFFLOAT
+void *stub_new(int argc, t_float *argv) {
+    t_class *c = stub_class;
+    t_atom atoms[STUB_MAXARGS];
+    t_float f[5] = {0, 0, 0, 0, 0};
+    int i;
+
+    stub_nchain = 0;
+    if (c->gimme) {
+        stub_atoms(argc, argv, atoms);
+        return ((t_newgimme)c->newmethod)(c->name, argc, atoms);
+    }
+    for (i = 0; i < argc && i < 5; i++)
+        f[i] = argv[i];
+    return ((t_newfloats)c->newmethod)(f[0], f[1], f[2], f[3], f[4]);
+}
+
+int stub_send(void *x, const char *sel, int argc, t_float *argv) {
+    t_class *c = stub_class;
+    t_atom atoms[STUB_MAXARGS];
+    t_float f[5] = {0, 0, 0, 0, 0};
+    t_stubmethod *m;
+    int i;
+
+    if (!strcmp(sel, "bang") && c->bangmethod) {
+        ((void (*)(void *))c->bangmethod)(x);
+        return 1;
+    }
+    if (!strcmp(sel, "float") && c->floatmethod) {
+        ((void (*)(void *, t_floatarg))c->floatmethod)(x, argc ? argv[0] : 0);
+        return 1;
+    }
+    for (m = c->methods; m < c->methods + c->nmethods; m++) {
+        if (strcmp(m->sel->s_name, sel))
+            continue;
+        if (m->gimme) {
+            stub_atoms(argc, argv, atoms);
+            ((t_methgimme)m->fn)(x, m->sel, argc, atoms);
+        } else {
+            for (i = 0; i < argc && i < m->nargs && i < 5; i++)
+                f[i] = argv[i];
+            ((t_methfloats)m->fn)(x, f[0], f[1], f[2], f[3], f[4]);
+        }
+        return 1;
+    }
+    fprintf(stderr, "%s: no method for '%s'\n", c->name->s_name, sel);
+    return 0;
+}
+
+// sp holds the signal inlets, then the signal outlets, as in Pd
+void stub_dsp(void *x, t_signal **sp) {
+    t_class *c = stub_class;
+    t_stubmethod *m;
+
+    stub_nchain = 0;
+    for (m = c->methods; m < c->methods + c->nmethods; m++) {
+        if (!strcmp(m->sel->s_name, "dsp")) {
+            ((void (*)(void *, t_signal **))m->fn)(x, sp);
+            return;
+        }
+    }
+    fprintf(stderr, "%s: no dsp method\n", c->name->s_name);
+}
+
+void stub_tick(void) {
+    int i;
+    for (i = 0; i < stub_nchain; i++)
+        stub_chain[i].f(stub_chain[i].w);
+    stub_time += 1.;
+}
+
+void stub_free(void *x) {
+    if (stub_class->freemethod)
+        ((void (*)(void *))stub_class->freemethod)(x);
+    freebytes(x, stub_class->size);
+}
@@ -0,0 +1,65 @@
+/********************************************/
+/*  What the bench driver sees of the stub  */
+/*  runtime: the class tables, the dsp      */
+/*  chain and the allocation counters.      */
+/********************************************/
+
+#ifndef PDSTUB_H
+#define PDSTUB_H
+
+#include "m_pd.h"
+
+#define STUB_MAXMETHODS 64
+#define STUB_MAXSIGNALS 16
+#define STUB_MAXCHAIN 16
+#define STUB_MAXARGS 16
+
+typedef struct _stubmethod {
+    t_symbol *sel;
+    t_method fn;
+    int nargs; // float arguments, 0 when gimme
+    int gimme;
+} t_stubmethod;
+
+struct _class {
+    t_symbol *name;
+    t_newmethod newmethod;
+    t_method freemethod;
+    size_t size;
+    int nargs; // creation arguments
+    int gimme;
+    int mainsignalin;
+
+    t_stubmethod methods[STUB_MAXMETHODS];
+    int nmethods;
+    t_method bangmethod, floatmethod, listmethod;
+};
+
+typedef struct _stubperform {
+    t_perfroutine f;
+    t_int w[STUB_MAXARGS + 1];
+} t_stubperform;
+
+// the class registered last by the setup routine
+extern t_class *stub_class;
+
+// signal inlets and outlets of the object made last
+extern int stub_sigin, stub_sigout;
+
+// the dsp chain built by the dsp method
+extern t_stubperform stub_chain[STUB_MAXCHAIN];
+extern int stub_nchain;
+
+// everything that went through getbytes/resizebytes/freebytes
+extern long stub_allocs, stub_allocbytes, stub_freedbytes;
+
+extern t_float stub_srate;
+
+t_garray *stub_array(t_symbol *name, int size);
+void *stub_new(int argc, t_float *argv);
+int stub_send(void *x, const char *sel, int argc, t_float *argv);
+void stub_dsp(void *x, t_signal **sp);
+void stub_tick(void);
+void stub_free(void *x);
+
+#endif // PDSTUB_H
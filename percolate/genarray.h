@@ -0,0 +1,52 @@
+/********************************************/
+/*  'set' for the Pd gens: write the whole  */
+/*  table straight into a named array,      */
+/*  instead of one index/value list per     */
+/*  point. Shared by gen5, 7, 9, 10, 17,    */
+/*  20, 24 and 25.                          */
+/********************************************/
+
+#ifndef GENARRAY_H
+#define GENARRAY_H
+
+#include "m_pd.h"
+
+// write the n points of table into array s in one go, start points in,
+// growing the array if it is too short, or, with fit, sizing it to end
+// with the table. errors are reported as gen's
+static inline void gen_writearray(void *x, const char *gen, t_symbol *s,
+	const float *table, long n, long start, int fit)
+{
+	t_garray *a;
+	t_word *vec;
+	int size;
+	long i;
+
+	if (start < 0) start = 0;
+	if (!(a = (t_garray *)pd_findbyclass(s, garray_class)))
+	{
+		pd_error(x, "%s: no array %s", gen, s->s_name);
+		return;
+	}
+	if (!garray_getfloatwords(a, &size, &vec))
+	{
+		pd_error(x, "%s: bad template for %s", gen, s->s_name);
+		return;
+	}
+	if (start + n > size || (fit && start + n != size))
+	{
+		garray_resize_long(a, start + n);
+		garray_getfloatwords(a, &size, &vec);
+	}
+	for (i = 0; i < n; i++)
+		vec[start + i].w_float = table[i];
+	garray_redraw(a);
+}
+
+// 'set <array>' writes into that array, 'set' alone goes back to list output
+static inline void gen_set(t_symbol **array, t_symbol *s)
+{
+	*array = *s->s_name ? s : 0;
+}
+
+#endif // GENARRAY_H
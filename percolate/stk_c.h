@@ -39,13 +39,21 @@
 // #define PI 3.141592654
 #define TWO_PI 6.283185307
 #define RAWWAVE_PATH ":externals:audio:PeRColate_objects:rawwaves"
-// #define ONE_OVER_RANDLIMIT 0.00006103516 // constant = 1. / 16384.0
-#define ONE_OVER_RANDLIMIT 1. / (RAND_MAX * 0.5)
+#define STK_BLOCKSIZE 64    // scratch length used by the block (tickBlock) functions
+#define STK_TABLE_ALIGN 64    // shared tables start on a cache line
+#define STK_SILENCE_THRESHOLD 0.00001    // -100 dB, default level for sleeping
+#define STK_SILENCE_HOLD 4096            // samples below it before sleeping
 
 enum { ATTACK, DECAY, SUSTAIN, RELEASE, DONE };
 
 /****TYPEDEFS****/
 
+// Noise
+typedef struct _noise {
+	unsigned int state;    // xorshift32 state, never 0
+	float        lastOutput;
+} Noise;
+
 // ADSR
 typedef struct _ADSR {
 	float value;
@@ -82,6 +90,16 @@ typedef struct _biquad {
 	float gain;
 } BiQuad;
 
+// BiQuad4: four BiQuads on one input, [coefficient][filter] so each
+// row is one 4 wide vector
+typedef struct _biquad4 {
+	float poleCoeffs[2][4];
+	float zeroCoeffs[2][4];
+	float inputs[2][4];
+	float gain[4];
+	float lastOutput;    // sum of the four
+} BiQuad4;
+
 // Bow Table
 typedef struct _bowtabl {
 	float offSet;
@@ -116,6 +134,18 @@ typedef struct _dlineA {
 	double  lastOutput;
 } DLineA;
 
+// DLineAf: DLineA in single precision
+typedef struct _dlineAf {
+	float* inputs;
+	long   inPoint;
+	long   outPoint;
+	long   length;
+	float  alpha;
+	float  coeff;
+	float  lastIn;
+	float  lastOutput;
+} DLineAf;
+
 // DLineL: delay line with allpass interpolation
 typedef struct _dlineL {
 	float* inputs;      // delay line buffer
@@ -137,6 +167,20 @@ typedef struct _dlineN {
 	float  lastOutput;
 } DLineN;
 
+// DLineP: linearly interpolating delay line on a power-of-two buffer,
+// indexed with a mask; one guard sample past the end mirrors the first,
+// so the interpolation never wraps
+typedef struct _dlineP {
+	float* inputs;      // size + 1 samples, the last is the guard
+	long   size;        // power of two
+	long   mask;        // size - 1
+	long   length;      // longest delay + 1, as for DLineL
+	long   inPoint;
+	long   back;        // the read is this far behind inPoint
+	float  alpha, omAlpha;
+	float  lastOutput;
+} DLineP;
+
 // RawWvIn
 typedef struct _rawwWvIn {
 	long   length;
@@ -152,6 +196,18 @@ typedef struct _rawwWvIn {
 } RawWvIn;
 
 
+// StkTable: one normalized copy of a header table, shared by HeaderSnds
+typedef struct _stkTable {
+	float*             source;     // array it was made from, the lookup key
+	long               length;     // without the interpolation guard sample
+	int                looping;
+	int                refs;
+	float*             data;       // aligned to STK_TABLE_ALIGN inside mem
+	void*              mem;
+	size_t             memsize;
+	struct _stkTable*  next;
+} StkTable;
+
 // HeaderSnd
 typedef struct _headerSnd {
 	long   length;
@@ -159,11 +215,12 @@ typedef struct _headerSnd {
 	int    looping;
 	int    finished;
 	int    interpolate;
-	float* data;
+	float* data;     // table->data, read only
 	float  time;
 	float  rate;
 	float  phaseOffset;
 	float  lastOutput;
+	StkTable* table;
 } HeaderSnd;
 
 // Envelope
@@ -178,7 +235,7 @@ typedef struct _envelope {
 typedef struct _modal4 {
 	Envelope  envelope;
 	HeaderSnd wave;
-	BiQuad    filters[4];
+	BiQuad4   filters;
 	OnePole   onepole;
 	HeaderSnd vibr;
 	float     srate;
@@ -193,6 +250,23 @@ typedef struct _modal4 {
 	float     resons[4];
 } Modal4;
 
+// VoicePool: note to voice bookkeeping for the polyphonic objects
+typedef struct _voicePool {
+	int    nvoices;
+	long   clock;      // counts note ons and offs
+	long*  onTime;     // per voice, clock at note on, 0 = never used
+	long*  offTime;    // per voice, clock at note off, 0 = still held
+	float* key;        // per voice, the note (frequency) it plays
+} VoicePool;
+
+// Silence: sleep state for objects and voices that have died away
+typedef struct _silence {
+	float threshold;    // peak level that counts as silent, 0 = never sleep
+	long  hold;         // samples below threshold before sleeping
+	long  quiet;        // samples below threshold so far
+	int   asleep;       // skip the DSP and zero-fill while set
+} Silence;
+
 /***PROTOTYPES***/
 
 // ADSR
@@ -212,6 +286,7 @@ void  ADSR_setValue(ADSR* adsr, float aValue);
 int   ADSR_getState(ADSR* adsr);
 float ADSR_tick(ADSR* adsr);
 float ADSR_ADRtick(ADSR* adsr);
+void  ADSR_tickBlock(ADSR* adsr, float* out, int n);
 
 // Bow Table
 void  BowTabl_init(BowTabl* bowtable);
@@ -231,23 +306,32 @@ float LipFilt_tick(LipFilt* lipfilt, float mouthSample, float boreSample);
 float JetTabl_lookup(float sample);
 
 // Noise
-float Noise_tick();
+void         Noise_init(Noise* noise, unsigned int seed);    // seed 0 picks a fresh one
+void         Noise_seed(Noise* noise, unsigned int seed);
+unsigned int Noise_next(Noise* noise);             // raw 32 bit value
+float        Noise_tick(Noise* noise);             // uniform, -1. to 1.
+void         Noise_tickBlock(Noise* noise, float* out, int n);
+float        Noise_uniform(Noise* noise);          // uniform, 0. to 1.
+int          Noise_random(Noise* noise, int max);  // integer, 0 to max - 1
 
 // OneZero
 void  OneZero_init(OneZero* onezero);
 void  OneZero_setGain(OneZero* onezero, float aValue);
 void  OneZero_setCoeff(OneZero* onezero, float aValue);
 float OneZero_tick(OneZero* onezero, float sample);    // Perform Filter Operation
+void  OneZero_tickBlock(OneZero* onezero, const float* in, float* out, int n);
 
 // OnePole
 void  OnePole_init(OnePole* onepole);
 void  OnePole_setPole(OnePole* onepole, float aValue);
 void  OnePole_setGain(OnePole* onepole, float aValue);
 float OnePole_tick(OnePole* onepole, float sample);    // Perform Filter Operation
+void  OnePole_tickBlock(OnePole* onepole, const float* in, float* out, int n);
 void  OnePole_clear(OnePole* onepole);
 
 // DCBlock functions
 float DCBlock_tick(DCBlock* dcblock, float sample);
+void  DCBlock_tickBlock(DCBlock* dcblock, const float* in, float* out, int n);
 void  DCBlock_clear(DCBlock* dcblock);
 
 // BiQuad functions
@@ -259,27 +343,64 @@ void  BiQuad_setGain(BiQuad* biquad, float aValue);
 void  BiQuad_setFreqAndReson(BiQuad* biquad, float freq, float reson, float srate);
 void  BiQuad_setEqualGainZeroes(BiQuad* biquad);
 float BiQuad_tick(BiQuad* biquad, float sample);
+void  BiQuad_tickBlock(BiQuad* biquad, const float* in, float* out, int n);
+
+// BiQuad4 functions
+void  BiQuad4_init(BiQuad4* bank);
+void  BiQuad4_clear(BiQuad4* bank);
+void  BiQuad4_setFreqAndReson(BiQuad4* bank, int whichOne, float freq, float reson, float srate);
+void  BiQuad4_setEqualGainZeroes(BiQuad4* bank);
+void  BiQuad4_setGain(BiQuad4* bank, int whichOne, float aValue);
+float BiQuad4_tick(BiQuad4* bank, float sample);
+void  BiQuad4_tickBlock(BiQuad4* bank, const float* in, float* out, int n);
 
 // DlineA functions
 void  DLineA_alloc(DLineA* delayLine, long max_length);
 void  DLineA_free(DLineA* delayLine);
+void  DLineA_resize(DLineA* delayLine, long max_length);    // reallocates only on a change
 void  DLineA_clear(DLineA* delayLine);
 void  DLineA_setDelay(DLineA* delayLine, double lag);
 float DLineA_tick(DLineA* delayLine, double sample);
+void  DLineA_tickBlock(DLineA* delayLine, const float* in, float* out, int n);
+
+// DLineAf functions
+void  DLineAf_alloc(DLineAf* delayLine, long max_length);
+void  DLineAf_free(DLineAf* delayLine);
+void  DLineAf_resize(DLineAf* delayLine, long max_length);
+void  DLineAf_clear(DLineAf* delayLine);
+void  DLineAf_setDelay(DLineAf* delayLine, double lag);
+float DLineAf_tick(DLineAf* delayLine, float sample);
+void  DLineAf_tickBlock(DLineAf* delayLine, const float* in, float* out, int n);
 
 // DlineL functions
 void  DLineL_alloc(DLineL* delayLine, long max_length);
 void  DLineL_free(DLineL* delayLine);
+void  DLineL_resize(DLineL* delayLine, long max_length);
 void  DLineL_clear(DLineL* delayLine);
 void  DLineL_setDelay(DLineL* delayLine, float lag);
 float DLineL_tick(DLineL* delayLine, float sample);
+void  DLineL_tickBlock(DLineL* delayLine, const float* in, float* out, int n);
 
 // DLine N functions
 void  DLineN_alloc(DLineN* delayLine, long max_length);
 void  DLineN_free(DLineN* delayLine);
+void  DLineN_resize(DLineN* delayLine, long max_length);
 void  DLineN_clear(DLineN* delayLine);
 void  DLineN_setDelay(DLineN* delayLine, float lag);
 float DLineN_tick(DLineN* delayLine, float sample);
+void  DLineN_tickBlock(DLineN* delayLine, const float* in, float* out, int n);
+
+// DLineP functions, a drop-in for DLineL (and DLineN, with whole lags)
+void  DLineP_alloc(DLineP* delayLine, long max_length);
+void  DLineP_free(DLineP* delayLine);
+void  DLineP_resize(DLineP* delayLine, long max_length);
+void  DLineP_clear(DLineP* delayLine);
+void  DLineP_setDelay(DLineP* delayLine, float lag);
+float DLineP_tick(DLineP* delayLine, float sample);
+void  DLineP_tickBlock(DLineP* delayLine, const float* in, float* out, int n);
+
+// delay lengths, for any of them
+long  DLine_lengthFor(float srate, float lowest, float periods, long extra);
 
 // RawWvIn functions
 void  RawWvIn_alloc(RawWvIn* inwave, char* fileName, char* mode);
@@ -288,16 +409,25 @@ void  RawWvIn_normalize(RawWvIn* inwave, float newPeak);
 void  RawWvIn_setRate(RawWvIn* inwave, float aRate);
 void  RawWvIn_reset(RawWvIn* inwave);
 int   RawWvIn_informTick(RawWvIn* inwave);
+int   RawWvIn_tickBlock(RawWvIn* inwave, float* out, int n);
 float RawWvIn_tick(RawWvIn* inwave);
 void  RawWvIn_setFreq(RawWvIn* inwave, float aFreq, float srate);
 
+// StkTable functions
+StkTable* StkTable_acquire(float* sndarray, long arraylen, int looping);
+void      StkTable_release(StkTable* table);
+
+// StkLock: one process-wide lock for state shared across Pd instances
+void StkLock_lock(void);
+void StkLock_unlock(void);
+
 // HeaderSnd functions
 void  HeaderSnd_alloc(HeaderSnd* inwave, float* sndarray, long arraylen, char* mode);
 void  HeaderSnd_free(HeaderSnd* inwave);
-void  HeaderSnd_normalize(HeaderSnd* inwave, float newPeak);
 void  HeaderSnd_setRate(HeaderSnd* inwave, float aRate);
 void  HeaderSnd_reset(HeaderSnd* inwave);
 int   HeaderSnd_informTick(HeaderSnd* inwave);
+int   HeaderSnd_tickBlock(HeaderSnd* inwave, float* out, int n);
 float HeaderSnd_tick(HeaderSnd* inwave);
 void  HeaderSnd_setFreq(HeaderSnd* inwave, float aFreq, float srate);
 
@@ -311,6 +441,7 @@ void  Envelope_setTime(Envelope* env, float aTime, int srate);
 void  Envelope_setTarget(Envelope* env, float aTarget);
 void  Envelope_setValue(Envelope* env, float aValue);
 float Envelope_tick(Envelope* env);
+void  Envelope_tickBlock(Envelope* env, float* out, int n);
 int   Envelope_informTick(Envelope* env);
 float Envelope_lastOut(Envelope* env);
 
@@ -327,6 +458,32 @@ void  Modal4_noteOn(Modal4* modal, float freq, float amp);
 void  Modal4_noteOff(Modal4* modal, float amp); /*  This calls damp, but inverts the    */
 void  Modal4_damp(Modal4* modal, float amplitude);
 float Modal4_tick(Modal4* modal);
+void  Modal4_tickBlock(Modal4* modal, float* out, int n);
+
+// VoicePool
+int   VoicePool_alloc(VoicePool* pool, int nvoices);
+void  VoicePool_free(VoicePool* pool);
+void  VoicePool_clear(VoicePool* pool);
+int   VoicePool_noteOn(VoicePool* pool, float key);
+int   VoicePool_noteOff(VoicePool* pool, float key);
+int   VoicePool_active(VoicePool* pool, int voice);
+
+// Silence
+void  Silence_init(Silence* silence);
+void  Silence_setThreshold(Silence* silence, float threshold);
+void  Silence_wake(Silence* silence);
+void  Silence_check(Silence* silence, const float* out, int n, float excitation);
+int   Silence_sleeping(Silence* silence, float excitation);
+
+// Denormals
+unsigned long Denormals_off(void);
+void  Denormals_restore(unsigned long mode);
+void  Denormals_dspAdd(t_perfroutine perform, int n, ...);    // dsp_add, run with subnormals flushed
+
+// Coeff
+void   Coeff_sincos(double w, double* s, double* c);    // of w radians, as libm's to a double's last bits
+double Coeff_cos(double w);
+double Coeff_tan(double w);
 
 // non-linear interpolation algorithms
 float  polyinterpolate(float ya[], int n, long vsize, float x);
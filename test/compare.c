@@ -0,0 +1,108 @@
+/********************************************/
+/*  Compares a render with its golden       */
+/*  reference, both raw 32 bit floats:      */
+/*                                          */
+/*    compare [-ulp n | -snr db] name       */
+/*            golden.raw render.raw         */
+/*                                          */
+/*  Bit-exact unless told otherwise. -ulp   */
+/*  allows every sample to be n units in    */
+/*  the last place off, -snr wants the      */
+/*  error at least db below the signal.     */
+/*  Exits 1 on a mismatch.                  */
+/********************************************/
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static float *compare_read(const char *path, long *n) {
+    FILE *fd = fopen(path, "rb");
+    float *buf;
+    long size;
+
+    if (!fd) {
+        perror(path);
+        exit(2);
+    }
+    fseek(fd, 0, SEEK_END);
+    size = ftell(fd);
+    fseek(fd, 0, SEEK_SET);
+    buf = malloc(size ? size : 1);
+    *n = (long)fread(buf, sizeof(float), size / sizeof(float), fd);
+    fclose(fd);
+    return buf;
+}
+
+// floats as integers that count up with the value, so the difference of
+// two of them is the number of floats in between
+static int64_t compare_ordered(float f) {
+    int32_t i;
+    memcpy(&i, &f, sizeof(i));
+    return i < 0 ? (int64_t)INT32_MIN - i : i;
+}
+
+int main(int argc, char **argv) {
+    const char *name, *golden, *render;
+    float *a, *b;
+    long na, nb, i, first = -1;
+    int64_t ulp, maxulp = 0, allowed = 0;
+    double signal = 0., noise = 0., snr, minsnr = 0.;
+    int mode = 0; // 0 exact, 1 ulp, 2 snr
+    int ok;
+
+    if (argc == 6 && !strcmp(argv[1], "-ulp")) {
+        mode = 1;
+        allowed = atol(argv[2]);
+        argv += 2;
+    } else if (argc == 6 && !strcmp(argv[1], "-snr")) {
+        mode = 2;
+        minsnr = atof(argv[2]);
+        argv += 2;
+    } else if (argc != 4) {
+        fprintf(stderr, "usage: compare [-ulp n | -snr db] name golden.raw "
+                        "render.raw\n");
+        return 2;
+    }
+    name = argv[1];
+    golden = argv[2];
+    render = argv[3];
+
+    a = compare_read(golden, &na);
+    b = compare_read(render, &nb);
+    if (na != nb) {
+        printf("%-12s FAIL  %ld samples, golden has %ld\n", name, nb, na);
+        return 1;
+    }
+
+    for (i = 0; i < na; i++) {
+        if (memcmp(&a[i], &b[i], sizeof(float)) && first < 0)
+            first = i;
+        if (isnan(a[i]) || isnan(b[i]))
+            ulp = isnan(a[i]) && isnan(b[i]) ? 0 : INT64_MAX;
+        else
+            ulp = llabs(compare_ordered(a[i]) - compare_ordered(b[i]));
+        if (ulp > maxulp)
+            maxulp = ulp;
+        signal += (double)a[i] * a[i];
+        noise += ((double)a[i] - b[i]) * ((double)a[i] - b[i]);
+    }
+    snr = noise > 0. ? 10. * log10(signal / noise) : INFINITY;
+
+    if (mode == 0)
+        ok = first < 0;
+    else if (mode == 1)
+        ok = maxulp <= allowed;
+    else
+        ok = snr >= minsnr;
+
+    if (first < 0)
+        printf("%-12s ok    bit-exact\n", name);
+    else
+        printf("%-12s %-5s first difference at sample %ld, %lld ulp max, "
+               "snr %.1f dB\n",
+               name, ok ? "ok" : "FAIL", first, (long long)maxulp, snr);
+    return !ok;
+}
@@ -0,0 +1,141 @@
+/********************************************/
+/*  Checks DLineP, the power-of-two delay   */
+/*  line, against DLineL and DLineN.        */
+/*                                          */
+/*  Noise goes through both lines while the */
+/*  lag jumps about, fractional and whole,  */
+/*  from none to the longest. Fractional    */
+/*  lags have to stay within DLineL's own   */
+/*  rounding, which works the fraction out  */
+/*  next to the whole pointer and so loses  */
+/*  more of it the longer the line; DLineP  */
+/*  keeps all of it. Whole lags have to     */
+/*  match DLineN exactly, and tickBlock has */
+/*  to match tick exactly. Exits 1 on a     */
+/*  mismatch.                               */
+/********************************************/
+
+#include "pdstub.h"
+#include "stk_c.h"
+#include <float.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+// a float ulp of the pointer, for a step of 2 between samples
+#define DLINE_TOLERANCE(length) (4. * (length) * FLT_EPSILON)
+#define DLINE_SAMPLES 200000
+#define DLINE_HOLD 997 // samples between lag changes
+
+static unsigned int dline_seed = 12345;
+
+static float dline_noise(void) {
+    dline_seed = dline_seed * 1103515245u + 12345u;
+    return (float)(dline_seed >> 8) / (float)(1 << 23) - 1.;
+}
+
+static double dline_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+// a lag a line of length can hold, fractional or whole
+static float dline_lag(long length, int whole) {
+    float lag = (dline_noise() * .5 + .5) * (length - 1);
+    if (whole)
+        lag = floor(lag);
+    return lag;
+}
+
+static int dline_check(long length, double *maxerr, double *tp, double *tl) {
+    DLineL l;
+    DLineN dn;
+    DLineP p, pb;
+    static float in[DLINE_SAMPLES], outl[DLINE_SAMPLES], outp[DLINE_SAMPLES],
+        outb[DLINE_SAMPLES];
+    float lag;
+    double err, t;
+    long i, k, n;
+    int whole, ok = 1;
+
+    memset(&l, 0, sizeof(l));
+    memset(&dn, 0, sizeof(dn));
+    memset(&p, 0, sizeof(p));
+    memset(&pb, 0, sizeof(pb));
+    DLineL_alloc(&l, length);
+    DLineN_alloc(&dn, length - 1);
+    DLineP_alloc(&p, length);
+    DLineP_alloc(&pb, length);
+    for (i = 0; i < DLINE_SAMPLES; i++)
+        in[i] = dline_noise();
+
+    for (i = 0; i < DLINE_SAMPLES; i += DLINE_HOLD) {
+        n = DLINE_SAMPLES - i < DLINE_HOLD ? DLINE_SAMPLES - i : DLINE_HOLD;
+        whole = (i / DLINE_HOLD) % 3 == 0;
+        lag = dline_lag(length, whole);
+        DLineP_setDelay(&p, lag);
+        DLineP_setDelay(&pb, lag);
+
+        if (whole) {
+            DLineN_setDelay(&dn, lag);
+            for (k = 0; k < n; k++)
+                outl[i + k] = DLineN_tick(&dn, in[i + k]);
+            for (k = 0; k < n; k++)
+                DLineL_tick(&l, in[i + k]);
+        } else {
+            DLineL_setDelay(&l, lag);
+            t = dline_now();
+            for (k = 0; k < n; k++)
+                outl[i + k] = DLineL_tick(&l, in[i + k]);
+            *tl += dline_now() - t;
+            for (k = 0; k < n; k++)
+                DLineN_tick(&dn, in[i + k]);
+        }
+        t = dline_now();
+        for (k = 0; k < n; k++)
+            outp[i + k] = DLineP_tick(&p, in[i + k]);
+        if (!whole)
+            *tp += dline_now() - t;
+        for (k = 0; k < n; k += 64)
+            DLineP_tickBlock(&pb, in + i + k, outb + i + k,
+                             n - k < 64 ? n - k : 64);
+
+        for (k = 0; k < n; k++) {
+            err = fabs(outp[i + k] - outl[i + k]);
+            if ((whole && err != 0.) || !(err <= DLINE_TOLERANCE(length)) ||
+                outb[i + k] != outp[i + k]) {
+                if (ok)
+                    printf("%-12s FAIL  length %ld, lag %g, sample %ld: %g, "
+                           "%s %g, block %g\n",
+                           "dline", length, lag, i + k, outp[i + k],
+                           whole ? "DLineN" : "DLineL", outl[i + k],
+                           outb[i + k]);
+                ok = 0;
+            }
+            if (err > *maxerr)
+                *maxerr = err;
+        }
+    }
+
+    DLineL_free(&l);
+    DLineN_free(&dn);
+    DLineP_free(&p);
+    DLineP_free(&pb);
+    return ok;
+}
+
+int main(void) {
+    static const long lengths[] = {2, 3, 64, 100, 1024, 1025, 2048, 4100};
+    double maxerr = 0., tp = 0., tl = 0.;
+    int i, ok = 1;
+
+    for (i = 0; i < 8 && ok; i++)
+        ok = dline_check(lengths[i], &maxerr, &tp, &tl);
+    if (ok)
+        printf("%-12s ok    %.1e from DLineL at most, %.2f ms (DLineL %.2f "
+               "ms)\n",
+               "dline", maxerr, tp / 1e6, tl / 1e6);
+    return !ok;
+}
@@ -0,0 +1,196 @@
+/********************************************/
+/*  Checks a gen object's fast table        */
+/*  against the sin() loop it replaced.     */
+/*                                          */
+/*  Built once per gen with -DGEN=<name>    */
+/*  and -DGEN_REFERENCE, which keeps the    */
+/*  reference loop in the source. Every     */
+/*  point of every case has to be within    */
+/*  GEN_TOLERANCE of the reference, scaled  */
+/*  to its peak. The levels 'mip' writes    */
+/*  are checked the same way, against the   */
+/*  reference with the partials above each  */
+/*  level's cutoff left out. Exits 1 on a   */
+/*  mismatch.                               */
+/********************************************/
+
+#include "pdstub.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define GEN_STR(s) #s
+#define GEN_XSTR(s) GEN_STR(s)
+#define GEN_CAT(a, b) a##b
+#define GEN_XCAT(a, b) GEN_CAT(a, b)
+
+#include GEN_XSTR(../PeRColate_source/4_MaxGens/GEN/GEN.c)
+
+#define GEN_TOLERANCE 1e-5
+#define GEN_MAXARGS 64
+#define GEN_MIPLEVELS 6 // arrays made for 'mip', fewer than it could fill
+
+typedef struct _case {
+    int size;
+    int argc;
+    t_float argv[GEN_MAXARGS];
+} t_case;
+
+static double gen_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+// gen9 takes partial/amplitude/phase triples, gen10 harmonic amplitudes
+static int gen_cases(t_case *cases) {
+    static const int sizes[] = {32768, 512, 1000, 8192};
+    unsigned int seed = 12345;
+    int i, j, n = 0;
+
+    for (i = 0; i < 4; i++) {
+        t_case *c = &cases[n++];
+        c->size = sizes[i];
+#ifdef GEN_TRIPLES
+        c->argc = 63;
+        for (j = 0; j < c->argc; j += 3) {
+            seed = seed * 1103515245u + 12345u;
+            c->argv[j] = j / 3 + 1 + (seed >> 16) % 100 * 0.013;
+            c->argv[j + 1] = 1. / (j / 3 + 1);
+            c->argv[j + 2] = (seed >> 8) % 360;
+        }
+#else
+        c->argc = GEN_MAXARGS;
+        for (j = 0; j < c->argc; j++) {
+            seed = seed * 1103515245u + 12345u;
+            c->argv[j] = (j % 5 == 3) ? 0. : ((seed >> 16) % 1000) * 0.001;
+        }
+#endif
+    }
+    return n;
+}
+
+// leave out what lies above top, as 'mip' does
+static void gen_limit(GEN *x, const t_case *c, double top) {
+    int j;
+#ifdef GEN_TRIPLES
+    for (j = 0; j < c->argc; j += 3)
+        x->g_args[j + 1] = fabs(c->argv[j]) > top ? 0. : c->argv[j + 1];
+#else
+    for (j = 0; j < c->argc; j++)
+        x->g_args[j] = j + 1 > top ? 0. : c->argv[j];
+#endif
+}
+
+// every level against the reference, scaled by the peak of level 0
+static int gen_mipcheck(GEN *x, const t_case *c, double *maxerr) {
+    char name[MAXPDSTRING];
+    t_garray *a[GEN_MIPLEVELS + 1];
+    t_word *vec;
+    double err, peak = 0.;
+    int k, j, size;
+
+    for (k = 0; k <= GEN_MIPLEVELS; k++) {
+        sprintf(name, "mip-%d", k);
+        a[k] = k < GEN_MIPLEVELS ? stub_array(gensym(name), 1) : 0;
+    }
+    x->g_buffsize = c->size;
+    gen_limit(x, c, HUGE_VAL);
+    x->g_rescale = 1;
+    GEN_XCAT(GEN, _mip)(x, gensym("mip"));
+    x->g_rescale = 0;
+
+    for (k = 0; k < GEN_MIPLEVELS; k++) {
+        gen_limit(x, c, x->g_buffsize / (double)(2 << k));
+        GEN_XCAT(GEN, _sinetable)(x);
+        if (k == 0)
+            for (j = 0; j < x->g_buffsize; j++)
+                if (fabs(x->g_table[j]) > peak)
+                    peak = fabs(x->g_table[j]);
+        garray_getfloatwords(a[k], &size, &vec);
+        if (size != x->g_buffsize) {
+            printf("%-12s FAIL  mip level %d is %d points, not %ld\n",
+                   GEN_XSTR(GEN), k, size, x->g_buffsize);
+            return 0;
+        }
+        for (j = 0; j < size; j++) {
+            err = fabs(vec[j].w_float - x->g_table[j] / peak);
+            if (!(err <= GEN_TOLERANCE)) {
+                printf("%-12s FAIL  mip level %d, point %d: %g, reference "
+                       "%g\n",
+                       GEN_XSTR(GEN), k, j, vec[j].w_float,
+                       x->g_table[j] / peak);
+                return 0;
+            }
+            if (err > *maxerr)
+                *maxerr = err;
+        }
+    }
+    return 1;
+}
+
+int main(void) {
+    t_case cases[8];
+    t_atom argv[GEN_MAXARGS];
+    t_float *fast;
+    t_float a[2] = {32768, 0};
+    double err, maxerr = 0., peak, t, tfast = 0., tref = 0.;
+    int ncases, i, j, k, ok = 1;
+    GEN *x;
+
+    GEN_XCAT(GEN, _setup)();
+    x = (GEN *)stub_new(2, a);
+    x->g_rescale = 0;
+    fast = malloc(32768 * sizeof(t_float));
+    ncases = gen_cases(cases);
+
+    for (i = 0; i < ncases; i++) {
+        x->g_buffsize = cases[i].size;
+        for (j = 0; j < cases[i].argc; j++)
+            SETFLOAT(argv + j, cases[i].argv[j]);
+        for (j = 0; j < cases[i].argc; j++)
+            x->g_args[j] = cases[i].argv[j];
+#ifdef GEN_TRIPLES
+        x->g_numpoints = cases[i].argc;
+#else
+        x->g_numharmonics = cases[i].argc;
+#endif
+
+        t = gen_now();
+        GEN_XCAT(GEN, _table)(x, HUGE_VAL);
+        tfast += gen_now() - t;
+        memcpy(fast, x->g_table, x->g_buffsize * sizeof(t_float));
+
+        t = gen_now();
+        GEN_XCAT(GEN, _sinetable)(x);
+        tref += gen_now() - t;
+
+        peak = 0.;
+        for (k = 0; k < x->g_buffsize; k++)
+            if (fabs(x->g_table[k]) > peak)
+                peak = fabs(x->g_table[k]);
+        for (k = 0; k < x->g_buffsize; k++) {
+            err = fabs(fast[k] - x->g_table[k]) / (peak > 0. ? peak : 1.);
+            if (!(err <= GEN_TOLERANCE)) {
+                if (ok)
+                    printf("%-12s FAIL  size %ld, point %d: %g, reference %g\n",
+                           GEN_XSTR(GEN), x->g_buffsize, k, fast[k],
+                           x->g_table[k]);
+                ok = 0;
+            }
+            if (err > maxerr)
+                maxerr = err;
+        }
+    }
+    if (ok)
+        ok = gen_mipcheck(x, &cases[1], &maxerr);
+    if (ok)
+        printf("%-12s ok    %.1e of peak at most, %.2f ms (sin() loop %.2f ms)\n",
+               GEN_XSTR(GEN), maxerr, tfast / 1e6, tref / 1e6);
+
+    stub_free(x);
+    free(fast);
+    return !ok;
+}
@@ -0,0 +1,116 @@
+/********************************************/
+/*  Checks the response gQ~ reports against */
+/*  what its filters do.                    */
+/*                                          */
+/*  Four banks are set as in scripts/gQ~,   */
+/*  in series and then in parallel. A sine  */
+/*  at each of a few frequencies runs       */
+/*  through both channels until it settles, */
+/*  and the gain measured over the next     */
+/*  second has to be the one gq_response    */
+/*  gives, to GQ_TOLERANCE. Exits 1 on a    */
+/*  mismatch.                               */
+/********************************************/
+
+#include "pdstub.h"
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "../PeRColate_source/6_Random_DSP/gQ/gQ~.c"
+
+#define GQ_SR 64000
+#define GQ_N GQ_SR // a second, in whole blocks, so each frequency is a bin
+#define GQ_TOLERANCE 2e-4 // relative, under 0.002 dB
+
+static const t_float gq_freqs[] = {50, 200, 800, 1500, 2400, 6000, 12000};
+#define GQ_NFREQS (int)(sizeof(gq_freqs) / sizeof(gq_freqs[0]))
+
+static t_gq *gq_make(int parallel) {
+    static t_float banks[4][3] = {
+        {200, 0.2, 2}, {800, 0.2, 0.5}, {2400, 0.1, 3}, {6000, 0.3, 1.5}};
+    t_float a[2] = {4, 0}, f;
+    t_gq *x = (t_gq *)stub_new(2, a);
+    int i;
+
+    f = parallel;
+    stub_send(x, "parallel", 1, &f);
+    for (i = 0; i < 4; i++) {
+        f = i;
+        stub_send(x, "setbank", 1, &f);
+        stub_send(x, "float", 1, &banks[i][0]);
+        stub_send(x, "bw", 1, &banks[i][1]);
+        stub_send(x, "bt", 1, &banks[i][2]);
+    }
+    return x;
+}
+
+// the gain at freq Hz, from a second after a second to settle
+static double gq_measure(t_gq *x, double freq) {
+    static t_float in[2 * GQ_N], outL[2 * GQ_N], outR[2 * GQ_N];
+    t_signal sig[4], *sp[4];
+    double re = 0., im = 0.;
+    int i;
+
+    for (i = 0; i < 2 * GQ_N; i++)
+        in[i] = sin(2. * M_PI * freq * i / GQ_SR);
+    for (i = 0; i < 4; i++) {
+        sig[i].s_n = 64;
+        sig[i].s_sr = GQ_SR;
+        sig[i].s_nchans = 1;
+        sp[i] = &sig[i];
+    }
+    gq_clear(x);
+    for (i = 0; i < 2 * GQ_N; i += 64) {
+        sig[0].s_vec = sig[1].s_vec = in + i;
+        sig[2].s_vec = outL + i;
+        sig[3].s_vec = outR + i;
+        stub_dsp(x, sp);
+        stub_tick();
+    }
+    for (i = GQ_N; i < 2 * GQ_N; i++) {
+        if (outL[i] != outR[i])
+            return -1.;
+        re += outL[i] * cos(2. * M_PI * freq * i / GQ_SR);
+        im += outL[i] * sin(2. * M_PI * freq * i / GQ_SR);
+    }
+    return 2. * sqrt(re * re + im * im) / GQ_N;
+}
+
+static int gq_check(int parallel, double *maxerr) {
+    t_gq *x = gq_make(parallel);
+    t_float mag[GQ_NFREQS];
+    double gain, err;
+    int i, ok = 1;
+
+    gq_measure(x, gq_freqs[0]); // to set the sample rate
+    gq_response(x, GQ_NFREQS, gq_freqs, mag);
+    for (i = 0; i < GQ_NFREQS && ok; i++) {
+        gain = gq_measure(x, gq_freqs[i]);
+        err = fabs(gain - mag[i]) / mag[i];
+        if (!(err <= GQ_TOLERANCE)) {
+            printf("%-12s FAIL  %s, %g Hz: response %g, measured %g\n", "gQ~",
+                   parallel ? "parallel" : "series", gq_freqs[i], mag[i],
+                   gain);
+            ok = 0;
+        }
+        if (err > *maxerr)
+            *maxerr = err;
+    }
+    stub_free(x);
+    return ok;
+}
+
+int main(void) {
+    double maxerr = 0.;
+    int ok;
+
+    stub_srate = GQ_SR;
+    gQ_tilde_setup();
+    ok = gq_check(0, &maxerr) && gq_check(1, &maxerr);
+    if (ok)
+        printf("%-12s ok    response within %.1e of the filters, series and "
+               "parallel\n",
+               "gQ~", maxerr);
+    return !ok;
+}
@@ -0,0 +1,128 @@
+/********************************************/
+/*  Checks miposc~ on the levels gen10's    */
+/*  'mip' writes for a 64-harmonic saw.     */
+/*                                          */
+/*  It is run twice over a frequency sweep, */
+/*  once with its own output vector and     */
+/*  once in place, with the input and the   */
+/*  output the same vector as Pd may hand   */
+/*  it; the two have to match exactly. At a */
+/*  steady MIPOSC_FREQ everything off the   */
+/*  harmonics has to stay MIPOSC_ALIAS dB   */
+/*  down. Exits 1 on a failure.             */
+/********************************************/
+
+#include "pdstub.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../PeRColate_source/4_MaxGens/gen10/gen10.c"
+#undef MIPLEVELS
+#include "../PeRColate_source/4_MaxGens/miposc~/miposc~.c"
+
+#define MIPOSC_SIZE 2048
+#define MIPOSC_HARMONICS 64
+#define MIPOSC_LEVELS 11
+#define MIPOSC_SR 64000
+#define MIPOSC_N MIPOSC_SR // a second, in whole blocks, so each harmonic is a bin
+#define MIPOSC_FREQ 5000.
+#define MIPOSC_ALIAS 50.
+
+static t_float sweep[MIPOSC_N], apart[MIPOSC_N], inplace[MIPOSC_N];
+
+// renders n samples at the frequencies in freq into out, which may be freq
+static void miposc_render(t_miposc *o, t_float *freq, t_float *out, int n) {
+    t_signal sig[2], *sp[2];
+    int i;
+
+    o->x_phase = 0;
+    for (i = 0; i < 2; i++) {
+        sig[i].s_n = 64;
+        sig[i].s_sr = MIPOSC_SR;
+        sig[i].s_nchans = 1;
+        sp[i] = &sig[i];
+    }
+    for (i = 0; i + 64 <= n; i += 64) {
+        sig[0].s_vec = freq + i;
+        sig[1].s_vec = out + i;
+        stub_dsp(o, sp);
+        stub_tick();
+    }
+}
+
+// power at f Hz, for a signal a second long
+static double miposc_band(const t_float *x, double f) {
+    double re = 0., im = 0.;
+    int i;
+    for (i = 0; i < MIPOSC_N; i++) {
+        re += x[i] * cos(2. * M_PI * f * i / MIPOSC_N);
+        im += x[i] * sin(2. * M_PI * f * i / MIPOSC_N);
+    }
+    return (re * re + im * im) / MIPOSC_N / MIPOSC_N * 4.;
+}
+
+int main(void) {
+    char name[MAXPDSTRING];
+    t_float a[2] = {MIPOSC_SIZE, 0};
+    double total = 0., harmonics = 0., rest;
+    t_miposc *o;
+    gen10 *g;
+    int i, k, ok = 1;
+
+    for (k = 0; k < MIPOSC_LEVELS; k++) {
+        sprintf(name, "saw-%d", k);
+        stub_array(gensym(name), 1);
+    }
+    gen10_setup();
+    g = (gen10 *)stub_new(2, a);
+    for (i = 0; i < MIPOSC_HARMONICS; i++)
+        g->g_args[i] = 1. / (i + 1);
+    g->g_numharmonics = MIPOSC_HARMONICS;
+    g->g_rescale = 1;
+    gen10_mip(g, gensym("saw"));
+
+    miposc_tilde_setup();
+    o = (t_miposc *)miposc_new(gensym("saw"));
+    miposc_find(o);
+    if (o->x_nlevels != MIPOSC_LEVELS || o->x_size != MIPOSC_SIZE) {
+        printf("%-12s FAIL  found %d levels of %d points\n", "miposc~",
+               o->x_nlevels, o->x_size);
+        return 1;
+    }
+
+    // 20 Hz to 20 kHz, and back down
+    for (i = 0; i < MIPOSC_N; i++)
+        sweep[i] = 20. * pow(1000., 1. - fabs(2. * i / MIPOSC_N - 1.));
+    miposc_render(o, sweep, apart, MIPOSC_N);
+    memcpy(inplace, sweep, sizeof(sweep));
+    miposc_render(o, inplace, inplace, MIPOSC_N);
+    for (i = 0; i < MIPOSC_N; i++) {
+        if (apart[i] != inplace[i]) {
+            printf("%-12s FAIL  in place, sample %d: %g, apart %g\n",
+                   "miposc~", i, inplace[i], apart[i]);
+            ok = 0;
+            break;
+        }
+    }
+
+    for (i = 0; i < MIPOSC_N; i++)
+        sweep[i] = MIPOSC_FREQ;
+    miposc_render(o, sweep, apart, MIPOSC_N);
+    for (i = 0; i < MIPOSC_N; i++)
+        total += apart[i] * apart[i] / MIPOSC_N * 2.;
+    for (k = 1; k * MIPOSC_FREQ < MIPOSC_SR / 2; k++)
+        harmonics += miposc_band(apart, k * MIPOSC_FREQ);
+    rest = 10. * log10((total - harmonics) / total);
+    if (!(rest <= -MIPOSC_ALIAS)) {
+        printf("%-12s FAIL  %g Hz: %.1f dB off the harmonics\n", "miposc~",
+               MIPOSC_FREQ, rest);
+        ok = 0;
+    }
+    if (ok)
+        printf("%-12s ok    in place as apart, %.1f dB off the harmonics at "
+               "%g Hz\n",
+               "miposc~", rest, MIPOSC_FREQ);
+    return !ok;
+}
@@ -0,0 +1,144 @@
+/********************************************/
+/*  Checks munger~'s share against a        */
+/*  munger~ with a buffer of its own.       */
+/*                                          */
+/*  Two munger~s share one buffer, and a    */
+/*  third keeps its own; all three hear the */
+/*  same input on the same seed. Only the   */
+/*  first sharer records, but both have to  */
+/*  play what the private one does, sample  */
+/*  for sample, at Pd's block size, an odd  */
+/*  one, and four blocks to a tick as in an */
+/*  overlapped block~. Freeing them all has */
+/*  to give back every byte. Exits 1 on a   */
+/*  failure.                                */
+/********************************************/
+
+#include "pdstub.h"
+#include <stdio.h>
+#include <string.h>
+
+#include "../PeRColate_source/6_Random_DSP/munger/munger~.c"
+
+#define SHARE_SR 44100
+#define SHARE_SAMPLES 44800 // a second or so, in whole blocks of 64 and 100
+#define SHARE_N 3 // the private munger~, then the two sharers
+
+static unsigned int share_seed = 2463534242u;
+
+static t_float share_noise(void) {
+    share_seed ^= share_seed << 13;
+    share_seed ^= share_seed >> 17;
+    share_seed ^= share_seed << 5;
+    return (t_float)share_seed / 2147483648. - 1.;
+}
+
+static t_munger *share_make(const char *share) {
+    t_float a[2] = {3000, 2};
+    t_munger *x = (t_munger *)stub_new(2, a);
+    t_float f;
+
+    if (share)
+        munger_share(x, gensym(share));
+#define SHARE_SEND(sel, v) (f = (v), stub_send(x, sel, 1, &f))
+    SHARE_SEND("seed", 1);
+    SHARE_SEND("delaylength_ms", 200);
+    SHARE_SEND("voices", 10);
+    SHARE_SEND("float", 20);
+    SHARE_SEND("grate_var", 10);
+    SHARE_SEND("glen", 50);
+    SHARE_SEND("glen_var", 25);
+    SHARE_SEND("gpitch_var", 0.5);
+    SHARE_SEND("gpan_spread", 1);
+#undef SHARE_SEND
+    return x;
+}
+
+// overlap blocks to each logical tick
+static int share_check(int blocksize, int overlap) {
+    static t_float in[SHARE_SAMPLES], out[SHARE_N][2][SHARE_SAMPLES];
+    t_signal sig[SHARE_N][3], *sp[SHARE_N][3];
+    t_munger *x[SHARE_N];
+    long before = stub_allocbytes - stub_freedbytes;
+    double energy = 0.;
+    int i, j, k, n, run, ok = 1;
+
+    x[0] = share_make(0);
+    x[1] = share_make("munger-check");
+    x[2] = share_make("munger-check");
+    if (x[1]->buf != x[2]->buf || x[0]->buf == x[1]->buf) {
+        printf("%-12s FAIL  share did not give the sharers one buffer\n",
+               "munger~");
+        return 0;
+    }
+
+    for (i = 0; i < SHARE_SAMPLES; i++)
+        in[i] = share_noise();
+    for (i = run = 0; i < SHARE_SAMPLES; i += n, run++) {
+        n = SHARE_SAMPLES - i < blocksize ? SHARE_SAMPLES - i : blocksize;
+        for (k = 0; k < SHARE_N; k++) {
+            for (j = 0; j < 3; j++) {
+                sig[k][j].s_n = n;
+                sig[k][j].s_sr = SHARE_SR;
+                sig[k][j].s_nchans = 1;
+                sp[k][j] = &sig[k][j];
+            }
+            sig[k][0].s_vec = in + i;
+            sig[k][1].s_vec = out[k][0] + i;
+            sig[k][2].s_vec = out[k][1] + i;
+        }
+        // all three in one tick, as they would be in one patch
+        stub_dsp(x[0], sp[0]);
+        for (k = 1; k < SHARE_N; k++)
+            munger_dsp(x[k], sp[k]);
+        if ((run + 1) % overlap)
+            for (k = 0; k < stub_nchain; k++)
+                stub_chain[k].f(stub_chain[k].w);
+        else
+            stub_tick();
+    }
+
+    for (k = 1; k < SHARE_N && ok; k++) {
+        for (j = 0; j < 2 && ok; j++) {
+            for (i = 0; i < SHARE_SAMPLES; i++) {
+                if (out[k][j][i] != out[0][j][i]) {
+                    printf("%-12s FAIL  block %d, sharer %d, outlet %d, "
+                           "sample %d: %g, own buffer %g\n",
+                           "munger~", blocksize, k, j, i, out[k][j][i],
+                           out[0][j][i]);
+                    ok = 0;
+                    break;
+                }
+            }
+        }
+    }
+    for (i = 0; i < SHARE_SAMPLES; i++)
+        energy += out[0][0][i] * out[0][0][i];
+    if (ok && energy == 0.) {
+        printf("%-12s FAIL  block %d: no grain was heard\n", "munger~",
+               blocksize);
+        ok = 0;
+    }
+
+    for (k = 0; k < SHARE_N; k++)
+        stub_free(x[k]);
+    if (ok && stub_allocbytes - stub_freedbytes != before) {
+        printf("%-12s FAIL  block %d: %ld bytes leaked\n", "munger~",
+               blocksize, stub_allocbytes - stub_freedbytes - before);
+        ok = 0;
+    }
+    return ok;
+}
+
+int main(void) {
+    int ok;
+
+    stub_srate = SHARE_SR;
+    munger_tilde_setup();
+    ok = share_check(64, 1) && share_check(100, 1) && share_check(64, 4);
+    if (ok)
+        printf("%-12s ok    two sharers play as one with its own buffer, "
+               "blocks of 64 and 100, overlap 4\n",
+               "munger~");
+    return !ok;
+}
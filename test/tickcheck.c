@@ -0,0 +1,517 @@
+/********************************************/
+/*  Checks the block versions of the stk    */
+/*  units against their tick().             */
+/*                                          */
+/*  Each unit runs twice over the same      */
+/*  noise, once a sample at a time and once */
+/*  a block at a time, with blocks of every */
+/*  length from 1 to TICK_MAXBLOCK and its  */
+/*  settings changed between them as a      */
+/*  perform routine would. The two have to  */
+/*  match exactly. Exits 1 on a mismatch.   */
+/********************************************/
+
+#include "pdstub.h"
+#include "stk_c.h"
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#define TICK_SAMPLES 100000
+#define TICK_MAXBLOCK 100
+#define TICK_LENGTH 1000 // of the delay lines
+#define TICK_WAVE 5000   // samples in RawWvIn's file and HeaderSnd's table
+#define TICK_FILE "bin/tickcheck.raw"
+#define TICK_SR 44100
+
+static unsigned int tick_seed;
+static float in[TICK_SAMPLES], outt[TICK_SAMPLES], outb[TICK_SAMPLES];
+static float table[TICK_WAVE + 1]; // with the interpolation guard
+
+static float tick_noise(void) {
+    tick_seed = tick_seed * 1103515245u + 12345u;
+    return (float)(tick_seed >> 8) / (float)(1 << 23) - 1.;
+}
+
+// the same noise in for every unit
+static void tick_start(void) {
+    int i;
+    tick_seed = 12345;
+    for (i = 0; i < TICK_SAMPLES; i++)
+        in[i] = tick_noise();
+}
+
+// the length of the block at i
+static int tick_block(int i) {
+    int n = 1 + (int)((tick_noise() * .5 + .5) * TICK_MAXBLOCK) %
+                    TICK_MAXBLOCK;
+    return TICK_SAMPLES - i < n ? TICK_SAMPLES - i : n;
+}
+
+static int tick_compare(const char *name) {
+    int i;
+    for (i = 0; i < TICK_SAMPLES; i++) {
+        if (outb[i] != outt[i]) {
+            printf("%-12s FAIL  sample %d: tickBlock %g, tick %g\n", name, i,
+                   outb[i], outt[i]);
+            return 0;
+        }
+    }
+    printf("%-12s ok    tickBlock as tick, blocks of 1 to %d\n", name,
+           TICK_MAXBLOCK);
+    return 1;
+}
+
+static int tick_adsr(void) {
+    ADSR t, b;
+    float a, d, s, r;
+    int i, k, n;
+
+    ADSR_init(&t);
+    ADSR_init(&b);
+    tick_start();
+    for (i = 0; i < TICK_SAMPLES; i += n) {
+        n = tick_block(i);
+        // a note on or off now and then, with new times
+        if (tick_noise() > .8) {
+            a = .001 + (tick_noise() * .5 + .5) * .01;
+            d = .001 + (tick_noise() * .5 + .5) * .01;
+            s = tick_noise() * .5 + .5;
+            r = .001 + (tick_noise() * .5 + .5) * .01;
+            ADSR_setAllTimes(&t, a, d, s, r, 44100);
+            ADSR_setAllTimes(&b, a, d, s, r, 44100);
+            if (tick_noise() > 0.) {
+                ADSR_keyOn(&t);
+                ADSR_keyOn(&b);
+            } else {
+                ADSR_keyOff(&t);
+                ADSR_keyOff(&b);
+            }
+        }
+        for (k = 0; k < n; k++)
+            outt[i + k] = ADSR_tick(&t);
+        ADSR_tickBlock(&b, outb + i, n);
+    }
+    return tick_compare("ADSR");
+}
+
+static int tick_noise_(void) {
+    Noise t, b;
+    int i, k, n;
+
+    Noise_init(&t, 1);
+    Noise_init(&b, 1);
+    tick_start();
+    for (i = 0; i < TICK_SAMPLES; i += n) {
+        n = tick_block(i);
+        for (k = 0; k < n; k++)
+            outt[i + k] = Noise_tick(&t);
+        Noise_tickBlock(&b, outb + i, n);
+    }
+    return tick_compare("Noise");
+}
+
+static int tick_onezero(void) {
+    OneZero t, b;
+    float c;
+    int i, k, n;
+
+    OneZero_init(&t);
+    OneZero_init(&b);
+    tick_start();
+    for (i = 0; i < TICK_SAMPLES; i += n) {
+        n = tick_block(i);
+        c = tick_noise();
+        OneZero_setCoeff(&t, c);
+        OneZero_setCoeff(&b, c);
+        c = tick_noise() + 1.;
+        OneZero_setGain(&t, c);
+        OneZero_setGain(&b, c);
+        for (k = 0; k < n; k++)
+            outt[i + k] = OneZero_tick(&t, in[i + k]);
+        OneZero_tickBlock(&b, in + i, outb + i, n);
+    }
+    return tick_compare("OneZero");
+}
+
+static int tick_onepole(void) {
+    OnePole t, b;
+    float c;
+    int i, k, n;
+
+    OnePole_init(&t);
+    OnePole_init(&b);
+    tick_start();
+    for (i = 0; i < TICK_SAMPLES; i += n) {
+        n = tick_block(i);
+        c = tick_noise() * .99;
+        OnePole_setPole(&t, c);
+        OnePole_setPole(&b, c);
+        c = tick_noise() + 1.;
+        OnePole_setGain(&t, c);
+        OnePole_setGain(&b, c);
+        for (k = 0; k < n; k++)
+            outt[i + k] = OnePole_tick(&t, in[i + k]);
+        OnePole_tickBlock(&b, in + i, outb + i, n);
+    }
+    return tick_compare("OnePole");
+}
+
+static int tick_dcblock(void) {
+    DCBlock t, b;
+    int i, k, n;
+
+    DCBlock_clear(&t);
+    DCBlock_clear(&b);
+    tick_start();
+    for (i = 0; i < TICK_SAMPLES; i += n) {
+        n = tick_block(i);
+        for (k = 0; k < n; k++)
+            outt[i + k] = DCBlock_tick(&t, in[i + k]);
+        DCBlock_tickBlock(&b, in + i, outb + i, n);
+    }
+    return tick_compare("DCBlock");
+}
+
+// a resonance somewhere between 50 Hz and 10 kHz
+static void tick_reson(float *freq, float *reson) {
+    *freq = 50. * pow(200., tick_noise() * .5 + .5);
+    *reson = .9 + (tick_noise() * .5 + .5) * .0999;
+}
+
+static int tick_biquad(void) {
+    BiQuad t, b;
+    float f, r, g;
+    int i, k, n;
+
+    BiQuad_init(&t);
+    BiQuad_init(&b);
+    BiQuad_setEqualGainZeroes(&t);
+    BiQuad_setEqualGainZeroes(&b);
+    tick_start();
+    for (i = 0; i < TICK_SAMPLES; i += n) {
+        n = tick_block(i);
+        tick_reson(&f, &r);
+        BiQuad_setFreqAndReson(&t, f, r, TICK_SR);
+        BiQuad_setFreqAndReson(&b, f, r, TICK_SR);
+        g = tick_noise() * .5 + .5;
+        BiQuad_setGain(&t, g);
+        BiQuad_setGain(&b, g);
+        for (k = 0; k < n; k++)
+            outt[i + k] = BiQuad_tick(&t, in[i + k]);
+        BiQuad_tickBlock(&b, in + i, outb + i, n);
+    }
+    return tick_compare("BiQuad");
+}
+
+// one of the four filters retuned each block
+static int tick_biquad4(void) {
+    BiQuad4 t, b;
+    float f, r, g;
+    int i, j, k, n;
+
+    BiQuad4_init(&t);
+    BiQuad4_init(&b);
+    BiQuad4_setEqualGainZeroes(&t);
+    BiQuad4_setEqualGainZeroes(&b);
+    tick_start();
+    for (i = 0; i < TICK_SAMPLES; i += n) {
+        n = tick_block(i);
+        j = (int)((tick_noise() * .5 + .5) * 4) & 3;
+        tick_reson(&f, &r);
+        BiQuad4_setFreqAndReson(&t, j, f, r, TICK_SR);
+        BiQuad4_setFreqAndReson(&b, j, f, r, TICK_SR);
+        g = tick_noise() * .5 + .5;
+        BiQuad4_setGain(&t, j, g);
+        BiQuad4_setGain(&b, j, g);
+        for (k = 0; k < n; k++)
+            outt[i + k] = BiQuad4_tick(&t, in[i + k]);
+        BiQuad4_tickBlock(&b, in + i, outb + i, n);
+    }
+    return tick_compare("BiQuad4");
+}
+
+static int tick_dlinea(void) {
+    DLineA t, b;
+    double lag;
+    int i, k, n;
+
+    memset(&t, 0, sizeof(t));
+    memset(&b, 0, sizeof(b));
+    DLineA_alloc(&t, TICK_LENGTH);
+    DLineA_alloc(&b, TICK_LENGTH);
+    tick_start();
+    for (i = 0; i < TICK_SAMPLES; i += n) {
+        n = tick_block(i);
+        lag = 1. + (tick_noise() * .5 + .5) * (TICK_LENGTH - 3);
+        DLineA_setDelay(&t, lag);
+        DLineA_setDelay(&b, lag);
+        for (k = 0; k < n; k++)
+            outt[i + k] = DLineA_tick(&t, in[i + k]);
+        DLineA_tickBlock(&b, in + i, outb + i, n);
+    }
+    DLineA_free(&t);
+    DLineA_free(&b);
+    return tick_compare("DLineA");
+}
+
+static int tick_dlineaf(void) {
+    DLineAf t, b;
+    double lag;
+    int i, k, n;
+
+    memset(&t, 0, sizeof(t));
+    memset(&b, 0, sizeof(b));
+    DLineAf_alloc(&t, TICK_LENGTH);
+    DLineAf_alloc(&b, TICK_LENGTH);
+    tick_start();
+    for (i = 0; i < TICK_SAMPLES; i += n) {
+        n = tick_block(i);
+        lag = 1. + (tick_noise() * .5 + .5) * (TICK_LENGTH - 3);
+        DLineAf_setDelay(&t, lag);
+        DLineAf_setDelay(&b, lag);
+        for (k = 0; k < n; k++)
+            outt[i + k] = DLineAf_tick(&t, in[i + k]);
+        DLineAf_tickBlock(&b, in + i, outb + i, n);
+    }
+    DLineAf_free(&t);
+    DLineAf_free(&b);
+    return tick_compare("DLineAf");
+}
+
+// the read point passes the last slot on every lap, where tickBlock
+// interpolates across the end
+static int tick_dlinel(void) {
+    DLineL t, b;
+    float lag;
+    int i, k, n;
+
+    memset(&t, 0, sizeof(t));
+    memset(&b, 0, sizeof(b));
+    DLineL_alloc(&t, TICK_LENGTH);
+    DLineL_alloc(&b, TICK_LENGTH);
+    tick_start();
+    for (i = 0; i < TICK_SAMPLES; i += n) {
+        n = tick_block(i);
+        lag = (tick_noise() * .5 + .5) * (TICK_LENGTH - 2);
+        DLineL_setDelay(&t, lag);
+        DLineL_setDelay(&b, lag);
+        for (k = 0; k < n; k++)
+            outt[i + k] = DLineL_tick(&t, in[i + k]);
+        DLineL_tickBlock(&b, in + i, outb + i, n);
+    }
+    DLineL_free(&t);
+    DLineL_free(&b);
+    return tick_compare("DLineL");
+}
+
+static int tick_dlinen(void) {
+    DLineN t, b;
+    float lag;
+    int i, k, n;
+
+    memset(&t, 0, sizeof(t));
+    memset(&b, 0, sizeof(b));
+    DLineN_alloc(&t, TICK_LENGTH);
+    DLineN_alloc(&b, TICK_LENGTH);
+    tick_start();
+    for (i = 0; i < TICK_SAMPLES; i += n) {
+        n = tick_block(i);
+        lag = (int)((tick_noise() * .5 + .5) * (TICK_LENGTH - 2));
+        DLineN_setDelay(&t, lag);
+        DLineN_setDelay(&b, lag);
+        for (k = 0; k < n; k++)
+            outt[i + k] = DLineN_tick(&t, in[i + k]);
+        DLineN_tickBlock(&b, in + i, outb + i, n);
+    }
+    DLineN_free(&t);
+    DLineN_free(&b);
+    return tick_compare("DLineN");
+}
+
+// looping at changing rates, then one shot at a tenth, which finishes
+// halfway through
+static int tick_rawwvin(void) {
+    RawWvIn t, b;
+    FILE *fd;
+    short s;
+    float rate;
+    int i, k, n, oneshot;
+
+    tick_start();
+    if (!(fd = fopen(TICK_FILE, "wb"))) {
+        printf("%-12s FAIL  can't write %s\n", "RawWvIn", TICK_FILE);
+        return 0;
+    }
+    for (i = 0; i < TICK_WAVE; i++) {
+        s = (short)(tick_noise() * 32767.);
+        fwrite(&s, sizeof(s), 1, fd);
+    }
+    fclose(fd);
+
+    for (oneshot = 0; oneshot < 2; oneshot++) {
+        memset(&t, 0, sizeof(t));
+        memset(&b, 0, sizeof(b));
+        RawWvIn_alloc(&t, TICK_FILE, oneshot ? "oneshot" : "looping");
+        RawWvIn_alloc(&b, TICK_FILE, oneshot ? "oneshot" : "looping");
+        for (i = 0; i < TICK_SAMPLES; i += n) {
+            n = tick_block(i);
+            // whole rates read straight, the others interpolate
+            if (!oneshot || i == 0) {
+                rate = oneshot ? .1 : (tick_noise() * .5 + .5) * 3.;
+                if (!oneshot && tick_noise() > .5)
+                    rate = (int)rate + 1;
+                RawWvIn_setRate(&t, rate);
+                RawWvIn_setRate(&b, rate);
+            }
+            for (k = 0; k < n; k++)
+                outt[i + k] = RawWvIn_tick(&t);
+            RawWvIn_tickBlock(&b, outb + i, n);
+        }
+        RawWvIn_free(&t);
+        RawWvIn_free(&b);
+        if (!tick_compare(oneshot ? "RawWvIn one" : "RawWvIn loop"))
+            return 0;
+    }
+    remove(TICK_FILE);
+    return 1;
+}
+
+static int tick_envelope(void) {
+    Envelope t, b;
+    float v;
+    int i, k, n;
+
+    Envelope_init(&t);
+    Envelope_init(&b);
+    tick_start();
+    for (i = 0; i < TICK_SAMPLES; i += n) {
+        n = tick_block(i);
+        // a new target, a jump, or a key on or off now and then
+        v = tick_noise();
+        if (v > .6) {
+            v = tick_noise() * .5 + .5;
+            Envelope_setTarget(&t, v);
+            Envelope_setTarget(&b, v);
+            v = (tick_noise() * .5 + .5) * .01;
+            Envelope_setRate(&t, v);
+            Envelope_setRate(&b, v);
+        } else if (v > .5) {
+            v = tick_noise();
+            Envelope_setValue(&t, v);
+            Envelope_setValue(&b, v);
+        } else if (v > .3) {
+            Envelope_keyOn(&t);
+            Envelope_keyOn(&b);
+        } else if (v > .1) {
+            Envelope_keyOff(&t);
+            Envelope_keyOff(&b);
+        }
+        for (k = 0; k < n; k++)
+            outt[i + k] = Envelope_tick(&t);
+        Envelope_tickBlock(&b, outb + i, n);
+    }
+    return tick_compare("Envelope");
+}
+
+static void tick_table(void) {
+    int i;
+    for (i = 0; i <= TICK_WAVE; i++)
+        table[i] = tick_noise();
+}
+
+// as RawWvIn, from a table instead of a file
+static int tick_headersnd(void) {
+    HeaderSnd t, b;
+    float rate;
+    int i, k, n, oneshot;
+
+    tick_start();
+    tick_table();
+    for (oneshot = 0; oneshot < 2; oneshot++) {
+        memset(&t, 0, sizeof(t));
+        memset(&b, 0, sizeof(b));
+        HeaderSnd_alloc(&t, table, TICK_WAVE + 1,
+                        oneshot ? "oneshot" : "looping");
+        HeaderSnd_alloc(&b, table, TICK_WAVE + 1,
+                        oneshot ? "oneshot" : "looping");
+        for (i = 0; i < TICK_SAMPLES; i += n) {
+            n = tick_block(i);
+            if (!oneshot || i == 0) {
+                rate = oneshot ? .1 : (tick_noise() * .5 + .5) * 3.;
+                if (!oneshot && tick_noise() > .5)
+                    rate = (int)rate + 1;
+                HeaderSnd_setRate(&t, rate);
+                HeaderSnd_setRate(&b, rate);
+            }
+            for (k = 0; k < n; k++)
+                outt[i + k] = HeaderSnd_tick(&t);
+            HeaderSnd_tickBlock(&b, outb + i, n);
+        }
+        HeaderSnd_free(&t);
+        HeaderSnd_free(&b);
+        if (!tick_compare(oneshot ? "HeaderSnd one" : "HeaderSnd loop"))
+            return 0;
+    }
+    return 1;
+}
+
+// struck now and then at a new pitch, and damped
+static int tick_modal4(void) {
+    Modal4 t, b;
+    float f, a;
+    int i, k, n;
+
+    tick_start();
+    tick_table();
+    memset(&t, 0, sizeof(t));
+    memset(&b, 0, sizeof(b));
+    Modal4_init(&t, TICK_SR);
+    Modal4_init(&b, TICK_SR);
+    HeaderSnd_alloc(&t.wave, table, 257, "oneshot");
+    HeaderSnd_alloc(&b.wave, table, 257, "oneshot");
+    Modal4_setDirectGain(&t, .1);
+    Modal4_setDirectGain(&b, .1);
+    for (i = 0; i < TICK_SAMPLES; i += n) {
+        n = tick_block(i);
+        a = tick_noise();
+        if (a > .8) {
+            f = 100. * pow(20., tick_noise() * .5 + .5);
+            a = tick_noise() * .5 + .5;
+            Modal4_noteOn(&t, f, a);
+            Modal4_noteOn(&b, f, a);
+        } else if (a > .7) {
+            Modal4_noteOff(&t, .5);
+            Modal4_noteOff(&b, .5);
+        }
+        for (k = 0; k < n; k++)
+            outt[i + k] = Modal4_tick(&t);
+        Modal4_tickBlock(&b, outb + i, n);
+    }
+    HeaderSnd_free(&t.wave);
+    HeaderSnd_free(&t.vibr);
+    HeaderSnd_free(&b.wave);
+    HeaderSnd_free(&b.vibr);
+    return tick_compare("Modal4");
+}
+
+int main(void) {
+    int ok = 1;
+
+    ok &= tick_adsr();
+    ok &= tick_noise_();
+    ok &= tick_onezero();
+    ok &= tick_onepole();
+    ok &= tick_dcblock();
+    ok &= tick_biquad();
+    ok &= tick_biquad4();
+    ok &= tick_dlinea();
+    ok &= tick_dlineaf();
+    ok &= tick_dlinel();
+    ok &= tick_dlinen();
+    ok &= tick_rawwvin();
+    ok &= tick_headersnd();
+    ok &= tick_envelope();
+    ok &= tick_modal4();
+    return !ok;
+}